@@ -11,12 +11,17 @@
 #pragma once
 
 #include "settings.hpp"
+#include "lower_bounds.hpp"      // for Envelope, envelope
+#include "warping_quantised.hpp" // for Quantiser
+#include "types/DistanceFile.hpp" // for hashBytes
 
-#include <cstddef> // for size_t
-#include <cassert> // for assert
-#include <string>  // for string
-#include <utility> // for move
-#include <vector>  // for vector
+#include <cstddef>   // for size_t
+#include <cassert>   // for assert
+#include <cstdint>   // for int16_t, uint64_t
+#include <stdexcept> // for runtime_error
+#include <string>    // for string, to_string
+#include <utility>   // for move
+#include <vector>    // for vector
 
 namespace dtwc {
 
@@ -27,8 +32,16 @@ namespace dtwc {
  */
 struct Data
 {
-  std::vector<std::vector<data_t>> p_vec; //!< Vector of data vectors
+  std::vector<std::vector<data_t>> p_vec; //!< Vector of data vectors, channel-interleaved if ndim > 1: p_vec[i][t * ndim + c].
   std::vector<std::string> p_names;       //!< Vector of data point names
+  int ndim{ 1 };                          //!< Number of channels of every data vector.
+
+  std::vector<Envelope<data_t>> p_env; //!< Envelopes of data vectors for lower bounds, see updateEnvelopes.
+  int env_band{ -2 };                  //!< Band the envelopes were computed for (-2: not computed).
+
+  Quantiser<data_t> quantiser;                    //!< Quantisation of all data vectors, see updateQuantised.
+  std::vector<std::vector<int16_t>> p_quantised;  //!< Quantised data vectors for DtwKernel::Quantised.
+  bool is_quantised{ false };                     //!< Whether p_quantised is up to date.
 
   /**
    * @brief Returns the number of data points.
@@ -36,21 +49,113 @@ struct Data
    */
   auto size() const { return static_cast<int>(p_vec.size()); }
 
+  /**
+   * @brief Returns the length (number of frames) of data vector i.
+   */
+  auto length(int i) const { return p_vec[i].size() / ndim; }
+
+  /**
+   * @brief Hash of the number of channels and the data vectors (not their names).
+   * @details Recorded in binary distance matrix files to recognise the data they belong to.
+   */
+  uint64_t hash() const
+  {
+    uint64_t result = hashBytes(&ndim, sizeof(ndim));
+    for (const auto &p : p_vec) {
+      const uint64_t n = p.size();
+      result = hashBytes(&n, sizeof(n), result);
+      result = hashBytes(p.data(), p.size() * sizeof(data_t), result);
+    }
+    return result;
+  }
+
+  /**
+   * @brief Checks if all data vectors have the same length.
+   * @return True if all lengths are equal (or there is no data).
+   */
+  bool hasEqualLengths() const
+  {
+    for (const auto &p : p_vec)
+      if (p.size() != p_vec.front().size()) return false;
+
+    return true;
+  }
+
+  /**
+   * @brief Computes the envelopes of all data vectors for the given band if they are not up to date.
+   * @details Envelopes are only used for lower bounds of univariate sequences with equal lengths,
+   *          so nothing is computed for multivariate data. Call invalidateEnvelopes() after
+   *          modifying p_vec in place.
+   * @param band The bandwidth parameter used for DTW.
+   */
+  void updateEnvelopes(int band)
+  {
+    if (ndim > 1 || (env_band == band && p_env.size() == p_vec.size())) return;
+
+    p_env.resize(p_vec.size());
+#pragma omp parallel for
+    for (int i = 0; i < size(); i++)
+      p_env[i] = envelope(p_vec[i], band);
+
+    env_band = band;
+  }
+
+  void invalidateEnvelopes() { env_band = -2; } //!< Marks the envelopes as out of date.
+
+  /**
+   * @brief Checks if the envelopes are up to date for the given band.
+   */
+  bool hasEnvelopes(int band) const { return env_band == band && p_env.size() == p_vec.size(); }
+
+  /**
+   * @brief Quantises all data vectors to int16 with a common scale if they are not up to date.
+   * @details Call invalidateQuantised() after modifying p_vec in place.
+   */
+  void updateQuantised()
+  {
+    if (hasQuantised()) return;
+
+    quantiser = Quantiser<data_t>::fit(p_vec);
+    p_quantised.resize(p_vec.size());
+#pragma omp parallel for
+    for (int i = 0; i < size(); i++)
+      p_quantised[i] = quantiser.quantise(p_vec[i]);
+
+    is_quantised = true;
+  }
+
+  void invalidateQuantised() { is_quantised = false; } //!< Marks the quantised data as out of date.
+
+  /**
+   * @brief Checks if the quantised data are up to date.
+   */
+  bool hasQuantised() const { return is_quantised && p_quantised.size() == p_vec.size(); }
+
   Data() = default; //!< Default constructor
 
   /**
    * @brief Constructor that initializes data and name vectors.
    * @param p_vec_new Rvalue reference to a vector of data vectors.
    * @param p_names_new Rvalue reference to a vector of data point names.
-   * @throws std::runtime_error if data and name vectors are not of the same size.
+   * @param ndim_ Number of channels; data vectors are channel-interleaved.
+   * @throws std::runtime_error if data and name vectors are not of the same size,
+   *         or if the size of a data vector is not a multiple of the number of channels.
    */
-  Data(std::vector<std::vector<data_t>> &&p_vec_new, std::vector<std::string> &&p_names_new)
+  Data(std::vector<std::vector<data_t>> &&p_vec_new, std::vector<std::string> &&p_names_new, int ndim_ = 1)
   {
     if (p_vec_new.size() != p_names_new.size())
       throw std::runtime_error("Data and name vectors should be of the same size");
 
+    if (ndim_ < 1)
+      throw std::runtime_error("Data should have at least one channel");
+
+    for (size_t i = 0; i < p_vec_new.size(); i++)
+      if (p_vec_new[i].size() % ndim_ != 0)
+        throw std::runtime_error("Data vector " + p_names_new[i] + " has " + std::to_string(p_vec_new[i].size()) + " elements, which is not a multiple of " + std::to_string(ndim_) + " channels");
+
     p_vec = std::move(p_vec_new);
     p_names = std::move(p_names_new);
+    ndim = ndim_;
   }
 };
 
@@ -15,7 +15,9 @@
 
 #include <cstddef>    //!< For size_t
 #include <filesystem> //!< For filesystem objects like path
+#include <string>     //!< For std::string
 #include <tuple>      //!< For std::tie(), std::tuple
+#include <utility>    //!< For std::move
 #include <vector>     //!< For std::vector
 
 namespace dtwc {
@@ -28,6 +30,7 @@ class DataLoader
   int start_row{ 0 };                     //!< Starting row for data extraction
   int Ndata{ -1 };                        //!< Number of data rows to load
   int verbose{ 1 };                       //!< Verbosity level
+  int n_dim{ 1 };                         //!< Number of channels of each series
   char delim{ ',' };                      //!< Column delimiter character
   std::filesystem::path data_path{ "." }; //!< Path to data file or folder
 
@@ -48,6 +51,7 @@ public:
   auto delimiter() { return delim; }       //!< Get the delimiter used in data files.
   auto path() { return data_path; }        //!< Get the path of the data file or directory.
   auto verbosity() { return verbose; }     //!< Get the verbosity level for data loading.
+  auto ndim() { return n_dim; }            //!< Get the number of channels of each series.
 
 
   // Setters with chaining
@@ -108,6 +112,21 @@ public:
     return *this;
   }
 
+  /**
+   * @brief Set number of channels
+   *
+   * In a folder, each file is one series and its ndim consecutive columns from the start column
+   * are the channels. In a single file, each row is one series with channel-interleaved values.
+   *
+   * @param N Number of channels
+   * @return Reference to self for chaining
+   */
+  DataLoader &ndim(int N)
+  {
+    n_dim = N;
+    return *this;
+  }
+
   /**
    * @brief Load data
    * @details Calls appropriate loader based on path being file or folder.
@@ -115,13 +134,14 @@ public:
    */
   Data load()
   {
-    Data d;
+    std::vector<std::vector<data_t>> p_vec;
+    std::vector<std::string> p_names;
     if (fs::is_directory(data_path))
-      std::tie(d.p_vec, d.p_names) = load_folder<data_t>(data_path, Ndata, verbose, start_row, start_col, delim);
+      std::tie(p_vec, p_names) = load_folder<data_t>(data_path, Ndata, verbose, start_row, start_col, delim, n_dim);
     else
-      std::tie(d.p_vec, d.p_names) = load_batch_file<data_t>(data_path, Ndata, verbose, start_row, start_col, delim);
+      std::tie(p_vec, p_names) = load_batch_file<data_t>(data_path, Ndata, verbose, start_row, start_col, delim, n_dim);
 
-    return d;
+    return Data(std::move(p_vec), std::move(p_names), n_dim);
   }
 };
 
@@ -11,27 +11,53 @@
  */
 
 #include "Problem.hpp"
-#include "mip.hpp"             // for MIP_clustering_byGurobi
-#include "parallelisation.hpp" // for run
-#include "scores.hpp"          // for silhouette
-#include "settings.hpp"        // for data_t, randGenerator, band, isDebug
-#include "warping.hpp"         // for dtwBanded, dtwFull
-#include "types/Range.hpp"     // for Range
-#include "initialisation.hpp"  // For initialisation functions
+#include "mip.hpp"                  // for MIP_clustering_byGurobi
+#include "parallelisation.hpp"      // for run, runGrouped, runTiles, upperTriangleTiles, shardTiles
+#include "types/ShardFile.hpp"      // for ShardFile
+#include "scores.hpp"               // for silhouette
+#include "settings.hpp"             // for data_t, randGenerator, band, isDebug
+#include "warping.hpp"              // for dtwBanded, dtwFull
+#include "warping_wavefront.hpp"    // for dtwWavefront
+#include "warping_batch.hpp"        // for dtwBatch
+#include "warping_pruned.hpp"       // for dtwPruned
+#include "warping_window.hpp"       // for dtwWindowed, WarpingWindow
+#include "warping_path.hpp"         // for dtwPath
+#include "warping_fast.hpp"         // for dtwFast
+#include "warping_quantised.hpp"    // for dtwQuantised, dtwBatchQuantised
+#include "warping_multivariate.hpp" // for dtwDependent, dtwIndependent, dtwPathDependent
+#include "warping_incremental.hpp"  // for IncrementalDtw
+#include "lower_bounds.hpp"         // for dtwCascade
+#include "costs.hpp"                // for cost::L1, cost::SquaredL2
+#include "types/Range.hpp"          // for Range
+#include "initialisation.hpp"       // For initialisation functions
 
 
-#include <algorithm> // for max_element, min, min_element, sample
+#include <algorithm> // for any_of, max_element, min, min_element, sample
+#include <cmath>     // for abs
 #include <iomanip>   // for operator<<, setprecision
 #include <iostream>  // for cout
 #include <iterator>  // for back_insert_iterator, back_inserter
 #include <limits>    // for numeric_limits
+#include <numeric>   // for accumulate
+#include <optional>  // for optional
 #include <random>    // for mt19937, discrete_distribution, unifo...
 #include <string>    // for allocator, char_traits, operator+
+#include <tuple>     // for tuple
 #include <utility>   // for pair
 #include <vector>    // for vector, operator==
+#include <omp.h>     // for omp_get_thread_num, omp_get_active_level, omp_get_max_threads
 
 namespace dtwc {
 
+namespace {
+  /// Calls f with the cost policy selected by point_cost, e.g., f(cost::L1{}).
+  template <typename Tfun>
+  auto withCost(DtwCost point_cost, Tfun f)
+  {
+    return (point_cost == DtwCost::SquaredL2) ? f(cost::SquaredL2{}) : f(cost::L1{});
+  }
+} // namespace
+
 /**
  * @brief Resizes data structures based on the current number of clusters.
  *
@@ -97,18 +123,241 @@ bool Problem::set_solver(Solver solver_)
  * @brief Prints the current distance matrix to the standard output.
  * @details Outputs the distance matrix in a human-readable format, useful for debugging and verification.
  */
-void Problem::printDistanceMatrix() const { std::cout << distMat << '\n'; }
+void Problem::printDistanceMatrix() const { std::cout << distMat.matrix().toArma() << '\n'; }
 
 /**
  * @brief Refreshes the distance matrix.
  * @details Resets the distance matrix and marks it as not filled. This is necessary when the data has changed,
- * requiring a re-calculation of distances.
+ * requiring a re-calculation of distances. A mapped distance matrix stays in its file (see mapDistanceMatrix).
  */
 void Problem::refreshDistanceMatrix()
 {
-  distMat.set_size(size(), size());
-  distMat.fill(-1);
+  if (distMat.isMapped())
+    distMat.open(distMat.path(), size(), false, band, data.hash(), distanceConfig()); // Emptied, for the new data.
+  else
+    distMat.resize((shard_count > 1) ? 0 : size()); // Shards are not computed in the distance matrix, see fillShard.
+
   is_distMat_filled = false;
+  incremental_dtw.clear();
+}
+
+thread_local const Problem *Problem::worker_owner = nullptr;
+thread_local Problem::Workspace *Problem::worker_workspace = nullptr;
+
+/**
+ * @brief Wraps task so that each thread of the team of run uses its own workspace of the Problem, see workspace().
+ * @details Allocates the workspaces if needed, so it is not thread-safe; call it right before run.
+ */
+template <typename Tfun>
+auto Problem::worker(Tfun &task)
+{
+  const size_t threads = omp_get_max_threads();
+  if (workspaces.size() < threads) workspaces.resize(threads);
+
+  return [this, &task](auto... args) {
+    struct Reset // Also if task throws.
+    {
+      ~Reset() { worker_owner = nullptr; }
+    } reset;
+
+    const size_t thread = omp_get_thread_num();
+    if (omp_get_active_level() <= 1 && thread < workspaces.size()) { // Not in a nested team.
+      worker_owner = this;
+      worker_workspace = &workspaces[thread];
+    }
+    task(args...);
+  };
+}
+
+/**
+ * @brief Workspace of the calling thread for computing distances.
+ * @details The threads running a task of a parallel pass of the Problem (see worker) use its workspaces.
+ * Any other thread, e.g., a std::thread, a thread pool or a Python thread calling distByInd, uses its own one.
+ */
+Problem::Workspace &Problem::workspace()
+{
+  return (worker_owner == this) ? *worker_workspace : ownWorkspace();
+}
+
+/**
+ * @brief Workspace of the calling thread outside the parallel passes of Problems.
+ */
+Problem::Workspace &Problem::ownWorkspace()
+{
+  thread_local Workspace ws;
+  return ws;
+}
+
+/**
+ * @brief Frees the scratch memory of the distance computations, e.g., after fillDistanceMatrix of long series.
+ * @details Frees the workspaces of the parallel passes and the workspace of the calling thread; other threads
+ * keep their own one.
+ */
+void Problem::releaseWorkspaces()
+{
+  for (auto &ws : workspaces)
+    ws = Workspace{};
+
+  ownWorkspace() = Workspace{};
+}
+
+/**
+ * @brief Memory allocated by the scratch memory of the parallel passes, see releaseWorkspaces.
+ */
+size_t Problem::workspaceBytes() const
+{
+  size_t bytes{ 0 };
+  for (const auto &ws : workspaces)
+    bytes += ws.dtw.bytes() + ws.quantised.bytes() + (ws.candidates.capacity() + ws.quantised_rows.capacity()) * sizeof(void *)
+             + ws.indices.capacity() * sizeof(int) + ws.distances.capacity() * sizeof(data_t) + ws.raw.capacity() * sizeof(int32_t);
+
+  return bytes;
+}
+
+/**
+ * @brief Allocates the (empty) incremental DTW states of all pairs if they are not allocated.
+ * @details Not thread-safe; called before distances are computed in parallel.
+ */
+void Problem::prepareIncremental()
+{
+  if (incremental_dtw.size() != pairCount()) {
+    incremental_dtw.clear();
+    incremental_dtw.resize(pairCount());
+  }
+}
+
+/**
+ * @brief Full DTW distance between two different points, extending the kept cost matrix borders of the pair.
+ */
+data_t Problem::incrementalDistance(int i, int j)
+{
+  const int a = std::max(i, j), b = std::min(i, j);
+  return incremental_dtw[static_cast<size_t>(a) * (a - 1) / 2 + b].update(p_vec(a), p_vec(b));
+}
+
+/**
+ * @brief Appends samples to data point i and updates its distances to all points.
+ * @details With incremental DTW (see isIncrementalDTW), computed distances are extended in
+ * O(appended * other length) from the kept cost matrix borders of each pair. Otherwise, only the
+ * row and column of i are reset, to be recomputed on demand, instead of the whole distance matrix.
+ * @param i Index of the point.
+ * @param samples Samples to append, channel-interleaved for multivariate data.
+ * @throws std::runtime_error if the number of samples is not a multiple of the number of channels.
+ */
+void Problem::appendSamples(int i, const std::vector<data_t> &samples)
+{
+  if (samples.size() % data.ndim != 0)
+    throw std::runtime_error("appendSamples: " + std::to_string(samples.size()) + " samples are not a multiple of " + std::to_string(data.ndim) + " channels.\n");
+
+  auto &x = p_vec(i);
+  x.insert(x.end(), samples.begin(), samples.end());
+  data.invalidateEnvelopes();
+  data.invalidateQuantised();
+
+  const bool is_incremental = isIncrementalDTW();
+  if (is_incremental) prepareIncremental();
+
+  auto oneTask = [&](int j) {
+    if (j == i) return;
+    if (is_incremental && distMat.isReady(i, j))
+      distMat.set(i, j, incrementalDistance(i, j));
+    else
+      distMat.reset(i, j);
+  };
+
+  run(oneTask, size());
+  distMat.setHeader(band, data.hash(), distanceConfig()); // Other entries are still valid for the grown data.
+  if (!is_incremental) is_distMat_filled = false;
+}
+
+/**
+ * @brief Appends data points, keeping the computed distances between the current points.
+ * @details Only the distances to the new points (N_old x N_new plus N_new x N_new pairs) are left
+ * to compute, on demand or by fillDistanceMatrix, instead of the whole distance matrix as after set_data.
+ * A mapped distance matrix is grown in its file. Cluster assignments are resized; call cluster() again.
+ * @param new_data Data points to append, with the same number of channels as data.
+ * @throws std::runtime_error if the number of channels differs.
+ */
+void Problem::append_data(Data new_data)
+{
+  if (size() > 0 && new_data.ndim != data.ndim)
+    throw std::runtime_error("append_data: data with " + std::to_string(new_data.ndim) + " channels cannot be appended to data with " + std::to_string(data.ndim) + " channels.\n");
+
+  const size_t old_pairs = pairCount();
+  const bool keep_incremental = incremental_dtw.size() == old_pairs;
+
+  const int N_new = new_data.size();
+  std::vector<int> from(size() + N_new, -1); // New points are empty.
+  std::iota(from.begin(), from.begin() + size(), 0);
+
+  if (size() == 0) data.ndim = new_data.ndim;
+  std::move(new_data.p_vec.begin(), new_data.p_vec.end(), std::back_inserter(data.p_vec));
+  std::move(new_data.p_names.begin(), new_data.p_names.end(), std::back_inserter(data.p_names));
+  data.invalidateEnvelopes();
+  data.invalidateQuantised(); // Quantised with a common scale, which the new points may change.
+
+  distMat.reindex(from, band, data.hash(), distanceConfig());
+  if (keep_incremental) incremental_dtw.resize(pairCount()); // Pairs of old points keep their positions.
+
+  is_distMat_filled = is_distMat_filled && N_new == 0;
+  resize();
+}
+
+/**
+ * @brief Removes data points, keeping the computed distances between the remaining points.
+ * @details The remaining points keep their order and are renumbered from 0; no distance is computed again.
+ * A mapped distance matrix is shrunk in its file. Medoids and cluster assignments are renumbered too,
+ * unless a medoid is removed: then they are cleared, as before clustering; call cluster() again.
+ * @param indices Indices of the points to remove, in any order; duplicates are ignored.
+ * @throws std::runtime_error if an index is out of range.
+ */
+void Problem::remove_data(std::vector<int> indices)
+{
+  std::vector<bool> removed(size(), false);
+  for (const int i : indices) {
+    if (i < 0 || i >= size())
+      throw std::runtime_error("remove_data: index " + std::to_string(i) + " is out of range for " + std::to_string(size()) + " data points.\n");
+    removed[i] = true;
+  }
+
+  std::vector<int> from; // Old index of each remaining point.
+  for (int i = 0; i < size(); i++)
+    if (!removed[i]) from.push_back(i);
+
+  auto compact = [&](auto &items) {
+    if (items.size() != removed.size()) return;
+    for (size_t k = 0; k < from.size(); k++)
+      if (from[k] != static_cast<int>(k)) items[k] = std::move(items[from[k]]); // from[k] > k.
+    items.resize(from.size());
+  };
+
+  if (incremental_dtw.size() == pairCount()) { // Pairs (a > b) at a * (a - 1) / 2 + b.
+    std::vector<IncrementalDtw<data_t>> kept(from.size() * (from.size() - 1) / 2);
+    for (size_t a = 1; a < from.size(); a++)
+      for (size_t b = 0; b < a; b++)
+        kept[a * (a - 1) / 2 + b] = std::move(incremental_dtw[static_cast<size_t>(from[a]) * (from[a] - 1) / 2 + from[b]]);
+    incremental_dtw = std::move(kept);
+  } else
+    incremental_dtw.clear();
+
+  // Clusters follow their points; without one of the medoids, the data are not clustered anymore:
+  const bool medoid_removed = std::any_of(centroids_ind.begin(), centroids_ind.end(), [&](int c) { return c < 0 || c >= size() || removed[c]; });
+  if (medoid_removed) {
+    centroids_ind.clear();
+    clusters_ind.clear();
+  } else {
+    std::vector<int> to(size(), -1); // New index of each old point.
+    for (size_t k = 0; k < from.size(); k++) to[from[k]] = k;
+    for (auto &c : centroids_ind) c = to[c];
+    compact(clusters_ind);
+  }
+
+  compact(data.p_vec);
+  compact(data.p_names);
+  compact(data.p_env);       // Envelopes and quantised points stay valid.
+  compact(data.p_quantised);
+
+  distMat.reindex(from, band, data.hash(), distanceConfig());
 }
 
 /**
@@ -116,40 +365,414 @@ void Problem::refreshDistanceMatrix()
  *@param i Index of the first point.
  *@param j Index of the second point.
  *@return The distance between the two points.
+ *@note If the distance matrix is not held (see holdsDistanceMatrix), the distance is computed every time.
+ */
+data_t Problem::distByInd(int i, int j)
+{
+  if (!holdsDistanceMatrix()) return computeDistance(i, j, workspace()); // Computing shards, see fillShard.
+
+  return distMat.get(i, j, [&] { return computeDistance(i, j, workspace()); }); // Computed once, even if several threads ask for it.
+}
+
+/**
+ *@brief Calculates the distance between two points with the kernel of the problem, without the distance matrix.
+ *@param ws Workspace of the calling thread, see workspace().
  */
-double Problem::distByInd(int i, int j)
+data_t Problem::computeDistance(int i, int j, Workspace &ws)
 {
-  if (distMat(i, j) < 0)
-    distMat(j, i) = distMat(i, j) = dtwBanded(p_vec(i), p_vec(j), band);
+  const auto &x = p_vec(i), &y = p_vec(j);
+  if (i != j && isIncrementalDTW() && incremental_dtw.size() == pairCount())
+    return incrementalDistance(i, j);
 
-  return distMat(i, j);
+  if (isQuantisedDTW() && data.hasQuantised()) {
+    const auto raw = dtwQuantised(data.p_quantised[i], data.p_quantised[j], band, ws.quantised);
+    if (raw != Quantiser<data_t>::saturated) return data.quantiser.distance(raw);
+    return dtwBanded(x, y, band, ws.dtw); // Saturated.
+  }
+
+  return withCost(point_cost, [&](auto c) {
+    using Tcost = decltype(c);
+    if (!isSakoeChibaDTW()) {
+      // Windows only depend on the lengths, so they are reused for pairs of the same lengths:
+      auto &window = ws.window;
+      auto &window_key = ws.window_key;
+      const auto key = std::tuple(window_type, band, itakura_slope);
+      const int n_x = data.length(i), n_y = data.length(j);
+      if (window.rows() != n_x || window.cols() != n_y || window_key != key) {
+        window = warpingWindow(n_x, n_y);
+        window_key = key;
+      }
+
+      if (data.ndim > 1)
+        return (multivariate_mode == MultivariateMode::Dependent) ? dtwDependent<data_t, Tcost>(x, y, data.ndim, window, step_pattern, ws.dtw)
+                                                                  : dtwIndependent<data_t, Tcost>(x, y, data.ndim, window, step_pattern, ws.dtw);
+
+      return dtwWindowed<data_t, Tcost>(x, y, window, step_pattern, ws.dtw);
+    }
+
+    switch (kernel) {
+    case DtwKernel::Fast:
+      return (band < 0) ? dtwFast<data_t, Tcost>(x, y, fast_radius) : dtwBanded<data_t, Tcost>(x, y, band, ws.dtw); // A band is already O(n * band).
+    case DtwKernel::Wavefront:
+      return dtwWavefront<data_t, Tcost>(x, y, band, ws.dtw);
+    case DtwKernel::Pruned:
+      return dtwPruned<data_t, Tcost>(x, y, band, ws.dtw);
+    case DtwKernel::Auto:
+      if (wavefrontIsProfitable(x.size(), y.size(), band)) return dtwWavefront<data_t, Tcost>(x, y, band, ws.dtw);
+      [[fallthrough]];
+    default: // Banded, or Quantised not quantised yet or with another cost.
+      return dtwBanded<data_t, Tcost>(x, y, band, ws.dtw);
+    }
+  });
+}
+
+/**
+ *@brief Warping window of the problem (window_type, band and itakura_slope) for sequences of lengths n_x and n_y.
+ */
+WarpingWindow Problem::warpingWindow(int n_x, int n_y) const
+{
+  return (window_type == WindowType::Itakura) ? WarpingWindow::itakura(n_x, n_y, itakura_slope)
+                                              : WarpingWindow::sakoeChiba(n_x, n_y, band);
+}
+
+/**
+ *@brief Tag of the settings other than the band which the distances depend on, recorded in distance matrix files.
+ *@details Hashes point_cost, window_type, step_pattern and, where they are used, itakura_slope,
+ * multivariate_mode and the approximation of the kernel (see isApproximateDTW). Exact kernels give the
+ * same distances, so the tag does not depend on which of them is used. Never 0, which is for unknown.
+ */
+uint32_t Problem::distanceConfig() const
+{
+  const int64_t approximation = isQuantisedDTW() ? 2 : isApproximateDTW() ? 1 : 0;
+  const double fields[] = {
+    double(point_cost),
+    double(window_type),
+    (window_type == WindowType::Itakura) ? itakura_slope : 0,
+    double(step_pattern),
+    (data.ndim > 1) ? double(multivariate_mode) : 0,
+    double(approximation),
+    (approximation == 1) ? double(fast_radius) : 0
+  };
+
+  const uint64_t hash = hashBytes(fields, sizeof(fields));
+  const auto tag = static_cast<uint32_t>(hash ^ (hash >> 32));
+  return (tag == 0) ? 1 : tag;
+}
+
+/**
+ *@brief Calculates the optimal warping path (alignment) between two points in linear memory.
+ *@details The path respects the warping window of the problem; it is computed with the
+ * symmetric1 step pattern regardless of step_pattern. For multivariate data, it is the path
+ * shared by all channels (MultivariateMode::Dependent) regardless of multivariate_mode.
+ *@param i Index of the first point.
+ *@param j Index of the second point.
+ *@return Pairs of matched indices of the two points and the distance along the path.
+ */
+DtwPath<data_t> Problem::warpingPath(int i, int j) const
+{
+  const auto &x = p_vec(i), &y = p_vec(j);
+  const auto window = warpingWindow(data.length(i), data.length(j));
+  return withCost(point_cost, [&](auto c) {
+    using Tcost = decltype(c);
+    return (data.ndim > 1) ? dtwPathDependent<data_t, Tcost>(x, y, data.ndim, window) : dtwPath<data_t, Tcost>(x, y, window);
+  });
+}
+
+/**
+ *@brief Retrieves or calculates the distance between two points, abandoning the calculation early
+ * once the distance is known to be larger than best_so_far.
+ *@param i Index of the first point.
+ *@param j Index of the second point.
+ *@param best_so_far Only distances up to this value are of interest, e.g., the distance to the nearest medoid so far.
+ *@return The distance between the two points, or a lower bound of it larger than best_so_far.
+ *@note Only exact distances are stored in the distance matrix. If the envelopes of the data are
+ * up to date (see Data::updateEnvelopes), cheap lower bounds are tried before DTW.
+ */
+data_t Problem::distByInd(int i, int j, data_t best_so_far)
+{
+  const bool is_held = holdsDistanceMatrix(); // Otherwise, nothing is stored.
+  if (is_held && distMat.isReady(i, j)) return distMat(i, j);
+  if (!isSakoeChibaDTW() || isApproximateDTW() || isIncrementalDTW()) return distByInd(i, j); // Bounds and early abandoning are for the exact Sakoe-Chiba band.
+  if (is_held && !distMat.claim(i, j)) return distByInd(i, j);                                // Being computed by another thread, wait for it.
+
+  const auto &x = p_vec(i), &y = p_vec(j);
+  auto &ws = workspace().dtw;
+  const auto result = withCost(point_cost, [&](auto c) {
+    using Tcost = decltype(c);
+    if (data.hasEnvelopes(band))
+      return dtwCascade<data_t, Tcost>(x, y, data.p_env[i], data.p_env[j], band, best_so_far, ws);
+    else if (kernel == DtwKernel::Pruned)
+      return dtwPruned<data_t, Tcost>(x, y, band, best_so_far, ws);
+    else
+      return dtwBanded<data_t, Tcost>(x, y, band, best_so_far, ws);
+  });
+
+  if (!is_held) return result.distance;
+
+  if (result.is_exact)
+    distMat.publish(i, j, result.distance);
+  else
+    distMat.release(i, j); // Only exact distances are stored.
+
+  return result.distance;
 }
 
 /**
  * @brief Fills the distance matrix by computing distances between all pairs of points.
  * @details Populates the distance matrix using the DTW banded algorithm. This operation is parallelized for efficiency.
+ * If all data have the same length, the kernel is DtwKernel::Auto and the Sakoe-Chiba band is used,
+ * each row is computed with the inter-pair SIMD kernel dtwBatch (dtwBatchQuantised for DtwKernel::Quantised).
+ * Otherwise, pairs are computed in square tiles of the upper triangle whose series fit in cache,
+ * dispatched by decreasing sum of length products (see upperTriangleTiles).
+ * If checkpoint_file is set, completed tiles are saved to it every checkpoint_seconds, and with resume
+ * the tiles saved by an earlier (e.g., killed) run are loaded rather than computed again.
+ * With shard_count > 1, only the tiles of the DistanceMatrix in shard are computed and the matrix is not filled, see fillShard.
+ * @throws std::runtime_error if shard is not in [0, shard_count), or shard_count > 1 and the shard cannot be saved.
  */
 void Problem::fillDistanceMatrix()
 {
+  if (shard < 0 || shard >= shard_count)
+    throw std::runtime_error("fillDistanceMatrix: shard " + std::to_string(shard) + " is not in [0, " + std::to_string(shard_count) + ").\n");
+  if (shard_count > 1) return fillShard();
   if (isDistanceMatrixFilled()) return;
+  if (distMat.size() != static_cast<size_t>(size())) refreshDistanceMatrix(); // Not held while computing shards.
 
-  auto oneTask = [&, N = data.size()](int i_linear) {
-    int i{ i_linear / N }, j{ i_linear % N };
-    if (i <= j)
-      distByInd(i, j);
+  std::optional<TileCheckpoint<data_t>> checkpoint; // Not needed for a mapped matrix.
+  if (!checkpoint_file.empty() && !distMat.isMapped()) {
+    checkpoint.emplace(checkpoint_file, checkpoint_seconds);
+    if (const auto loaded = checkpoint->start(distMat, band, data.hash(), distanceConfig(), resume))
+      std::cout << loaded << " completed tiles of the distance matrix are loaded from " << checkpoint_file << ".\n";
+  }
+
+  auto saveCheckpoint = [&] {
+    if (checkpoint) checkpoint->save(distMat); // Only every checkpoint_seconds.
+  };
+
+  auto onePairTask = [&](int i, int j) {
+    distByInd(i, j);
+    saveCheckpoint();
+  };
+
+  auto rowTask = [&](int i, int j_begin, int j_end) { // Pairs (i, j), j in [j_begin, j_end).
+    auto &ws = workspace();
+    auto &candidates = ws.candidates;
+    auto &indices = ws.indices;
+    auto &distances = ws.distances;
+    candidates.clear();
+    indices.clear();
+
+    for (int j = j_begin; j < j_end; j++)
+      if (distMat.claim(i, j)) {
+        candidates.push_back(&p_vec(j));
+        indices.push_back(j);
+      }
+
+    distances.resize(candidates.size());
+    withCost(point_cost, [&](auto c) {
+      dtwBatch<data_t, decltype(c)>(p_vec(i), candidates.data(), static_cast<int>(candidates.size()), distances.data(), band, ws.dtw);
+    });
+
+    for (size_t k = 0; k < indices.size(); k++)
+      distMat.publish(i, indices[k], distances[k]);
+  };
+
+  auto quantisedRowTask = [&](int i, int j_begin, int j_end) {
+    auto &ws = workspace();
+    auto &candidates = ws.quantised_rows;
+    auto &indices = ws.indices;
+    auto &distances = ws.raw;
+    candidates.clear();
+    indices.clear();
+
+    for (int j = j_begin; j < j_end; j++)
+      if (distMat.claim(i, j)) {
+        candidates.push_back(&data.p_quantised[j]);
+        indices.push_back(j);
+      }
+
+    distances.resize(candidates.size());
+    dtwBatchQuantised(data.p_quantised[i], candidates.data(), static_cast<int>(candidates.size()), distances.data(), band, ws.quantised);
+
+    for (size_t k = 0; k < indices.size(); k++) {
+      const int j = indices[k];
+      distMat.publish(i, j, (distances[k] != Quantiser<data_t>::saturated) ? data.quantiser.distance(distances[k])
+                                                                           : dtwBanded(p_vec(i), p_vec(j), band, ws.dtw));
+    }
+  };
+
+  auto oneRowTask = [&, N = data.size()](int i) {
+    rowTask(i, i, N);
+    saveCheckpoint();
+  };
+
+  auto oneQuantisedRowTask = [&, N = data.size()](int i) {
+    quantisedRowTask(i, i, N);
+    saveCheckpoint();
   };
 
   std::cout << "Distance matrix is being filled!" << std::endl;
-  run(oneTask, data.size() * data.size());
+  if (isQuantisedDTW()) data.updateQuantised();
+  if (isIncrementalDTW()) prepareIncremental();
+
+  const bool is_batched = kernel == DtwKernel::Auto && isSakoeChibaDTW() && data.hasEqualLengths() && !isIncrementalDTW();
+  const bool is_quantised_batched = isQuantisedDTW() && data.hasEqualLengths();
+
+  std::vector<double> lengths(size());
+  for (int i = 0; i < size(); i++) lengths[i] = p_vec(i).size();
+
+  if (is_batched) {
+    auto task = worker(oneRowTask);
+    run(task, data.size());
+  } else if (is_quantised_batched) {
+    auto task = worker(oneQuantisedRowTask);
+    run(task, data.size());
+  } else {
+    // Tiles of the upper triangle whose series stay in cache, the longest series first:
+    const double mean_bytes = std::accumulate(lengths.begin(), lengths.end(), 0.0) * sizeof(data_t) / std::max(size(), 1);
+    auto task = worker(onePairTask);
+    runTiles(task, upperTriangleTiles(lengths, tileSize(size(), mean_bytes)));
+  }
+
   is_distMat_filled = true;
+  distMat.flush(); // A mapped matrix is written to its file.
+  if (checkpoint) {
+    checkpoint->save(distMat, true); // All tiles are complete.
+    if (!checkpoint->isOpen()) std::cout << "Checkpoint " << checkpoint_file << " could not be written!" << std::endl;
+  }
+
   std::cout << "Distance matrix has been filled!" << std::endl;
+
+  if (isApproximateDTW()) {
+    const auto error = approximationError();
+    std::cout << "Relative error of approximate distances on " << error.N_pairs << " sampled pairs: "
+              << "mean = " << error.mean << ", max = " << error.max << std::endl;
+  }
 }
+
+/**
+ * @brief Computes the tiles of the DistanceMatrix in shard (see shardTiles) and saves them to checkpoint_file.
+ * @details The tiles are computed with the kernels of fillDistanceMatrix, each into its own buffer, and
+ * appended to checkpoint_file as they are completed (see ShardFile). Only the data and one tile per thread
+ * are held: no distance matrix is kept in memory (see refreshDistanceMatrix) and a mapped one is not used.
+ * With resume, the tiles already saved to checkpoint_file are not computed again. The shards saved by
+ * several processes are combined with mergeShards.
+ * @throws std::runtime_error if checkpoint_file is not set or the shard cannot be written to it.
+ */
+void Problem::fillShard()
+{
+  if (checkpoint_file.empty()) // Otherwise, the shard could not be merged.
+    throw std::runtime_error("fillDistanceMatrix: shards are saved to checkpoint_file, which should be set.\n");
+
+  if (!distMat.isMapped()) distMat.resize(0); // Not needed for the shard.
+  is_distMat_filled = false;
+
+  ShardFile<data_t> file(checkpoint_file);
+  std::vector<uint8_t> done;
+  if (const auto kept = file.start(size(), band, data.hash(), distanceConfig(), resume, done))
+    std::cout << kept << " completed tiles of the shard are kept in " << checkpoint_file << ".\n";
+
+  if (isQuantisedDTW()) data.updateQuantised();
+  const bool is_batched = kernel == DtwKernel::Auto && isSakoeChibaDTW() && data.hasEqualLengths();
+  const bool is_quantised_batched = isQuantisedDTW() && data.hasEqualLengths();
+
+  std::vector<double> lengths(size());
+  for (int i = 0; i < size(); i++) lengths[i] = p_vec(i).size();
+
+  constexpr int tile_size = DistanceMatrix<data_t>::tile;
+  const size_t tile_rows = DistanceMatrix<data_t>::tileRows(size());
+  const auto tiles = shardTiles(lengths, tile_size, shard, shard_count);
+
+  auto oneTileTask = [&](int t) {
+    const auto &tile = tiles[t];
+    const size_t ti = tile.i_begin / tile_size, tj = tile.j_begin / tile_size, index = ShardFile<data_t>::tileIndex(tile_rows, ti, tj);
+    if (done[index / 8] & (1 << (index % 8))) return;
+
+    auto &ws = workspace();
+    auto &block = ws.distances; // Entries of the tile, row by row, in the storage order of DistanceMatrix.
+    auto &candidates = ws.candidates;
+    auto &quantised = ws.quantised_rows;
+    auto &raw = ws.raw;
+    block.resize(DistanceMatrix<data_t>::tileEntries(size(), ti, tj));
+
+    data_t *out = block.data();
+    for (int i = tile.i_begin; i < tile.i_end; i++) {
+      const int j_begin = std::max(tile.j_begin, i), count = tile.j_end - j_begin;
+      if (is_batched) {
+        candidates.clear();
+        for (int j = j_begin; j < tile.j_end; j++) candidates.push_back(&p_vec(j));
+        withCost(point_cost, [&](auto c) { dtwBatch<data_t, decltype(c)>(p_vec(i), candidates.data(), count, out, band, ws.dtw); });
+      } else if (is_quantised_batched) {
+        quantised.clear();
+        for (int j = j_begin; j < tile.j_end; j++) quantised.push_back(&data.p_quantised[j]);
+        raw.resize(count);
+        dtwBatchQuantised(data.p_quantised[i], quantised.data(), count, raw.data(), band, ws.quantised);
+        for (int k = 0; k < count; k++)
+          out[k] = (raw[k] != Quantiser<data_t>::saturated) ? data.quantiser.distance(raw[k]) : dtwBanded(p_vec(i), p_vec(j_begin + k), band, ws.dtw);
+      } else
+        for (int k = 0; k < count; k++) out[k] = computeDistance(i, j_begin + k, ws);
+
+      out += count;
+    }
+
+    file.save(ti, tj, block.data(), block.size());
+  };
+
+  std::cout << "Shard " << shard << " of " << shard_count << ": " << tiles.size() << " tiles." << std::endl;
+  auto task = worker(oneTileTask);
+  run(task, tiles.size());
+
+  if (!file.isOpen())
+    throw std::runtime_error("fillDistanceMatrix: the shard could not be written to " + checkpoint_file.string() + ".\n");
+
+  std::cout << "Shard of the distance matrix has been filled!" << std::endl;
+}
+
+/**
+ * @brief Compares the distances in the distance matrix with exact (full) DTW on randomly sampled pairs.
+ * @details Meant for DtwKernel::Fast and DtwKernel::Quantised, to check whether the approximation is good enough for the data.
+ * Pairs are sampled with replacement, always the same ones for the same data; pairs of the same point
+ * or with empty series are skipped.
+ * @param N_pairs Number of pairs to sample.
+ * @return Mean relative gap (approximate - exact) / exact and maximum absolute relative gap.
+ */
+ApproximationError Problem::approximationError(int N_pairs)
+{
+  ApproximationError error;
+  if (size() < 2) return error;
+
+  std::mt19937 generator(29); // Not randGenerator, so that the clustering does not depend on the kernel.
+  std::uniform_int_distribution<int> index(0, size() - 1);
+  for (int k = 0; k < N_pairs; k++) {
+    const int i = index(generator), j = index(generator);
+    const auto &x = p_vec(i), &y = p_vec(j);
+    if (i == j || x.empty() || y.empty()) continue;
+
+    auto &ws = workspace().dtw;
+    const double exact = withCost(point_cost, [&](auto c) {
+      using Tcost = decltype(c);
+      return wavefrontIsProfitable(x.size(), y.size(), band) ? dtwWavefront<data_t, Tcost>(x, y, band, ws) : dtwBanded<data_t, Tcost>(x, y, band, ws);
+    });
+    const double gap = (exact > 0) ? (distByInd(i, j) - exact) / exact : 0.0;
+    error.mean += gap;
+    error.max = std::max(error.max, std::abs(gap)); // Quantised distances may be below the exact ones.
+    error.N_pairs++;
+  }
+
+  if (error.N_pairs > 0) error.mean /= error.N_pairs;
+
+  return error;
+}
+
 /**
  * @brief Performs clustering based on the specified method.
  * @details Chooses between different clustering methods (K-medoids or MIP) and performs the clustering accordingly.
+ * @throws std::runtime_error if shard_count > 1, see fillShard.
  */
 void Problem::cluster()
 {
+  if (shard_count > 1)
+    throw std::runtime_error("cluster: with shard_count > 1 only a shard of the distance matrix is computed; merge the shards with mergeShards and cluster with shard_count = 1.\n");
+
   switch (method) {
   case Method::Kmedoids:
     cluster_by_kMedoidsPAM();
@@ -193,19 +816,43 @@ void Problem::cluster_by_MIP()
 /**
  * @brief Assigns each data point to the nearest cluster centroid.
  * @details Iterates over each data point, calculating its distance to each centroid, and assigns it to the nearest one.
+ * Centroids that are farther than the nearest one so far are discarded by lower bounds or abandoned early.
+ * If the distance matrix is filled, the distances are read from the rows of the centroids.
  */
 void Problem::assignClusters()
 {
   auto assignClustersTask = [this](int i_p) //!< i_p  and i_c in [0, Np)
   {
-    auto minIt = std::min_element(centroids_ind.begin(), centroids_ind.end(), [this, i_p](int ic_1, int ic_2) {
-      return distByInd(i_p, ic_1) < distByInd(i_p, ic_2);
-    });
-    clusters_ind[i_p] = std::distance(centroids_ind.begin(), minIt);
+    auto best_dist = std::numeric_limits<data_t>::max();
+    clusters_ind[i_p] = 0;
+    for (int i_c = 0; i_c < static_cast<int>(centroids_ind.size()); i_c++) {
+      const auto dist = distByInd(i_p, centroids_ind[i_c], best_dist); // Far medoids are abandoned early.
+      if (dist < best_dist) {
+        best_dist = dist;
+        clusters_ind[i_p] = i_c;
+      }
+    }
   };
 
   clusters_ind.resize(data.size()); // Resize before assigning.
-  run(assignClustersTask, data.size());
+
+  if (isDistanceMatrixFilled()) { // Reads the row of each medoid at once rather than N * Nc scattered entries.
+    std::vector<std::vector<data_t>> medoid_rows(centroids_ind.size());
+    for (size_t i_c = 0; i_c < centroids_ind.size(); i_c++)
+      distanceMatrix().row(centroids_ind[i_c], medoid_rows[i_c]);
+
+    for (int i_p = 0; i_p < size(); i_p++) {
+      clusters_ind[i_p] = 0;
+      for (int i_c = 1; i_c < static_cast<int>(centroids_ind.size()); i_c++)
+        if (medoid_rows[i_c][i_p] < medoid_rows[clusters_ind[i_p]][i_p]) clusters_ind[i_p] = i_c;
+    }
+    return;
+  }
+
+  data.updateEnvelopes(band); // For lower bounds in distByInd.
+  if (isQuantisedDTW()) data.updateQuantised();
+  auto task = worker(assignClustersTask);
+  run(task, data.size());
 }
 
 /**
@@ -222,13 +869,15 @@ void Problem::distanceInClusters()
         distByInd(i_p, i);
   };
 
-  run(distanceInClustersTask, size());
+  auto task = worker(distanceInClustersTask);
+  run(task, size());
 }
 
 /**
  * @brief Calculates and updates the medoids of each cluster.
  * @details This function iterates through each data point and calculates the total cost of designating that point
  * as the medoid of its cluster. The point with the minimum total cost is set as the new medoid for that cluster.
+ * If the distance matrix is filled, the costs are summed in one pass over the matrix in storage (tile) order.
  */
 void Problem::calculateMedoids()
 {
@@ -245,7 +894,27 @@ void Problem::calculateMedoids()
     pointCosts[i_p] = sum;
   };
 
-  run(findBetterMedoidTask, size());
+  const size_t groups = std::max(omp_get_max_threads(), 1); // Partial sums per group, see runGrouped.
+  std::vector<std::vector<double>> partialCosts;
+  auto tileRowTask = [&](size_t g, size_t t) { // Each entry is read once, tile by tile.
+    distanceMatrix().forEachPair(t, [&, &partial = partialCosts[g]](size_t i, size_t j, data_t distance) {
+      if (clusters_ind[i] != clusters_ind[j]) return;
+      partial[i] += distance;
+      partial[j] += distance;
+    });
+  };
+
+  if (isDistanceMatrixFilled()) {
+    partialCosts.assign(groups, std::vector<double>(size(), 0));
+    runGrouped(tileRowTask, distanceMatrix().tileRows(), groups);
+    pointCosts.assign(size(), 0);
+    for (const auto &partial : partialCosts) // In a fixed order, so the sums do not depend on the scheduling.
+      for (const auto i : Range(size()))
+        pointCosts[i] += partial[i];
+  } else {
+    auto task = worker(findBetterMedoidTask);
+    run(task, size());
+  }
 
   clusterCosts.assign(cluster_size(), std::numeric_limits<double>::max());
   for (const auto i : Range(size()))
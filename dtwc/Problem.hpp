@@ -12,19 +12,27 @@
 
 #pragma once
 
-#include "Data.hpp"           // for Data
-#include "DataLoader.hpp"     // for DataLoader
-#include "fileOperations.hpp" // for writeMatrix, readMatrix
-#include "settings.hpp"       // for data_t, resultsPath
-#include "enums/enums.hpp"    // for using Enum types.
-#include "initialisation.hpp" // for init functions
+#include "Data.hpp"                 // for Data
+#include "DataLoader.hpp"           // for DataLoader
+#include "fileOperations.hpp"       // for writeMatrix, readMatrix
+#include "types/DistanceCache.hpp"  // for DistanceCache, DistanceMatrix
+#include "types/TileCheckpoint.hpp" // for TileCheckpoint
+#include "settings.hpp"             // for data_t, resultsPath
+#include "enums/enums.hpp"          // for using Enum types.
+#include "initialisation.hpp"       // for init functions
+#include "warping_window.hpp"       // for WarpingWindow
+#include "warping_path.hpp"         // for DtwPath
+#include "warping_fast.hpp"         // for ApproximationError
+#include "warping_incremental.hpp"  // for IncrementalDtw
+#include "warping_quantised.hpp"    // for DtwWorkspace, QuantisedWorkspace
 
 #include <cstddef>     // for size_t
 #include <filesystem>  // for operator/, path
 #include <ostream>     // for operator<<, basic_ostream, ofstream
 #include <string>      // for char_traits, operator+, operator<<
 #include <string_view> // for string_view
-#include <utility>     // for pair
+#include <tuple>       // for tuple
+#include <utility>     // for pair, move
 #include <vector>      // for vector, allocator
 #include <type_traits> // std::decay_t
 #include <functional>  // std::function
@@ -45,28 +53,74 @@ namespace dtwc {
 class Problem
 {
 public:
-  using distMat_t = arma::Mat<double>;
+  using distMat_t = arma::Mat<data_t>; //!< Dense distance matrix, see DistanceMatrix::toArma.
   using path_t = std::decay_t<decltype(settings::resultsPath)>;
 
 private:
   int Nc{ 1 };                                      /*!< Number of clusters. */
-  distMat_t distMat;                                /*!< Distance matrix. */
+  DistanceCache<data_t> distMat;                    /*!< Lazily computed distance matrix, symmetric so only the upper triangle is stored; in memory or in a mapped file. */
   Solver mipSolver{ settings::DEFAULT_MIP_SOLVER }; /*!< Solver for MIP. */
 
   bool is_distMat_filled{ false }; /*!< Flag indicating if the distance matrix is filled. */
 
+  std::vector<IncrementalDtw<data_t>> incremental_dtw; /*!< Cost matrix borders of pairs (i > j) at i * (i - 1) / 2 + j, see isIncrementalDTW. */
+
+  /// Scratch memory of one worker thread for computing distances, see workspace().
+  struct Workspace
+  {
+    DtwWorkspace<data_t> dtw;                                 /*!< Of the kernels. */
+    QuantisedWorkspace quantised;                             /*!< Of the quantised kernels. */
+    WarpingWindow window;                                     /*!< Window of the last pair, reused for pairs of the same lengths. */
+    std::tuple<WindowType, int, double> window_key;           /*!< Window type, band and slope of window. */
+    std::vector<const std::vector<data_t> *> candidates;      /*!< Series of a batch of pairs. */
+    std::vector<const std::vector<int16_t> *> quantised_rows; /*!< Quantised series of a batch of pairs. */
+    std::vector<int> indices;                                 /*!< Indices of the series of a batch. */
+    std::vector<data_t> distances;                            /*!< Distances of a batch, or entries of a tile. */
+    std::vector<int32_t> raw;                                 /*!< Quantised distances of a batch. */
+  };
+  std::vector<Workspace> workspaces;               /*!< One per thread of the parallel passes of the Problem, see worker(). */
+  static thread_local const Problem *worker_owner; /*!< Problem whose parallel pass the calling thread runs a task of, if any. */
+  static thread_local Workspace *worker_workspace; /*!< Workspace of that task. */
+
   // Private functions:
   std::pair<int, double> cluster_by_kMedoidsPAM_single(int rep);
 
   void writeBestRep(int best_rep);
   void writeMedoids(std::vector<std::vector<int>> &centroids_all, int rep, double total_cost);
   void distanceInClusters();
+  void checkMatrixFile(const DistanceFileHeader &header, const fs::path &distMat_path) const;
+  void checkClusters(const std::string &caller) const;
+
+  size_t pairCount() const { return static_cast<size_t>(data.size()) * (data.size() - 1) / 2; }
+  void prepareIncremental();
+  data_t incrementalDistance(int i, int j);
+  Workspace &workspace();
+  static Workspace &ownWorkspace();
+  template <typename Tfun>
+  auto worker(Tfun &task);
+  data_t computeDistance(int i, int j, Workspace &ws);
+  void fillShard();
 
 public:
   Method method{ Method::Kmedoids };         /*!< Clustering method. */
   int maxIter{ 100 };                        /*!< Maximum number of iteration for iterative-methods. */
   int N_repetition{ 1 };                     /*!< Repetition for iterative-methods. */
   int band{ settings::DEFAULT_BAND_LENGTH }; /*!< Band length for Sakoe-Chiba band, -1 for full DTW. */
+  DtwKernel kernel{ DtwKernel::Auto };       /*!< DTW implementation used for distances. */
+  DtwCost point_cost{ DtwCost::L1 };         /*!< Pointwise cost of the distances; DtwKernel::Quantised and incremental DTW are for DtwCost::L1 only. */
+  int fast_radius{ 10 };                     /*!< Search radius of DtwKernel::Fast. */
+  bool incremental{ false };                 /*!< Keep the cost matrix borders of every pair so that appendSamples updates distances incrementally, see isIncrementalDTW. */
+  bool binary_distMat{ false };              /*!< Write the distance matrix in binary format (see types/DistanceFile.hpp) instead of CSV. */
+  fs::path checkpoint_file{};                /*!< File to which fillDistanceMatrix periodically saves completed tiles (see TileCheckpoint); empty for none. Unused for a mapped matrix, whose file keeps its entries. */
+  double checkpoint_seconds{ 60 };           /*!< Minimum time between two checkpoints. */
+  bool resume{ false };                      /*!< Whether fillDistanceMatrix loads the completed tiles of checkpoint_file instead of overwriting it. */
+  int shard{ 0 };                            /*!< Shard of the distance matrix computed by fillDistanceMatrix, in [0, shard_count). */
+  int shard_count{ 1 };                      /*!< Number of shards: fillDistanceMatrix only computes the tiles of shard (see shardTiles) and saves them to checkpoint_file, to be merged with mergeShards. No distance matrix is kept in memory meanwhile, see fillShard. */
+
+  WindowType window_type{ WindowType::SakoeChiba };                  /*!< Global constraint of warping paths. */
+  double itakura_slope{ 2.0 };                                       /*!< Maximum slope for WindowType::Itakura. */
+  StepPattern step_pattern{ StepPattern::Symmetric1 };               /*!< Local constraint of warping paths. */
+  MultivariateMode multivariate_mode{ MultivariateMode::Dependent }; /*!< How channels of multivariate data (data.ndim > 1) are warped. */
 
   std::function<void(Problem &)> init_fun{ init::random }; /*!< Initialisation function. */
 
@@ -101,31 +155,55 @@ public:
   int centroid_of(int i_p) const { return centroids_ind[clusters_ind[i_p]]; } // [0, Np) Get the centroid of the cluster of i_p
 
   void readDistanceMatrix(const fs::path &distMat_path);
+  void mapDistanceMatrix(const fs::path &distMat_path);
   void set_numberOfClusters(int Nc_);
   void set_clusters(std::vector<int> &candidate_centroids);
   bool set_solver(dtwc::Solver solver_);
 
   void set_data(dtwc::Data data_)
   {
-    data = data_;
+    data = std::move(data_);
+    data.invalidateEnvelopes();
+    data.invalidateQuantised();
     refreshDistanceMatrix();
   }
 
-  data_t maxDistance() const { return distMat.max(); }
+  void append_data(Data new_data);
+  void remove_data(std::vector<int> indices);
+
+  data_t maxDistance() const { return distMat.matrix().max(); }
+  const DistanceMatrix<data_t> &distanceMatrix() const { return distMat.matrix(); }
   data_t distByInd(int i, int j);
+  data_t distByInd(int i, int j, data_t best_so_far);
+  void releaseWorkspaces();
+  size_t workspaceBytes() const;
   bool isDistanceMatrixFilled() const { return is_distMat_filled; }
+  bool holdsDistanceMatrix() const { return distMat.size() == static_cast<size_t>(size()); } // Not while computing shards, see fillShard.
+  // Univariate DTW within the Sakoe-Chiba band, which the specialised kernels and lower bounds are written for:
+  bool isSakoeChibaDTW() const { return window_type == WindowType::SakoeChiba && step_pattern == StepPattern::Symmetric1 && data.ndim == 1; }
+  bool isQuantisedDTW() const { return kernel == DtwKernel::Quantised && point_cost == DtwCost::L1 && isSakoeChibaDTW(); }
+  bool isApproximateDTW() const { return (kernel == DtwKernel::Fast && band < 0 && isSakoeChibaDTW()) || isQuantisedDTW(); }
+  // Exact univariate full DTW, whose cost matrix can be extended when series grow (O(n + m) memory per pair):
+  bool isIncrementalDTW() const { return incremental && band < 0 && point_cost == DtwCost::L1 && isSakoeChibaDTW() && !isApproximateDTW(); }
+  uint32_t distanceConfig() const;
+  void appendSamples(int i, const std::vector<data_t> &samples);
+  ApproximationError approximationError(int N_pairs = 20);
+
+  WarpingWindow warpingWindow(int n_x, int n_y) const;
+  DtwPath<data_t> warpingPath(int i, int j) const;
 
   void fillDistanceMatrix();
   void printDistanceMatrix() const;
 
   void writeDistanceMatrix(const std::string &name_) const;
-  void writeDistanceMatrix() const { writeDistanceMatrix(name + "_distanceMatrix.csv"); }
+  void writeDistanceMatrix() const { writeDistanceMatrix(name + (binary_distMat ? "_distanceMatrix.bin" : "_distanceMatrix.csv")); }
 
   void printClusters() const;
   void writeClusters();
 
   void writeMedoidMembers(int iter, int rep = 0) const;
   void writeSilhouettes();
+  void writeAlignments() const;
 
   // Initialisation of clusters:
   void init() { init_fun(*this); }
@@ -53,12 +53,25 @@ void Problem::writeMedoids(std::vector<std::vector<int>> &centroids_all, int rep
   medoidsFile.close();
 }
 
+/**
+ *  @brief Checks that there are a medoid per cluster and a cluster per point, e.g., after remove_data.
+ *  @param caller Name of the calling function, for the error message.
+ *  @throws std::runtime_error if the data are not clustered.
+ */
+void Problem::checkClusters(const std::string &caller) const
+{
+  if (static_cast<int>(centroids_ind.size()) != Nc || static_cast<int>(clusters_ind.size()) != size())
+    throw std::runtime_error(caller + ": the data are not clustered; please cluster the data first.\n");
+}
+
 /**
  *  @brief Prints cluster information to the standard output.
  *  @details Displays each centroid and its members.
+ *  @throws std::runtime_error if the data are not clustered.
  */
 void Problem::printClusters() const
 {
+  checkClusters("printClusters");
   std::cout << "Clusters centroids: ";
   for (auto ind : centroids_ind)
     std::cout << get_name(ind) << ' ';
@@ -79,9 +92,11 @@ void Problem::printClusters() const
 /**
  *  @brief Writes cluster information to a CSV file.
  *  @details The file includes cluster centroids and members, and the total cost.
+ *  @throws std::runtime_error if the data are not clustered.
  */
 void Problem::writeClusters()
 {
+  checkClusters("writeClusters");
   const auto file_name = name + "_Nc_" + std::to_string(Nc) + ".csv";
 
   std::ofstream myFile(output_folder / file_name, std::ios_base::out);
@@ -126,13 +141,38 @@ void Problem::writeSilhouettes()
   myFile.close();
 }
 
+/**
+ *  @brief Writes the alignment (optimal warping path) of each data point to its medoid to a CSV file.
+ *  @details Each row holds one matched pair of indices. Paths are computed in linear memory,
+ *  so this also works for long series; see Problem::warpingPath.
+ *  @throws std::runtime_error if the data are not clustered.
+ */
+void Problem::writeAlignments() const
+{
+  checkClusters("writeAlignments");
+  const auto file_name = name + "_alignments_Nc_" + std::to_string(Nc) + ".csv";
+
+  std::ofstream myFile(output_folder / file_name, std::ios_base::out);
+  myFile << "Data,Medoid,Data index,Medoid index\n";
+
+  for (auto i : Range(size())) {
+    const int medoid = centroid_of(i);
+    for (const auto &[i_data, i_medoid] : warpingPath(i, medoid).path)
+      myFile << get_name(i) << ',' << get_name(medoid) << ',' << i_data << ',' << i_medoid << '\n';
+  }
+
+  myFile.close();
+}
+
 /**
  *  @brief Writes the members of each medoid to a CSV file.
  *  @param iter The current iteration number.
  *  @param rep The current repetition number.
+ *  @throws std::runtime_error if the data are not clustered.
  */
 void Problem::writeMedoidMembers(int iter, int rep) const
 {
+  checkClusters("writeMedoidMembers");
   const std::string medoid_name = "medoidMembers_Nc_" + std::to_string(Nc) + "_rep_"
                                   + std::to_string(rep) + "_iter_" + std::to_string(iter) + ".csv";
 
@@ -150,11 +190,20 @@ void Problem::writeMedoidMembers(int iter, int rep) const
 
 /**
  *  @brief Writes the distance matrix to a file.
+ *  @details Names ending with ".bin" are written in the binary format of types/DistanceFile.hpp, with the band
+ *  and the hash of the data; other names as CSV. The file a matrix is mapped to (see mapDistanceMatrix) is
+ *  already up to date, so it is only flushed.
  *  @param name_ The name of the output file.
  */
 void Problem::writeDistanceMatrix(const std::string &name_) const
 {
-  writeMatrix(distMat, output_folder / name_);
+  const auto path = output_folder / name_;
+  if (distMat.isMapped() && fs::exists(path) && fs::equivalent(path, distMat.path()))
+    distMat.flush();
+  else if (path.extension() == ".bin")
+    writeBinaryMatrix(distMat.matrix(), path, band, data.hash(), distanceConfig());
+  else
+    writeMatrix(distMat.matrix(), path);
 }
 
 /**
@@ -170,18 +219,72 @@ void Problem::writeBestRep(int best_rep)
   std::cout << "Best repetition: " << best_rep << '\n';
 }
 
+/**
+ *  @brief Checks that a binary distance matrix file belongs to this problem.
+ *  @throws std::runtime_error if its size, band, data hash or configuration (see distanceConfig) differ from the problem's.
+ */
+void Problem::checkMatrixFile(const DistanceFileHeader &header, const fs::path &distMat_path) const
+{
+  std::string mismatch;
+  if (header.N != static_cast<uint64_t>(size()))
+    mismatch = "has " + std::to_string(header.N) + " series instead of " + std::to_string(size());
+  else if (header.band != band)
+    mismatch = "was computed with band " + std::to_string(header.band) + " instead of " + std::to_string(band);
+  else if (header.data_hash != data.hash())
+    mismatch = "was computed for other data";
+  else if (header.config != distanceConfig())
+    mismatch = "was computed with another cost, warping window, step pattern, multivariate mode or approximate kernel";
+
+  if (!mismatch.empty())
+    throw std::runtime_error("Distance matrix file " + distMat_path.string() + " " + mismatch + ".\n");
+}
+
 /**
  *  @brief Reads the distance matrix from a file.
- *  @details If the matrix cannot be read, continues without it.
+ *  @details Binary files (see types/DistanceFile.hpp) are read without parsing; CSV files are parsed.
+ *  If the matrix cannot be read, continues without it.
  *  @param distMat_path The file path of the distance matrix.
+ *  @throws std::runtime_error if a binary file belongs to another size, band, data or configuration, see checkMatrixFile.
  */
 void Problem::readDistanceMatrix(const fs::path &distMat_path)
 {
+  const auto header = readMatrixHeader(distMat_path);
+  if (header.isValid()) checkMatrixFile(header, distMat_path); // Refused before anything is read.
+
   try {
-    readMatrix(distMat, distMat_path);
+    DistanceMatrix<data_t> matrix;
+    if (header.isValid())
+      readBinaryMatrix(matrix, distMat_path);
+    else
+      readMatrix(matrix, distMat_path);
+
+    distMat.assign(matrix); // Non-negative entries are computed distances.
   } catch (...) {
     std::cout << "Distance matrix could not be read! Continuing without matrix!" << std::endl;
   }
 }
 
+/**
+ *  @brief Keeps the distance matrix in a memory-mapped file, for data whose matrix does not fit in memory.
+ *  @details Distances computed so far are dropped. If the file was left by an earlier (e.g., interrupted) run
+ *  or written by writeDistanceMatrix in binary format, its distances are used without copying, and the matrix
+ *  is filled if all are computed. Other files are overwritten.
+ *  @param distMat_path The file path of the mapped distance matrix.
+ *  @throws std::runtime_error if the file cannot be mapped, or if it is a binary distance matrix file
+ *  of another size, band, data or configuration (see checkMatrixFile).
+ */
+void Problem::mapDistanceMatrix(const fs::path &distMat_path)
+{
+  const auto header = readMatrixHeader(distMat_path);
+  if (header.isValid()) checkMatrixFile(header, distMat_path); // Not overwritten.
+
+  incremental_dtw.clear();
+  const bool resumed = distMat.open(distMat_path, size(), true, band, data.hash(), distanceConfig());
+  const size_t ready = distMat.readyCount(), entries = distMat.matrix().entries();
+  is_distMat_filled = (ready == entries);
+
+  if (resumed)
+    std::cout << "Distance matrix file " << distMat_path << " is reused: " << ready << " of " << entries << " distances are computed." << std::endl;
+}
+
 } // namespace dtwc
\ No newline at end of file
@@ -0,0 +1,119 @@
+/**
+ * @file costs.hpp
+ * @brief Pointwise cost policies for the time warping kernels.
+ *
+ * @details Kernels take the cost as a template parameter (e.g., dtwBanded<double, cost::SquaredL2>)
+ * so that every combination is specialised and the cost is inlined into the inner loop.
+ * Any default-constructible type with `data_t operator()(data_t, data_t) const` returning
+ * a non-negative value can be used as a cost. Kernels always call it as cost(x[i], y[j]) for
+ * kernel(x, y), so costs need not be symmetric; lower bounds (lower_bounds.hpp) are only valid
+ * for costs of the form |x - y|^p with p >= 1.
+ *
+ * Windowed kernels internally work on cell costs, i.e., the cost of matching element (or frame)
+ * i of x with element j of y, so that the same recurrence serves channel-interleaved
+ * multivariate series (see warping_multivariate.hpp).
+ *
+ * @date 17 Oct 2026
+ * @author Volkan Kumtepeli
+ * @author Becky Perriment
+ */
+
+#pragma once
+
+#include <cmath> // for abs
+
+namespace dtwc::cost {
+
+/// @brief Absolute difference |x - y|, the default cost.
+struct L1
+{
+  template <typename data_t>
+  data_t operator()(data_t x, data_t y) const { return std::abs(x - y); }
+};
+
+/// @brief Squared difference (x - y)^2.
+struct SquaredL2
+{
+  template <typename data_t>
+  data_t operator()(data_t x, data_t y) const { return (x - y) * (x - y); }
+};
+
+} // namespace dtwc::cost
+
+namespace dtwc::detail {
+
+/// @brief Tcost with swapped arguments, for kernels which swap x and y to iterate over the longer sequence first.
+template <typename Tcost>
+struct Swapped
+{
+  template <typename data_t>
+  data_t operator()(data_t x, data_t y) const { return Tcost{}(y, x); }
+};
+
+/// @brief Cost to call a kernel with swapped sequences: kernel<swapped_t<Tcost>>(y, x) == kernel<Tcost>(x, y).
+template <typename Tcost>
+struct SwappedCost
+{
+  using type = Swapped<Tcost>;
+};
+
+template <typename Tcost>
+struct SwappedCost<Swapped<Tcost>>
+{
+  using type = Tcost;
+};
+
+template <>
+struct SwappedCost<cost::L1>
+{
+  using type = cost::L1; // Symmetric.
+};
+
+template <>
+struct SwappedCost<cost::SquaredL2>
+{
+  using type = cost::SquaredL2; // Symmetric.
+};
+
+template <typename Tcost>
+using swapped_t = typename SwappedCost<Tcost>::type;
+
+/// @brief Cell cost of univariate series: Tcost(x[i], y[j]).
+template <typename data_t, typename Tcost>
+struct PointCost
+{
+  const data_t *x, *y;
+
+  data_t operator()(int i, int j) const { return Tcost{}(x[i], y[j]); }
+};
+
+/// @brief Cell cost of one channel of channel-interleaved series: Tcost(x[i * ndim], y[j * ndim]) with x, y at the channel.
+template <typename data_t, typename Tcost>
+struct ChannelCost
+{
+  const data_t *x, *y;
+  int ndim;
+
+  data_t operator()(int i, int j) const { return Tcost{}(x[i * ndim], y[j * ndim]); }
+};
+
+/// @brief Cell cost of channel-interleaved series: sum of the costs of all ndim channels of frames i and j.
+template <typename data_t, typename Tcost>
+struct FrameCost
+{
+  const data_t *x, *y;
+  int ndim;
+
+  data_t operator()(int i, int j) const
+  {
+    const data_t *xi = x + i * ndim, *yj = y + j * ndim;
+    data_t sum{ 0 };
+#pragma omp simd reduction(+ : sum)
+    for (int c = 0; c < ndim; c++)
+      sum += Tcost{}(xi[c], yj[c]);
+
+    return sum;
+  }
+};
+
+} // namespace dtwc::detail
@@ -11,6 +11,20 @@
 #include "settings.hpp"
 #include "fileOperations.hpp"
 #include "Problem.hpp"
+#include "scores.hpp"
+#include "shards.hpp"
 #include "DataLoader.hpp"
 #include "utility.hpp"
-#include "warping.hpp"
\ No newline at end of file
+#include "costs.hpp"
+#include "warping.hpp"
+#include "warping_wavefront.hpp"
+#include "warping_batch.hpp"
+#include "warping_pruned.hpp"
+#include "warping_window.hpp"
+#include "warping_path.hpp"
+#include "warping_fast.hpp"
+#include "warping_quantised.hpp"
+#include "warping_multivariate.hpp"
+#include "warping_subsequence.hpp"
+#include "warping_incremental.hpp"
+#include "lower_bounds.hpp"
\ No newline at end of file
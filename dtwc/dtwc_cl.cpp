@@ -12,12 +12,16 @@
 
 #include "dtwc.hpp"
 
+#include <filesystem>
 #include <iostream>
 #include <string>
+#include <utility>
+#include <vector>
 #include <CLI/CLI.hpp>
 
 // Declarations of the auxillary functions:
 dtwc::Range str_to_range(std::string str);
+std::pair<int, int> str_to_shard(const std::string &str);
 
 int main(int argc, char **argv)
 {
@@ -32,11 +36,27 @@ int main(int argc, char **argv)
   std::string method{ "kMedoids" };
   std::string solver{ "HiGHS" };
   std::string distMatPath{ "" };
+  std::string mmapPath{ "" };
+  std::string checkpointPath{ "" };
+  std::string shard_str{ "" };
+  std::vector<std::string> mergePaths;
+  std::string kernel{ "auto" };
+  std::string cost{ "L1" };
+  std::string window{ "sakoeChiba" };
+  std::string stepPattern{ "symmetric1" };
+  std::string multivariate{ "dependent" };
 
   int maxIter{ dtwc::settings::DEFAULT_MAX_ITER };
   int skipRows{ 0 }, skipCols{ 0 };
   int N_repetition{ 1 };
   int bandWidth{ -1 };
+  double itakuraSlope{ 2.0 };
+  int fastRadius{ 10 };
+  int nChannels{ 1 };
+  bool writeAlignments{ false };
+  bool binaryDistMat{ false };
+  bool resume{ false };
+  double checkpointSeconds{ 60 };
 
   CLI::App app{ app_description };
 
@@ -51,7 +71,23 @@ int main(int argc, char **argv)
   app.add_option("--repeat,--Nrepeat,--Nrepetition,--Nrep", N_repetition, "Number of repetitions for Kmedoids.");
   app.add_option("--solver,--mip_solver,--mipSolver", solver, "Number of repetitions for Kmedoids.");
   app.add_option("--bandwidth,--bandw,--bandlength", bandWidth, "Width of the band used.");
-  app.add_option("--distMat,--distance_matrix,--distances", distMatPath, "Path for distance matrix.");
+  app.add_option("--distMat,--distance_matrix,--distances", distMatPath, "Path for distance matrix (CSV, or binary if written with the .bin extension).");
+  app.add_flag("--binaryDistMat,--binary", binaryDistMat, "Write the distance matrix in binary (.bin) instead of CSV format");
+  app.add_option("--checkpoint", checkpointPath, "File to which completed tiles of the distance matrix are saved periodically");
+  app.add_option("--checkpointInterval,--checkpoint_interval", checkpointSeconds, "Seconds between checkpoints (default = 60)");
+  app.add_flag("--resume", resume, "Load the completed tiles of the checkpoint instead of computing them again");
+  app.add_option("--shard", shard_str, "Only compute shard k (from 0) of K of the distance matrix, in the format k/K, and write its tiles to the checkpoint file (default: <output>/<name>_shard_k_of_K.bin); --mmap is only used by --merge");
+  app.add_option("--merge", mergePaths, "Merge these shard files into <output>/<name>_distanceMatrix.bin, or into the --mmap file, and exit");
+  app.add_option("--mmap,--mappedDistMat", mmapPath, "File to keep the distance matrix in instead of memory (reused if left by an interrupted run)");
+  app.add_option("--kernel,--dtw_kernel", kernel, "DTW implementation (auto, banded, wavefront, pruned, fast or quantised)");
+  app.add_option("--cost", cost, "Pointwise cost of the DTW distances (L1 or squaredL2)");
+  app.add_option("--radius,--fastRadius", fastRadius, "Search radius of the approximate (fast) kernel (default = 10)");
+  app.add_option("--window,--warping_window", window, "Global constraint (sakoeChiba or itakura)");
+  app.add_option("--itakuraSlope,--itakura_slope", itakuraSlope, "Maximum slope of the Itakura parallelogram (default = 2)");
+  app.add_option("--stepPattern,--step_pattern", stepPattern, "Step pattern (symmetric1 or symmetricP1)");
+  app.add_flag("--alignments,--writeAlignments", writeAlignments, "Write the warping path of each series to its medoid");
+  app.add_option("--channels,--ndim", nChannels, "Number of channels (columns from skipCols on) of each series (default = 1)");
+  app.add_option("--multivariate,--multivariate_mode", multivariate, "Warping of multichannel series (dependent: shared path, or independent)");
 
   CLI11_PARSE(app, argc, argv);
 
@@ -63,6 +99,21 @@ int main(int argc, char **argv)
 
   std::cout << "Arguments are parsed." << std::endl;
 
+  if (!mergePaths.empty()) {
+    const auto merged = (mmapPath != "") ? std::filesystem::path(mmapPath) : std::filesystem::path(outPath) / (probName + "_distanceMatrix.bin");
+    try {
+      const auto header = dtwc::mergeShards<dtwc::data_t>({ mergePaths.begin(), mergePaths.end() }, merged, mmapPath != "");
+      std::cout << mergePaths.size() << " shards of the " << header.N << " x " << header.N << " distance matrix are merged into " << merged << ".\n";
+    } catch (const std::exception &e) {
+      std::cout << e.what() << "Shards could not be merged!" << std::endl;
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
+
+  const auto [shard, shardCount] = str_to_shard(shard_str);
+  if (shardCount < 1) return EXIT_FAILURE;
+
   auto Nc = str_to_range(Nc_str); //!< dtwc::Range(3,5);
   dtwc::Clock clk;                //!< Create a clock object
 
@@ -76,19 +127,30 @@ int main(int argc, char **argv)
 
   dtwc::DataLoader dl{ inputPath };
   dl.startColumn(skipCols).startRow(skipRows); //!< Since dummy files are in Pandas format skip first row/column.
+  dl.ndim(nChannels);
 
-  dtwc::Problem prob{ probName, dl }; //!< Create a problem.
+  dtwc::Problem prob{ probName }; //!< Create a problem.
+  prob.shard = shard;
+  prob.shard_count = shardCount; // Before the data, so that a shard does not allocate the distance matrix.
+  prob.set_data(dl.load());
   std::cout << "Data loading finished at " << clk << "\n";
 
   prob.maxIter = maxIter;
   prob.N_repetition = N_repetition;
   prob.output_folder = outPath;
   prob.band = bandWidth;
+  prob.binary_distMat = binaryDistMat;
+  prob.checkpoint_file = checkpointPath;
+  prob.checkpoint_seconds = checkpointSeconds;
+  prob.resume = resume;
+  if (mmapPath != "" && shardCount == 1) // Shards are written to their own files, and merged into the --mmap file with --merge.
+    prob.mapDistanceMatrix(mmapPath);    // Before reading, so that a read matrix is written to the file.
+
   try {
     if (distMatPath != "")
       prob.readDistanceMatrix(distMatPath);
   } catch (const std::exception &e) {
-    std::cout << "Distance matrix could not be read! Continuing without matrix!" << std::endl;
+    std::cout << e.what() << "Distance matrix could not be read! Continuing without matrix!" << std::endl;
   }
 
 
@@ -100,6 +162,45 @@ int main(int argc, char **argv)
     std::cout << "MIP solver is not recognized! Continuing with the default solver.";
 
 
+  if (kernel == "auto")
+    prob.kernel = dtwc::DtwKernel::Auto;
+  else if (kernel == "banded")
+    prob.kernel = dtwc::DtwKernel::Banded;
+  else if (kernel == "wavefront")
+    prob.kernel = dtwc::DtwKernel::Wavefront;
+  else if (kernel == "pruned")
+    prob.kernel = dtwc::DtwKernel::Pruned;
+  else if (kernel == "fast")
+    prob.kernel = dtwc::DtwKernel::Fast;
+  else if (kernel == "quantised")
+    prob.kernel = dtwc::DtwKernel::Quantised;
+  else
+    std::cout << "DTW kernel is not recognised! Using default kernel: auto.\n";
+
+  if (cost == "squaredL2")
+    prob.point_cost = dtwc::DtwCost::SquaredL2;
+  else if (cost != "L1")
+    std::cout << "Pointwise cost is not recognised! Using default cost: L1.\n";
+
+
+  prob.fast_radius = fastRadius;
+  prob.itakura_slope = itakuraSlope;
+  if (window == "itakura")
+    prob.window_type = dtwc::WindowType::Itakura;
+  else if (window != "sakoeChiba")
+    std::cout << "Warping window is not recognised! Using default window: sakoeChiba.\n";
+
+  if (multivariate == "independent")
+    prob.multivariate_mode = dtwc::MultivariateMode::Independent;
+  else if (multivariate != "dependent")
+    std::cout << "Multivariate mode is not recognised! Using default mode: dependent.\n";
+
+  if (stepPattern == "symmetricP1")
+    prob.step_pattern = dtwc::StepPattern::SymmetricP1;
+  else if (stepPattern != "symmetric1")
+    std::cout << "Step pattern is not recognised! Using default step pattern: symmetric1.\n";
+
+
   if (method == "kMedoids")
     prob.method = dtwc::Method::Kmedoids;
   else if (method == "mip" || method == "MIP")
@@ -107,10 +208,20 @@ int main(int argc, char **argv)
   else
     std::cout << "Clustering method is not recognised! Using default clustering method: kMedoids.\n";
 
+  if (shardCount > 1) {
+    if (checkpointPath == "")
+      prob.checkpoint_file = std::filesystem::path(outPath) / (probName + "_shard_" + std::to_string(shard) + "_of_" + std::to_string(shardCount) + ".bin");
+
+    prob.fillDistanceMatrix();
+    std::cout << "Shard " << shard << " of " << shardCount << " is written to " << prob.checkpoint_file << ". Finished " << clk << std::endl;
+    return EXIT_SUCCESS;
+  }
+
   for (auto nc : Nc) {
     std::cout << "\n\nClustering by " << method << " for Number of clusters : " << nc << std::endl;
     prob.set_numberOfClusters(nc); //!< Nc = number of clusters.
     prob.cluster_and_process();
+    if (writeAlignments) prob.writeAlignments();
   }
 
   std::cout << "Finished all tasks " << clk << std::endl;
@@ -139,3 +250,19 @@ dtwc::Range str_to_range(std::string str)
 
   return range;
 }
+
+std::pair<int, int> str_to_shard(const std::string &str)
+{
+  if (str.empty()) return { 0, 1 }; // The whole distance matrix.
+
+  try {
+    const size_t pos = str.find('/');
+    const int shard = std::stoi(str.substr(0, pos)), count = std::stoi(str.substr(pos + 1));
+    if (pos != std::string::npos && count >= 1 && shard >= 0 && shard < count)
+      return { shard, count };
+  } catch (const std::exception &) {
+  }
+
+  std::cerr << "Error processing input: shard " << str << " is not in the format k/K with 0 <= k < K." << std::endl;
+  return { 0, 0 };
+}
@@ -0,0 +1,18 @@
+/**
+ * @file DtwCost.hpp
+ * @brief DtwCost enum for selecting the pointwise cost of the DTW distances.
+ * @author Volkan Kumtepeli
+ * @author Becky Perriment
+ * @date 17 Oct 2026
+ */
+
+#pragma once
+
+namespace dtwc {
+
+enum class DtwCost {
+  L1,       //<! |x - y| (cost::L1).
+  SquaredL2 //<! (x - y)^2 (cost::SquaredL2).
+};
+
+}
@@ -0,0 +1,22 @@
+/**
+ * @file DtwKernel.hpp
+ * @brief DtwKernel enum for selecting the DTW implementation.
+ * @author Volkan Kumtepeli
+ * @author Becky Perriment
+ * @date 17 Oct 2026
+ */
+
+#pragma once
+
+namespace dtwc {
+
+enum class DtwKernel {
+  Auto,      //<! Picks the fastest kernel from the sizes (wavefront, batch or banded).
+  Banded,    //<! dtwBanded, row-by-row recurrence.
+  Wavefront, //<! dtwWavefront, anti-diagonal SIMD recurrence.
+  Pruned,    //<! dtwPruned, skips cells more expensive than an upper bound.
+  Fast,      //<! dtwFast, approximate multiscale DTW (FastDTW) for full DTW (band < 0).
+  Quantised  //<! dtwBatchQuantised, approximate DTW of int16-quantised data with int32 costs (L1 cost).
+};
+
+}
@@ -0,0 +1,18 @@
+/**
+ * @file MultivariateMode.hpp
+ * @brief MultivariateMode enum for selecting how channels of multivariate series are warped.
+ * @author Volkan Kumtepeli
+ * @author Becky Perriment
+ * @date 17 Oct 2026
+ */
+
+#pragma once
+
+namespace dtwc {
+
+enum class MultivariateMode {
+  Dependent,  //<! DTW_D: all channels share one warping path (dtwDependent).
+  Independent //<! DTW_I: every channel has its own warping path; distances are summed (dtwIndependent).
+};
+
+}
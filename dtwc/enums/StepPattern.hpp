@@ -0,0 +1,18 @@
+/**
+ * @file StepPattern.hpp
+ * @brief StepPattern enum for local constraints of warping paths.
+ * @author Volkan Kumtepeli
+ * @author Becky Perriment
+ * @date 17 Oct 2026
+ */
+
+#pragma once
+
+namespace dtwc {
+
+enum class StepPattern {
+  Symmetric1, //<! Steps (0, 1), (1, 1), (1, 0) with unit weights; the classical DTW.
+  SymmetricP1 //<! Sakoe-Chiba symmetric pattern with slope constraint P = 1.
+};
+
+}
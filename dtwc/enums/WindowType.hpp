@@ -0,0 +1,18 @@
+/**
+ * @file WindowType.hpp
+ * @brief WindowType enum for global constraints of warping paths.
+ * @author Volkan Kumtepeli
+ * @author Becky Perriment
+ * @date 17 Oct 2026
+ */
+
+#pragma once
+
+namespace dtwc {
+
+enum class WindowType {
+  SakoeChiba, //<! Band around the diagonal, see Problem::band.
+  Itakura     //<! Itakura parallelogram, see Problem::itakura_slope.
+};
+
+}
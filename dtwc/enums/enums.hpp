@@ -3,7 +3,7 @@
  * @brief Include all enums
  *
  * @details This header file is used to include all the necessary enums used throughout
- * the project. It includes various enum classes like Method, Solver.
+ * the project. It includes various enum classes like Method, Solver, DtwKernel, DtwCost, StepPattern, WindowType, MultivariateMode.
  *
  * @date 11 Dec 2023
  * @author Volkan Kumtepeli
@@ -12,5 +12,10 @@
 
 #pragma once
 
-#include "Method.hpp" ///< Include the Method enum definitions.
-#include "Solver.hpp" ///< Include the Solver enum definitions.
+#include "Method.hpp"           ///< Include the Method enum definitions.
+#include "Solver.hpp"           ///< Include the Solver enum definitions.
+#include "DtwKernel.hpp"        ///< Include the DtwKernel enum definitions.
+#include "DtwCost.hpp"          ///< Include the DtwCost enum definitions.
+#include "StepPattern.hpp"      ///< Include the StepPattern enum definitions.
+#include "WindowType.hpp"       ///< Include the WindowType enum definitions.
+#include "MultivariateMode.hpp" ///< Include the MultivariateMode enum definitions.
@@ -7,6 +7,7 @@
  * read data into vectors or Armadillo matrices, and save matrices to files.
  * It provides the functionality to ignore Byte Order Marks (BOM) in text files,
  * read specific rows and columns from files, and handle data from directories or batch files.
+ * Distance matrices are written and read as CSV or in the binary format of types/DistanceFile.hpp.
  *
  * @date 21 Jan 2022
  * @author Volkan Kumtepeli
@@ -15,9 +16,13 @@
 
 #pragma once
 
-#include "settings.hpp" // for resultsPath
+#include "settings.hpp"              // for resultsPath
+#include "types/DistanceMatrix.hpp" // for DistanceMatrix
+#include "types/DistanceFile.hpp"   // for DistanceFileHeader, MatrixLayout
 
+#include <algorithm>  // for copy, min
 #include <cassert>    // for assert
+#include <cstdint>    // for uint64_t, int64_t
 #include <chrono>     // for filesystem
 #include <cstdlib>    // for size_t
 #include <filesystem> // for operator<<, path, operator/, directory_iterator
@@ -29,6 +34,7 @@
 #include <string>
 #include <sstream>
 #include <stdexcept> // for std::runtime_error
+#include <limits>    // for numeric_limits
 
 #include <armadillo>
 
@@ -64,10 +70,12 @@ inline void ignoreBOM(std::istream &in)
  * @param start_row Starting row index for reading the data (default is 0).
  * @param start_col Starting column index for reading the data (default is 0).
  * @param delimiter Delimiter character used in the file (default is ',').
+ * @param ndim Number of columns (channels) to read from start_col on; rows are stored channel-interleaved.
  * @return std::vector<data_t> A vector containing the read data.
+ * @throws std::runtime_error if a row has fewer than ndim columns after start_col.
  */
 template <typename data_t>
-auto readFile(const fs::path &name, int start_row = 0, int start_col = 0, char delimiter = ',')
+auto readFile(const fs::path &name, int start_row = 0, int start_col = 0, char delimiter = ',', int ndim = 1)
 {
   std::ifstream in(name, std::ios_base::in);
   if (!in.good()) // check if we could open the file
@@ -91,6 +99,7 @@ auto readFile(const fs::path &name, int start_row = 0, int start_col = 0, char d
   p.reserve(10000);
 
   while (std::getline(in, line)) {
+    if (line.find_first_not_of(" \t\r") == std::string::npos) continue; // Skip empty lines.
     std::istringstream iss(line);
 
     for (int i = 0; i < start_col; i++) // Skip first start_col columns to start from start_col.
@@ -100,8 +109,14 @@ auto readFile(const fs::path &name, int start_row = 0, int start_col = 0, char d
         iss >> c;
     }
 
-    iss >> p_i; // Finally we got it!  % #TODO does not work for many-column arrays.
-    p.push_back(p_i);
+    for (int i = 0; i < ndim; i++) { // Channels of a row are stored next to each other.
+      if (!(iss >> p_i))
+        throw std::runtime_error("Error in readFile. A row of file " + name.string() + " has fewer than " + std::to_string(ndim) + " columns.\n");
+
+      p.push_back(p_i);
+      if (delimiter != ' ' && delimiter != '\t') // These we do not need to remove from stream.
+        iss >> c;
+    }
   }
 
   p.shrink_to_fit();
@@ -119,10 +134,11 @@ auto readFile(const fs::path &name, int start_row = 0, int start_col = 0, char d
  * @param start_row Starting row index for reading the data (default is 0).
  * @param start_col Starting column index for reading the data (default is 0).
  * @param delimiter Delimiter character used in the files (default is ',').
+ * @param ndim Number of columns (channels) to read from each file (default is 1), see readFile.
  * @return std::pair<std::vector<std::vector<data_t>>, std::vector<std::string>> A pair containing vectors of data and corresponding file names.
  */
 template <typename data_t, typename Tpath>
-auto load_folder(Tpath &folder_path, int Ndata = -1, int verbose = 1, int start_row = 0, int start_col = 0, char delimiter = ',')
+auto load_folder(Tpath &folder_path, int Ndata = -1, int verbose = 1, int start_row = 0, int start_col = 0, char delimiter = ',', int ndim = 1)
 {
   std::cout << "Reading data:" << std::endl;
 
@@ -132,7 +148,7 @@ auto load_folder(Tpath &folder_path, int Ndata = -1, int verbose = 1, int start_
   int i_data = 0;
   for (const auto &entry : fs::directory_iterator(folder_path)) {
 
-    auto p = readFile<data_t>(entry.path(), start_row, start_col, delimiter);
+    auto p = readFile<data_t>(entry.path(), start_row, start_col, delimiter, ndim);
 
     if (verbose >= 2 || (verbose == 1 && p.empty()))
       std::cout << entry.path() << "\tSize: " << p.size() << '\n';
@@ -159,10 +175,12 @@ auto load_folder(Tpath &folder_path, int Ndata = -1, int verbose = 1, int start_
  * @param start_row Starting row index for reading the data (default is 0).
  * @param start_col Starting column index for reading the data (default is 0).
  * @param delimiter Delimiter character used in the file (default is ',').
+ * @param ndim Number of channels (default is 1); each row holds one channel-interleaved series (t0c0, t0c1, ..., t1c0, ...).
  * @return std::pair<std::vector<std::vector<data_t>>, std::vectorstd::string> A pair containing vectors of data and corresponding identifiers.
+ * @throws std::runtime_error if the number of values of a row is not a multiple of ndim.
  */
 template <typename data_t>
-auto load_batch_file(fs::path &file_path, int Ndata = -1, int verbose = 1, int start_row = 0, int start_col = 0, char delimiter = ',')
+auto load_batch_file(fs::path &file_path, int Ndata = -1, int verbose = 1, int start_row = 0, int start_col = 0, char delimiter = ',', int ndim = 1)
 {
   std::cout << "Reading data:" << std::endl;
 
@@ -208,6 +226,9 @@ auto load_batch_file(fs::path &file_path, int Ndata = -1, int verbose = 1, int s
 
     p.shrink_to_fit();
 
+    if (p.size() % ndim != 0)
+      throw std::runtime_error("Error in load_batch_file. Row " + std::to_string(n_rows) + " of file " + file_path.string() + " has " + std::to_string(p.size()) + " values, which is not a multiple of " + std::to_string(ndim) + " channels.\n");
+
     if (verbose >= 2 || (verbose == 1 && p.empty()))
       std::cout << file_path << '\t' << "data: " << n_rows << " Size: " << p.size() << '\n';
 
@@ -244,4 +265,184 @@ void readMatrix(arma::Mat<data_t> &matrix, const fs::path &name)
   matrix.load(name.string(), arma::csv_ascii);
 }
 
+/**
+ * @brief Writes a distance matrix to a file in CSV format as a full N x N matrix.
+ * @details Rows are written one at a time, so no dense copy of the matrix is made.
+ * @tparam data_t The data type of the elements in the matrix.
+ * @param matrix The distance matrix to be written to file.
+ * @param path Path of the file where the matrix will be saved.
+ */
+template <typename data_t>
+void writeMatrix(const DistanceMatrix<data_t> &matrix, const fs::path &path)
+{
+  std::ofstream out(path, std::ios_base::out);
+  out.precision(std::numeric_limits<data_t>::max_digits10);
+
+  std::vector<data_t> row;
+  for (size_t i = 0; i < matrix.size(); i++) {
+    matrix.row(i, row);
+    for (size_t j = 0; j < row.size(); j++)
+      out << (j ? "," : "") << row[j];
+    out << '\n';
+  }
+}
+
+/**
+ * @brief Reads a CSV file of a symmetric matrix into a distance matrix; only the upper triangle is used.
+ * @tparam data_t The data type of the elements in the matrix.
+ * @param matrix Reference to a distance matrix where the data will be loaded.
+ * @param name Path of the CSV file to read.
+ * @throws std::runtime_error if the matrix in the file is not square.
+ */
+template <typename data_t>
+void readMatrix(DistanceMatrix<data_t> &matrix, const fs::path &name)
+{
+  arma::Mat<data_t> dense;
+  readMatrix(dense, name);
+  matrix = DistanceMatrix<data_t>(dense);
+}
+
+/**
+ * @brief Reads the header of a binary distance matrix file.
+ * @param path Path of the file.
+ * @return The header; it is not valid (see DistanceFileHeader::isValid) if the file is not a binary distance matrix file.
+ */
+inline DistanceFileHeader readMatrixHeader(const fs::path &path)
+{
+  DistanceFileHeader header;
+  std::ifstream in(path, std::ios_base::in | std::ios_base::binary);
+  if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)))
+    header = DistanceFileHeader{}; // Not sealed, so not valid.
+
+  return header;
+}
+
+namespace detail {
+  template <typename data_t>
+  void writeBinary(const fs::path &path, DistanceFileHeader header, const data_t *entries)
+  {
+    if (!isLittleEndian())
+      throw std::runtime_error("Error in writeBinaryMatrix. Distance matrix files are little-endian, which this machine is not.\n");
+
+    header.element_bytes = sizeof(data_t);
+    header.seal();
+
+    std::ofstream out(path, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(entries), header.entryBytes());
+    if (!out)
+      throw std::runtime_error("Error in writeBinaryMatrix. File " + path.string() + " could not be written.\n");
+  }
+} // namespace detail
+
+/**
+ * @brief Writes a distance matrix to a binary file with packed layout (see types/DistanceFile.hpp).
+ * @details The entries are written as they are stored, at once, so the file can be read without parsing
+ * and memory-mapped without copying (see DistanceCache::open).
+ * @tparam data_t The data type of the elements in the matrix.
+ * @param matrix The distance matrix to be written to file.
+ * @param path Path of the file where the matrix will be saved.
+ * @param band Band the distances were computed with, -1 for full DTW.
+ * @param data_hash Data::hash of the data the distances were computed for, 0 if unknown.
+ * @param config Problem::distanceConfig of the other settings of the distances, 0 if unknown.
+ * @throws std::runtime_error if the file cannot be written or the machine is not little-endian.
+ */
+template <typename data_t>
+void writeBinaryMatrix(const DistanceMatrix<data_t> &matrix, const fs::path &path, int64_t band = -1, uint64_t data_hash = 0, uint32_t config = 0)
+{
+  DistanceFileHeader header;
+  header.N = matrix.size();
+  header.band = band;
+  header.data_hash = data_hash;
+  header.config = config;
+  header.layout = static_cast<uint32_t>(MatrixLayout::Packed);
+  header.tile = DistanceMatrix<data_t>::tile;
+  detail::writeBinary(path, header, matrix.data());
+}
+
+/**
+ * @brief Writes a square Armadillo matrix to a binary file with dense layout (column by column).
+ * @throws std::runtime_error if the matrix is not square, the file cannot be written or the machine is not little-endian.
+ * @see writeBinaryMatrix(const DistanceMatrix<data_t> &, const fs::path &, int64_t, uint64_t, uint32_t)
+ */
+template <typename data_t>
+void writeBinaryMatrix(const arma::Mat<data_t> &matrix, const fs::path &path, int64_t band = -1, uint64_t data_hash = 0, uint32_t config = 0)
+{
+  if (matrix.n_rows != matrix.n_cols)
+    throw std::runtime_error("Error in writeBinaryMatrix. Matrix of size " + std::to_string(matrix.n_rows) + " x " + std::to_string(matrix.n_cols) + " is not square.\n");
+
+  DistanceFileHeader header;
+  header.N = matrix.n_rows;
+  header.band = band;
+  header.data_hash = data_hash;
+  header.config = config;
+  header.layout = static_cast<uint32_t>(MatrixLayout::Dense);
+  detail::writeBinary(path, header, matrix.memptr());
+}
+
+/**
+ * @brief Reads a binary distance matrix file (see types/DistanceFile.hpp) into a distance matrix.
+ * @details A packed file of data_t is read at once into the storage of the matrix. Entries of the other
+ * floating-point type are converted, and only the upper triangle of dense files is used.
+ * @tparam data_t The data type of the elements in the matrix.
+ * @param matrix Reference to a distance matrix where the data will be loaded.
+ * @param path Path of the binary file to read.
+ * @return The header of the file, e.g., to check its band and data hash.
+ * @throws std::runtime_error if the file is not a valid, complete binary distance matrix file.
+ */
+template <typename data_t>
+DistanceFileHeader readBinaryMatrix(DistanceMatrix<data_t> &matrix, const fs::path &path)
+{
+  const auto header = readMatrixHeader(path);
+  const bool is_packed = header.layout == static_cast<uint32_t>(MatrixLayout::Packed);
+  if (!header.isValid() || (header.element_bytes != sizeof(float) && header.element_bytes != sizeof(double))
+      || (is_packed && header.tile != DistanceMatrix<data_t>::tile) || (!is_packed && header.layout != static_cast<uint32_t>(MatrixLayout::Dense))
+      || (header.flags & DistanceFileHeader::has_tile_records)) // Shards are merged with mergeShards.
+    throw std::runtime_error("Error in readBinaryMatrix. File " + path.string() + " is not a binary distance matrix file of this version.\n");
+
+  if (!isLittleEndian())
+    throw std::runtime_error("Error in readBinaryMatrix. Distance matrix files are little-endian, which this machine is not.\n");
+
+  std::ifstream in(path, std::ios_base::in | std::ios_base::binary);
+  in.seekg(sizeof(header));
+
+  auto read = [&](data_t *out, size_t count) { // Converts from the type of the file.
+    if (header.element_bytes == sizeof(data_t)) {
+      in.read(reinterpret_cast<char *>(out), count * sizeof(data_t));
+      return;
+    }
+
+    constexpr size_t chunk = 1 << 16;
+    auto convert = [&](auto value) {
+      std::vector<decltype(value)> buffer(std::min(count, chunk));
+      for (size_t first = 0; first < count && in; first += chunk) {
+        const size_t n = std::min(chunk, count - first);
+        in.read(reinterpret_cast<char *>(buffer.data()), n * sizeof(value));
+        std::copy(buffer.begin(), buffer.begin() + n, out + first);
+      }
+    };
+    if (header.element_bytes == sizeof(float))
+      convert(float{});
+    else
+      convert(double{});
+  };
+
+  matrix.resize(header.N);
+  if (is_packed)
+    read(matrix.data(), matrix.entries());
+  else {
+    std::vector<data_t> column(header.N);
+    for (size_t j = 0; j < header.N && in; j++) {
+      read(column.data(), header.N);
+      for (size_t i = 0; i <= j; i++)
+        matrix(i, j) = column[i];
+    }
+  }
+
+  if (!in)
+    throw std::runtime_error("Error in readBinaryMatrix. File " + path.string() + " is truncated.\n");
+
+  return header;
+}
+
 } // namespace dtwc
\ No newline at end of file
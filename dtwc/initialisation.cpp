@@ -98,9 +98,11 @@ void Kmeanspp(Problem &prob)
   candidate_centroids.push_back(d(randGenerator));
 
   std::vector<data_t> distances(prob.size(), std::numeric_limits<data_t>::max());
+  prob.data.updateEnvelopes(prob.band); // For lower bounds in distByInd.
+  if (prob.isQuantisedDTW()) prob.data.updateQuantised();
 
   auto distTask = [&](int i_p) {
-    distances[i_p] = std::min(distances[i_p], prob.distByInd(candidate_centroids.back(), i_p));
+    distances[i_p] = std::min(distances[i_p], prob.distByInd(candidate_centroids.back(), i_p, distances[i_p]));
   };
 
   for (int i = 1; i < Nc; i++) {
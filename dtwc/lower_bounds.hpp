@@ -0,0 +1,265 @@
+/**
+ * @file lower_bounds.hpp
+ * @brief Lower bounds of the dynamic time warping distance.
+ *
+ * @details Lower bounds are cheap to compute (O(n) instead of O(n * band)), so candidates
+ * that cannot beat the best distance so far can be discarded before running DTW. This file
+ * contains LB_Kim, LB_Keogh and LB_Improved, per-series envelopes and a cascade which tries
+ * them in increasing order of cost before falling back to early-abandoning DTW.
+ *
+ * References:
+ * - E. Keogh and C. A. Ratanamahatana, "Exact indexing of dynamic time warping".
+ *   Knowledge and Information Systems, 7(3), 358-386 (2005).
+ * - D. Lemire, "Faster retrieval with a two-pass dynamic-time-warping lower bound".
+ *   Pattern Recognition, 42(9), 2169-2180 (2009).
+ * - T. Rakthanmanon et al., "Searching and mining trillions of time series subsequences
+ *   under dynamic time warping". KDD (2012).
+ *
+ * LB_Keogh and LB_Improved need sequences of the same length; for other pairs only LB_Kim is used.
+ * The bounds hold for costs of the form |x - y|^p with p >= 1, e.g., cost::L1 and cost::SquaredL2.
+ *
+ * @date 17 Oct 2026
+ * @author Volkan Kumtepeli
+ * @author Becky Perriment
+ */
+
+#pragma once
+
+#include "warping.hpp" // for dtwBanded, DtwResult, DtwWorkspace
+#include "costs.hpp"   // for cost::L1
+
+#include <cstddef>   // for size_t
+#include <algorithm> // for max
+#include <cmath>     // for abs
+#include <limits>    // for numeric_limits
+#include <vector>    // for vector
+
+namespace dtwc {
+
+/**
+ * @brief Upper and lower envelopes of a sequence for a given band.
+ *
+ * @details upper[i] and lower[i] are the maximum and minimum of x[i - band, i + band].
+ */
+template <typename data_t>
+struct Envelope
+{
+  std::vector<data_t> upper; //!< Running maximum.
+  std::vector<data_t> lower; //!< Running minimum.
+
+  auto size() const { return upper.size(); }
+  bool empty() const { return upper.empty(); }
+};
+
+/**
+ * @brief Computes the envelope of a sequence in O(n) with Lemire's streaming min/max algorithm,
+ * into given buffers, which are not reallocated once large enough.
+ *
+ * @param x Sequence.
+ * @param band Half-width of the window; negative values mean the whole sequence (full DTW).
+ * @param upper Running maximum, resized to the length of x.
+ * @param lower Running minimum, resized to the length of x.
+ * @param max_ind Scratch memory for the candidates of the maximum, resized to the length of x.
+ * @param min_ind Scratch memory for the candidates of the minimum, resized to the length of x.
+ */
+template <typename data_t>
+void envelope(const std::vector<data_t> &x, int band, std::vector<data_t> &upper, std::vector<data_t> &lower,
+              std::vector<int> &max_ind, std::vector<int> &min_ind)
+{
+  const int n = x.size();
+  const int r = (band < 0) ? n : band;
+
+  upper.resize(n);
+  lower.resize(n);
+  max_ind.resize(n); // Each index is queued once, so the queues fit in n elements.
+  min_ind.resize(n);
+
+  // Queues [front, back) of indices of candidates in decreasing/increasing order of values:
+  int max_front = 0, max_back = 0, min_front = 0, min_back = 0;
+  for (int i = 0; i < n + r; i++) {
+    if (i < n) {
+      while (max_back > max_front && x[max_ind[max_back - 1]] <= x[i]) max_back--;
+      while (min_back > min_front && x[min_ind[min_back - 1]] >= x[i]) min_back--;
+      max_ind[max_back++] = i;
+      min_ind[min_back++] = i;
+    }
+
+    const int centre = i - r; // Window [centre - r, centre + r] is complete.
+    if (centre < 0) continue;
+
+    while (max_ind[max_front] < centre - r) max_front++;
+    while (min_ind[min_front] < centre - r) min_front++;
+    upper[centre] = x[max_ind[max_front]];
+    lower[centre] = x[min_ind[min_front]];
+  }
+}
+
+/**
+ * @brief Computes the envelope of a sequence into out, reusing its memory, see above.
+ * @param workspace Scratch memory for the candidates, see DtwWorkspace.
+ */
+template <typename data_t>
+void envelope(const std::vector<data_t> &x, int band, Envelope<data_t> &out, DtwWorkspace<data_t> &workspace)
+{
+  envelope(x, band, out.upper, out.lower, workspace.lo, workspace.hi);
+}
+
+/**
+ * @brief Computes the envelope of a sequence, see above.
+ * @return The envelope of x.
+ */
+template <typename data_t>
+Envelope<data_t> envelope(const std::vector<data_t> &x, int band)
+{
+  Envelope<data_t> env;
+  std::vector<int> max_ind, min_ind;
+  envelope(x, band, env.upper, env.lower, max_ind, min_ind);
+  return env;
+}
+
+/**
+ * @brief LB_Kim lower bound: every warping path matches the first and the last elements.
+ * @details O(1). Valid for any lengths and any band.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+data_t lbKim(const std::vector<data_t> &x, const std::vector<data_t> &y)
+{
+  if (x.empty() || y.empty()) return 0;
+
+  const Tcost distance{};
+  const auto first = distance(x.front(), y.front());
+  if (x.size() == 1 && y.size() == 1) return first; // First and last cells are the same.
+
+  return first + distance(x.back(), y.back());
+}
+
+/**
+ * @brief LB_Keogh lower bound: distance of x to the envelope of y.
+ *
+ * @details O(n). Requires x and y to be of the same length and env_y to be computed with the same
+ * band as the DTW. The sum is abandoned once it exceeds best_so_far.
+ *
+ * @param x First sequence.
+ * @param env_y Envelope of the second sequence.
+ * @param best_so_far Upper bound of interest.
+ * @return The lower bound (or a partial sum larger than best_so_far).
+ */
+template <typename data_t, typename Tcost = cost::L1>
+data_t lbKeogh(const std::vector<data_t> &x, const std::vector<data_t> &upper, const std::vector<data_t> &lower,
+               data_t best_so_far = std::numeric_limits<data_t>::max())
+{
+  const Tcost distance{};
+  data_t sum{ 0 };
+  for (size_t i = 0; i < x.size() && sum <= best_so_far; i++) {
+    if (x[i] > upper[i])
+      sum += distance(x[i], upper[i]);
+    else if (x[i] < lower[i])
+      sum += distance(x[i], lower[i]);
+  }
+
+  return sum;
+}
+
+/**
+ * @brief LB_Keogh lower bound with the upper and lower envelopes of y, see above.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+data_t lbKeogh(const std::vector<data_t> &x, const Envelope<data_t> &env_y,
+               data_t best_so_far = std::numeric_limits<data_t>::max())
+{
+  return lbKeogh<data_t, Tcost>(x, env_y.upper, env_y.lower, best_so_far);
+}
+
+/**
+ * @brief LB_Improved lower bound (Lemire, 2009). Tighter than LB_Keogh, about twice the cost.
+ *
+ * @details LB_Keogh(x, env_y) plus LB_Keogh(y, envelope of the projection of x onto env_y).
+ * Requires x and y to be of the same length.
+ *
+ * @param x First sequence.
+ * @param y Second sequence.
+ * @param env_y Envelope of y.
+ * @param band Band used for env_y and the DTW.
+ * @param best_so_far Upper bound of interest.
+ * @param workspace Scratch memory for the projection and its envelope, see DtwWorkspace.
+ * @return The lower bound (or a partial sum larger than best_so_far).
+ */
+template <typename data_t, typename Tcost = cost::L1>
+data_t lbImproved(const std::vector<data_t> &x, const std::vector<data_t> &y, const Envelope<data_t> &env_y,
+                  int band, data_t best_so_far, DtwWorkspace<data_t> &workspace)
+{
+  const auto lb_keogh = lbKeogh<data_t, Tcost>(x, env_y, best_so_far);
+  if (lb_keogh > best_so_far) return lb_keogh;
+
+  auto &projection = workspace.series;
+  projection.resize(x.size());
+  for (size_t i = 0; i < x.size(); i++)
+    projection[i] = std::max(env_y.lower[i], std::min(x[i], env_y.upper[i]));
+
+  auto &upper = workspace.upper, &lower = workspace.lower;
+  envelope(projection, band, upper, lower, workspace.lo, workspace.hi);
+  return lb_keogh + lbKeogh<data_t, Tcost>(y, upper, lower, best_so_far - lb_keogh);
+}
+
+/**
+ * @brief LB_Improved lower bound (Lemire, 2009), see above.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+data_t lbImproved(const std::vector<data_t> &x, const std::vector<data_t> &y, const Envelope<data_t> &env_y,
+                  int band, data_t best_so_far = std::numeric_limits<data_t>::max())
+{
+  return lbImproved<data_t, Tcost>(x, y, env_y, band, best_so_far, threadWorkspace<data_t>());
+}
+
+/**
+ * @brief Lower-bound cascade followed by early-abandoning DTW.
+ *
+ * @details LB_Kim, LB_Keogh in both directions and LB_Improved are tried in increasing order
+ * of cost; the banded DTW is only computed if none of them exceeds best_so_far.
+ *
+ * @param x First sequence.
+ * @param y Second sequence.
+ * @param env_x Envelope of x for band (may be empty; then only LB_Kim is used).
+ * @param env_y Envelope of y for band (may be empty; then only LB_Kim is used).
+ * @param band The bandwidth parameter, -1 for full DTW.
+ * @param best_so_far Upper bound of interest.
+ * @param workspace Scratch memory, see DtwWorkspace.
+ * @return The exact distance, or a lower bound larger than best_so_far with is_exact = false.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+DtwResult<data_t> dtwCascade(const std::vector<data_t> &x, const std::vector<data_t> &y,
+                             const Envelope<data_t> &env_x, const Envelope<data_t> &env_y,
+                             int band, data_t best_so_far, DtwWorkspace<data_t> &workspace)
+{
+  if (&x == &y) return { 0, true };
+
+  auto lb = lbKim<data_t, Tcost>(x, y);
+  if (lb > best_so_far) return { lb, false };
+
+  const bool same_length = (x.size() == y.size()) && (env_x.size() == x.size()) && (env_y.size() == y.size());
+  if (same_length) {
+    lb = std::max(lb, lbKeogh<data_t, Tcost>(x, env_y, best_so_far));
+    if (lb > best_so_far) return { lb, false };
+
+    lb = std::max(lb, lbKeogh<data_t, Tcost>(y, env_x, best_so_far));
+    if (lb > best_so_far) return { lb, false };
+
+    lb = std::max(lb, lbImproved<data_t, Tcost>(x, y, env_y, band, best_so_far, workspace));
+    if (lb > best_so_far) return { lb, false };
+  }
+
+  return dtwBanded<data_t, Tcost>(x, y, band, best_so_far, workspace);
+}
+
+/**
+ * @brief Lower-bound cascade followed by early-abandoning DTW, see above.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+DtwResult<data_t> dtwCascade(const std::vector<data_t> &x, const std::vector<data_t> &y,
+                             const Envelope<data_t> &env_x, const Envelope<data_t> &env_y,
+                             int band, data_t best_so_far)
+{
+  return dtwCascade<data_t, Tcost>(x, y, env_x, env_y, band, best_so_far, threadWorkspace<data_t>());
+}
+
+} // namespace dtwc
@@ -17,6 +17,9 @@
 #include "types/Range.hpp"
 
 #include <cstddef>
+#include <algorithm> // for min, max, stable_sort
+#include <cmath>     // for sqrt
+#include <vector>    // for vector
 #include <omp.h>
 
 namespace dtwc {
@@ -62,4 +65,149 @@ void run(Tfun &task_indv, size_t i_end, size_t numMaxParallelWorkers = 32)
 {
   run_openmp(task_indv, i_end, numMaxParallelWorkers != 1);
 }
+
+/**
+ * @brief Runs tasks 0, ..., i_end - 1 in a fixed number of groups, one group per parallel task.
+ *
+ * @details Group g runs tasks g, g + groups, g + 2 * groups, ... in this order, whatever the
+ * scheduling of the groups. A group may thus accumulate into its own partial results, which are
+ * then combined in group order, so that the results do not depend on the scheduling (e.g., sums
+ * over the tile rows of a DistanceMatrix, which get shorter row by row, with one group per thread).
+ *
+ * @tparam Tfun The type of the task function, called as task(group, i).
+ * @param task Reference to the task function to be executed.
+ * @param i_end The upper bound of the task index.
+ * @param groups Number of groups.
+ * @param numMaxParallelWorkers The maximum number of parallel workers (default is 32).
+ */
+template <typename Tfun>
+void runGrouped(Tfun &task, size_t i_end, size_t groups, size_t numMaxParallelWorkers = 32)
+{
+  auto groupTask = [&](int g) {
+    for (size_t i = g; i < i_end; i += groups)
+      task(g, i);
+  };
+
+  run(groupTask, groups, numMaxParallelWorkers);
+}
+
+/**
+ * @brief A square tile of the upper triangle of N x N pairs: pairs (i, j) with i <= j,
+ * i in [i_begin, i_end) and j in [j_begin, j_end).
+ */
+struct Tile
+{
+  int i_begin{ 0 }, i_end{ 0 }; //!< Rows of the tile.
+  int j_begin{ 0 }, j_end{ 0 }; //!< Columns of the tile.
+  double cost{ 0 };             //!< Estimated cost: sum of weight[i] * weight[j] over the pairs.
+};
+
+namespace detail {
+/**
+ * @brief Square tiles of the upper triangle (i <= j) of N x N pairs, tile row by tile row; see upperTriangleTiles.
+ */
+inline std::vector<Tile> triangleTiles(const std::vector<double> &weight, int tile_size)
+{
+  const int N = weight.size(), T = std::max(tile_size, 1);
+
+  std::vector<double> sum(N + 1, 0), sum_sq(N + 1, 0); // Prefix sums of weights and their squares.
+  for (int i = 0; i < N; i++) {
+    sum[i + 1] = sum[i] + weight[i];
+    sum_sq[i + 1] = sum_sq[i] + weight[i] * weight[i];
+  }
+
+  std::vector<Tile> tiles;
+  for (int i = 0; i < N; i += T)
+    for (int j = i; j < N; j += T) {
+      Tile tile{ i, std::min(i + T, N), j, std::min(j + T, N) };
+      const double rows = sum[tile.i_end] - sum[i], cols = sum[tile.j_end] - sum[j];
+      tile.cost = (i == j) ? (rows * rows + sum_sq[tile.i_end] - sum_sq[i]) / 2 : rows * cols; // Diagonal tiles only have i <= j.
+      tiles.push_back(tile);
+    }
+
+  return tiles;
+}
+
+inline void sortByCost(std::vector<Tile> &tiles)
+{
+  std::stable_sort(tiles.begin(), tiles.end(), [](const Tile &a, const Tile &b) { return a.cost > b.cost; });
+}
+} // namespace detail
+
+/**
+ * @brief Divides the upper triangle (i <= j) of N x N pairs into square tiles, most costly first.
+ *
+ * @param weight Weights of the N items (e.g., lengths of series); the cost of pair (i, j) is weight[i] * weight[j].
+ * @param tile_size Side of the tiles; tiles at the end of rows and columns may be smaller.
+ * @return Tiles covering each pair (i, j) with i <= j exactly once, sorted by decreasing cost.
+ */
+inline std::vector<Tile> upperTriangleTiles(const std::vector<double> &weight, int tile_size)
+{
+  auto tiles = detail::triangleTiles(weight, tile_size);
+  detail::sortByCost(tiles);
+  return tiles;
+}
+
+/**
+ * @brief Shard of the tiles of the upper triangle, e.g., for one of several processes or machines.
+ *
+ * @details The tiles, numbered tile row by tile row (as in DistanceMatrix for tile_size = DistanceMatrix::tile),
+ * are dealt round-robin: shard k gets tiles t with t % shard_count == k. The shards only depend on N
+ * and tile_size, and together cover each pair exactly once.
+ *
+ * @param weight Weights of the N items, see upperTriangleTiles.
+ * @param tile_size Side of the tiles.
+ * @param shard Index of the shard, in [0, shard_count).
+ * @param shard_count Number of shards.
+ * @return Tiles of the shard, sorted by decreasing cost.
+ */
+inline std::vector<Tile> shardTiles(const std::vector<double> &weight, int tile_size, int shard, int shard_count)
+{
+  auto all = detail::triangleTiles(weight, tile_size);
+  std::vector<Tile> tiles;
+  for (size_t t = shard; t < all.size(); t += shard_count)
+    tiles.push_back(all[t]);
+
+  detail::sortByCost(tiles);
+  return tiles;
+}
+
+/**
+ * @brief Side of square tiles whose row and column items (2 * tile side) of item_bytes each fit in cache_bytes.
+ * @details The side is reduced so that there are at least about four tiles per thread for load balancing.
+ * @param N Number of items.
+ * @param item_bytes Average memory of an item (e.g., of a series).
+ * @param cache_bytes Memory the items of a tile may take.
+ */
+inline int tileSize(size_t N, double item_bytes, size_t cache_bytes = settings::TILE_CACHE_BYTES)
+{
+  const int fits = std::max(1.0, cache_bytes / (2 * std::max(item_bytes, 1.0)));
+  const int balanced = std::max(1.0, N / std::sqrt(8.0 * omp_get_max_threads())); // N^2 / (2 * side^2) >= 4 * threads.
+  return std::min(fits, balanced);
+}
+
+/**
+ * @brief Runs a task for every pair (i, j), i <= j, of the given tiles, one tile per parallel task.
+ *
+ * @details Tiles are dispatched dynamically in the given order, so tiles sorted by decreasing cost
+ * (see upperTriangleTiles) are run biggest-first. Within a tile, pairs are visited row by row, so
+ * that the items of the tile stay in cache.
+ *
+ * @tparam Tfun The type of the task function, called as task_pair(i, j).
+ * @param task_pair Reference to the task function to be executed.
+ * @param tiles Tiles of pairs.
+ * @param numMaxParallelWorkers The maximum number of parallel workers (default is 32).
+ */
+template <typename Tfun>
+void runTiles(Tfun &task_pair, const std::vector<Tile> &tiles, size_t numMaxParallelWorkers = 32)
+{
+  auto oneTileTask = [&](int t) {
+    const auto &tile = tiles[t];
+    for (int i = tile.i_begin; i < tile.i_end; i++)
+      for (int j = std::max(tile.j_begin, i); j < tile.j_end; j++)
+        task_pair(i, j);
+  };
+
+  run(oneTileTask, tiles.size(), numMaxParallelWorkers);
+}
 } // namespace dtwc
\ No newline at end of file
@@ -20,6 +20,9 @@
 #include <vector>
 #include <cstddef>
 #include <utility> // for pair
+#include <stdexcept> // for runtime_error
+#include <algorithm> // for max
+#include <omp.h>     // for omp_get_max_threads
 
 namespace dtwc::scores {
 
@@ -29,11 +32,14 @@ namespace dtwc::scores {
  * The silhouette score is a measure of how similar an object is to its own cluster (cohesion)
  * compared to other clusters (separation). The score ranges from -1 to 1, where a high value
  * indicates that the object is well matched to its own cluster and poorly matched to neighboring clusters.
+ * The distances are read in one pass over the distance matrix, tile by tile, so that a memory-mapped
+ * matrix (see Problem::mapDistanceMatrix) is read sequentially.
  *
  * @param prob The clustering problem instance, which contains the data points, cluster indices, and centroids.
  * @return std::vector<double> A vector of silhouette scores for each data point.
  *
  * @note Requires that the data has already been clustered; if not, it will prompt the user to cluster the data first.
+ * @throws std::runtime_error if prob.shard_count > 1, since the whole distance matrix is needed.
  * @see https://en.wikipedia.org/wiki/Silhouette_(clustering) for more information on silhouette scoring.
  */
 std::vector<double> silhouette(Problem &prob)
@@ -48,33 +54,46 @@ std::vector<double> silhouette(Problem &prob)
     return silhouettes;
   }
 
+  if (prob.shard_count > 1) // fillDistanceMatrix would only compute a shard.
+    throw std::runtime_error("silhouette: with shard_count > 1 only a shard of the distance matrix is computed; merge the shards with mergeShards first.\n");
+
   prob.fillDistanceMatrix(); //!< We need all pairwise distance for silhouette score.
 
-  auto oneTask = [&](size_t i_b) {
-    const auto i_c = prob.clusters_ind[i_b];
+  // Sums of distances from each profile to each cluster, in one pass over the matrix tile by tile.
+  // Each group of tile rows (see runGrouped) has its own partial sums, added up in group order:
+  const size_t groups = std::max(omp_get_max_threads(), 1);
+  std::vector<std::vector<double>> partials(groups, std::vector<double>(static_cast<size_t>(Nb) * Nc, 0));
+  std::vector<int> counts(Nc, 0);
+  for (auto i : Range(Nb))
+    counts[prob.clusters_ind[i]]++;
+
+  auto tileRowTask = [&](size_t g, size_t t) {
+    prob.distanceMatrix().forEachPair(t, [&, &partial = partials[g]](size_t i, size_t j, data_t distance) {
+      partial[i * Nc + prob.clusters_ind[j]] += distance;
+      partial[j * Nc + prob.clusters_ind[i]] += distance;
+    });
+  };
 
-    thread_local std::vector<std::pair<int, double>> mean_distances(Nc);
-    mean_distances.assign(Nc, { 0, 0 });
+  dtwc::runGrouped(tileRowTask, prob.distanceMatrix().tileRows(), groups);
 
-    for (auto i : Range(prob.size())) {
-      mean_distances[prob.clusters_ind[i]].first++;
-      mean_distances[prob.clusters_ind[i]].second += prob.distByInd(i, i_b);
-    }
+  auto &sums = partials.front();
+  for (size_t g = 1; g < groups; g++)
+    for (size_t k = 0; k < sums.size(); k++)
+      sums[k] += partials[g][k];
 
+  auto oneTask = [&](size_t i_b) {
+    const auto i_c = prob.clusters_ind[i_b];
 
-    if (mean_distances[i_c].first == 1) // If the profile is the only member of the cluster
+    if (counts[i_c] == 1) // If the profile is the only member of the cluster
       silhouettes[i_b] = 0;
     else {
       auto min = std::numeric_limits<double>::max();
-      for (int i = 0; i < Nc; i++) // Finding means:
-        if (i == i_c)
-          mean_distances[i].second /= (mean_distances[i].first - 1);
-        else {
-          mean_distances[i].second /= mean_distances[i].first;
-          min = std::min(min, mean_distances[i].second);
-        }
-
-      silhouettes[i_b] = (min - mean_distances[i_c].second) / std::max(min, mean_distances[i_c].second);
+      for (int i = 0; i < Nc; i++) // Finding means of other clusters:
+        if (i != i_c && counts[i] != 0)
+          min = std::min(min, sums[i_b * Nc + i] / counts[i]);
+
+      const double own = sums[i_b * Nc + i_c] / (counts[i_c] - 1);
+      silhouettes[i_b] = (min - own) / std::max(min, own);
     }
   };
 
@@ -18,6 +18,7 @@
 
 #include "enums/enums.hpp"
 
+#include <cstddef>
 #include <string>
 #include <filesystem>
 #include <iostream>
@@ -28,7 +29,13 @@ namespace dtwc {
 
 /// @brief Alias for the default data type used throughout the code.
 /// @note The default data type can be either double or float, depending on precision requirements.
+///       Define DTWC_SINGLE_PRECISION (CMake option of the same name) to use float for the data
+///       and the distance matrix, which halves their memory and doubles the SIMD width of the kernels.
+#ifdef DTWC_SINGLE_PRECISION
+using data_t = float;
+#else
 using data_t = double;
+#endif
 
 // Random number settings:
 
@@ -70,6 +77,17 @@ constexpr bool isDebug = false;
 /// @details If no band is required, this value should be set to -1.
 constexpr int DEFAULT_BAND_LENGTH = -1;
 
+/// @brief Minimum length of the shorter sequence for the anti-diagonal (wavefront) DTW kernel.
+/// @details Below this length (or band), the per-diagonal overhead of dtwWavefront dominates.
+constexpr size_t WAVEFRONT_MIN_LENGTH = 32;
+
+/// @brief Minimum band for the anti-diagonal (wavefront) DTW kernel, see WAVEFRONT_MIN_LENGTH.
+constexpr int WAVEFRONT_MIN_BAND = 10;
+
+/// @brief Bytes of series that the row and column series of a tile of pairs may take, see tileSize.
+/// @details About half of a typical per-core L2 cache, leaving room for the DTW rows.
+constexpr size_t TILE_CACHE_BYTES = 512 * 1024;
+
 // Default settings:
 
 /// @brief Default mixed-integer programming solver.
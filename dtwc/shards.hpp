@@ -0,0 +1,99 @@
+/**
+ * @file shards.hpp
+ * @brief Merging of distance matrix shards computed by several processes or machines.
+ *
+ * @details With Problem::shard_count = K, Problem::fillDistanceMatrix only computes the tiles of
+ * shard Problem::shard (see shardTiles) and saves them to Problem::checkpoint_file, which only
+ * holds these tiles (see ShardFile). The K shard files, computed e.g. by jobs of a scheduler
+ * (dtwc_cl --shard k/K), are then merged into one distance matrix file. No communication between
+ * the jobs is needed.
+ *
+ * @date 17 Oct 2026
+ * @author Volkan Kumtepeli
+ * @author Becky Perriment
+ */
+
+#pragma once
+
+#include "fileOperations.hpp"      // for readMatrixHeader, writeBinaryMatrix
+#include "types/DistanceCache.hpp" // for DistanceCache
+#include "types/ShardFile.hpp"     // for ShardFile
+
+#include <cstddef>    // for size_t
+#include <cstdint>    // for uint8_t
+#include <filesystem> // for path
+#include <stdexcept>  // for runtime_error
+#include <string>     // for string, to_string
+#include <vector>     // for vector
+
+namespace dtwc {
+
+/**
+ * @brief Merges shards of a distance matrix into one binary distance matrix file.
+ *
+ * @details The shards must be of the same matrix (size, element type data_t, band, data hash and configuration),
+ * see ShardFile. Tiles found in several shards are taken from the last one. The output is a packed
+ * binary distance matrix (see writeBinaryMatrix) or, if mapped, a file that can be memory-mapped
+ * (see DistanceCache::open and Problem::mapDistanceMatrix), written without holding the matrix in
+ * memory. Both record the band, data hash and configuration of the shards.
+ *
+ * @param shards Paths of the shard files.
+ * @param output Path of the merged distance matrix.
+ * @param mapped Whether to write a memory-mapped file instead of a binary distance matrix.
+ * @return Header of the merged matrix.
+ * @throws std::runtime_error if there are no shards, a shard is not a shard of the same matrix
+ * as the first one, or some tiles are in none of the shards. A mapped output is then removed.
+ */
+template <typename data_t>
+DistanceFileHeader mergeShards(const std::vector<fs::path> &shards, const fs::path &output, bool mapped = false)
+{
+  if (shards.empty()) throw std::runtime_error("mergeShards: no shards to merge.\n");
+
+  const auto first = readMatrixHeader(shards.front());
+  if (!first.isValid() || !(first.flags & DistanceFileHeader::has_tile_records) || first.element_bytes != sizeof(data_t))
+    throw std::runtime_error("mergeShards: " + shards.front().string() + " is not a shard of " + std::to_string(sizeof(data_t)) + "-byte distances.\n");
+
+  DistanceCache<data_t> cache;
+  if (mapped)
+    cache.open(output, first.N, false, first.band, first.data_hash, first.config);
+  else
+    cache.resize(first.N);
+
+  const auto &matrix = cache.matrix();
+  try {
+    std::vector<uint8_t> loaded((matrix.tiles() + 7) / 8, 0);
+    auto copyTile = [&](size_t ti, size_t tj, const data_t *entries, size_t count) {
+      const size_t offset = matrix.tileBlock(ti, tj).first, t = ShardFile<data_t>::tileIndex(matrix.tileRows(), ti, tj);
+      for (size_t k = 0; k < count; k++)
+        cache.setAt(offset + k, entries[k]);
+      loaded[t / 8] |= uint8_t(1 << (t % 8));
+    };
+
+    for (const auto &shard : shards)
+      if (!ShardFile<data_t>::load(shard, first.N, first.band, first.data_hash, first.config, copyTile))
+        throw std::runtime_error("mergeShards: " + shard.string() + " is not a shard of the same distance matrix as " + shards.front().string() + ".\n");
+
+    size_t missing = matrix.tiles();
+    for (size_t t = 0; t < matrix.tiles(); t++)
+      missing -= (loaded[t / 8] >> (t % 8)) & 1;
+
+    if (missing > 0)
+      throw std::runtime_error("mergeShards: " + std::to_string(missing) + " of " + std::to_string(matrix.tiles())
+                               + " tiles of the distance matrix are in none of the shards.\n");
+  } catch (...) {
+    if (mapped) { // Do not leave a partly written matrix behind.
+      cache.close();
+      fs::remove(output);
+    }
+    throw;
+  }
+
+  if (mapped)
+    cache.close(); // Written back to the file.
+  else
+    writeBinaryMatrix(matrix, output, first.band, first.data_hash, first.config);
+
+  return readMatrixHeader(output);
+}
+
+} // namespace dtwc
@@ -0,0 +1,104 @@
+/**
+ * @file cpu_dispatch.hpp
+ * @brief Runtime CPU feature detection for SIMD kernels.
+ *
+ * @details Kernels that benefit from wide vectors are compiled several times with
+ * different instruction set targets (SSE4.2, AVX2, AVX-512) and one of them is
+ * chosen at runtime from CPUID, so that a single binary runs on all machines.
+ * Per-target compilation relies on the GCC/Clang `target` attribute on x86;
+ * on other compilers and architectures only the generic path is compiled and the
+ * compiler's baseline vectorisation is used.
+ *
+ * @date 17 Oct 2026
+ * @author Volkan Kumtepeli
+ * @author Becky Perriment
+ */
+
+#pragma once
+
+#include <atomic> // for atomic, memory_order_relaxed
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define DTWC_X86_DISPATCH 1
+#define DTWC_TARGET(isa) __attribute__((target(isa)))
+#define DTWC_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define DTWC_X86_DISPATCH 0
+#define DTWC_TARGET(isa)
+#define DTWC_ALWAYS_INLINE inline
+#endif
+
+#define DTWC_TARGET_SSE42 DTWC_TARGET("sse4.2")
+#define DTWC_TARGET_AVX2 DTWC_TARGET("avx2,fma")
+#define DTWC_TARGET_AVX512 DTWC_TARGET("avx512f,avx512dq,avx512vl,avx512bw,prefer-vector-width=512")
+
+namespace dtwc::simd {
+
+/// @brief Instruction set levels that kernels can be dispatched to, in increasing order.
+enum class Level {
+  Generic, //<! Compiler baseline (SSE2 on x86-64, NEON on arm64).
+  SSE42,   //<! SSE4.2, 128-bit vectors.
+  AVX2,    //<! AVX2 + FMA, 256-bit vectors.
+  AVX512   //<! AVX-512 F/DQ/VL/BW, 512-bit vectors.
+};
+
+/**
+ * @brief Detects the highest instruction set level supported by the CPU and OS.
+ * @return Detected level; always Level::Generic if dispatch is not compiled in.
+ */
+inline Level detect_level()
+{
+#if DTWC_X86_DISPATCH
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")
+      && __builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("avx512bw"))
+    return Level::AVX512;
+
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    return Level::AVX2;
+
+  if (__builtin_cpu_supports("sse4.2"))
+    return Level::SSE42;
+#endif
+  return Level::Generic;
+}
+
+namespace detail {
+  inline std::atomic<Level> max_level{ Level::AVX512 }; //!< Upper limit for dispatch, see set_max_level().
+} // namespace detail
+
+/**
+ * @brief Caps the level kernels dispatch to, e.g., to test or benchmark slower paths.
+ * @details Meant to be called between computations: kernels running in other threads may still
+ * use the previous level. Level::AVX512 removes the cap.
+ */
+inline void set_max_level(Level lvl) { detail::max_level.store(lvl, std::memory_order_relaxed); }
+
+/**
+ * @brief Level kernels should dispatch to: detected level capped by set_max_level().
+ */
+inline Level level()
+{
+  static const Level detected = detect_level();
+  const Level cap = detail::max_level.load(std::memory_order_relaxed);
+  return (detected < cap) ? detected : cap;
+}
+
+/**
+ * @brief Name of an instruction set level for printing.
+ */
+inline const char *to_string(Level lvl)
+{
+  switch (lvl) {
+  case Level::SSE42:
+    return "SSE4.2";
+  case Level::AVX2:
+    return "AVX2";
+  case Level::AVX512:
+    return "AVX-512";
+  default:
+    return "Generic";
+  }
+}
+
+} // namespace dtwc::simd
@@ -0,0 +1,394 @@
+/**
+ * @file DistanceCache.hpp
+ * @brief Thread-safe lazily computed distance matrix.
+ *
+ * @details Every entry of the (packed, symmetric) DistanceMatrix has an atomic state:
+ * empty, computing or ready. The first thread asking for an empty entry claims it and computes
+ * it; other threads asking for the same entry wait until it is published. Each distance is
+ * therefore computed once, and values are only read after their publication (release/acquire),
+ * so readers never see partially written values. The states take one byte per entry.
+ *
+ * The entries and states are kept in memory, or in a memory-mapped file (see open()) when the
+ * matrix does not fit in RAM. A file left by an interrupted run keeps its published entries
+ * and can be opened again to continue.
+ *
+ * @date 17 Oct 2026
+ * @author Volkan Kumtepeli
+ * @author Becky Perriment
+ */
+
+#pragma once
+
+#include "DistanceMatrix.hpp" // for DistanceMatrix
+#include "DistanceFile.hpp"   // for DistanceFileHeader, isLittleEndian
+#include "MappedFile.hpp"     // for MappedFile
+
+#include <cstddef>    // for size_t
+#include <cstdint>    // for uint8_t, uint32_t, uint64_t
+#include <cstring>    // for memcpy, memset
+#include <atomic>     // for atomic, memory_order
+#include <filesystem> // for path, rename
+#include <memory>     // for unique_ptr
+#include <stdexcept>  // for runtime_error
+#include <string>     // for to_string
+#include <thread>     // for this_thread::yield
+#include <utility>    // for move
+#include <vector>     // for vector
+
+namespace dtwc {
+
+template <typename data_t>
+class DistanceCache
+{
+public:
+  enum State : uint8_t {
+    Empty = 0, //<! Not computed; its value is -1.
+    Computing, //<! Claimed by a thread which is computing it.
+    Ready      //<! Computed and published.
+  };
+
+private:
+  static_assert(sizeof(std::atomic<uint8_t>) == 1 && std::atomic<uint8_t>::is_always_lock_free,
+                "States are stored as plain bytes in mapped files.");
+
+  DistanceMatrix<data_t> values;
+  std::unique_ptr<std::atomic<uint8_t>[]> owned_states;
+  std::atomic<uint8_t> *states{ nullptr }; //!< owned_states or in the mapped file.
+  MappedFile file;
+
+  std::atomic<uint8_t> &state(size_t i, size_t j) const { return states[values.index(i, j)]; }
+
+  void allocateStates()
+  {
+    owned_states.reset(new std::atomic<uint8_t>[values.entries()]);
+    states = owned_states.get();
+  }
+
+public:
+  DistanceCache() = default;
+  explicit DistanceCache(size_t N) { resize(N); }
+
+  DistanceCache(const DistanceCache &other) { *this = other; }
+  DistanceCache &operator=(const DistanceCache &other) //!< Copies the entries to memory, also from a mapped file.
+  {
+    if (this == &other) return *this;
+    values = other.values;
+    file.close();
+    allocateStates();
+    for (size_t k = 0; k < values.entries(); k++)
+      states[k].store(other.states[k].load(std::memory_order_acquire), std::memory_order_relaxed);
+
+    return *this;
+  }
+
+  DistanceCache(DistanceCache &&) = default;
+  DistanceCache &operator=(DistanceCache &&) = default;
+
+  /**
+   * @brief Resizes to N x N empty entries; a mapped file is resized and emptied. Not thread-safe.
+   */
+  void resize(size_t N)
+  {
+    if (isMapped()) { // Keeps the band, data hash and configuration of the file.
+      DistanceFileHeader header;
+      std::memcpy(&header, file.data(), sizeof(DistanceFileHeader));
+      open(file.path(), N, false, header.band, header.data_hash, header.config);
+      return;
+    }
+
+    values.resize(N, -1);
+    allocateStates();
+    clear();
+  }
+
+  /**
+   * @brief Empties all entries. Not thread-safe.
+   */
+  void clear()
+  {
+    values.fill(-1);
+    for (size_t k = 0; k < values.entries(); k++)
+      states[k].store(Empty, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Keeps N x N entries and their states in a memory-mapped file instead of memory. Not thread-safe.
+   *
+   * @details The file has the packed layout of DistanceFile.hpp, followed by the states; it is created
+   * if needed. If it holds N x N entries of data_t for the same band, data hash and configuration, e.g., left by an
+   * interrupted run or written by writeBinaryMatrix (whose non-negative entries become ready), its
+   * entries are used without copying; entries left computing are emptied. Otherwise, all entries are
+   * emptied. A file mapped before is unmapped first.
+   *
+   * @param path Path of the file; a copy, as it may be path().
+   * @param N Number of rows (and columns).
+   * @param resume Whether to keep the entries of a matching file.
+   * @param band Band of the distances, recorded in the file.
+   * @param data_hash Hash of the data (Data::hash), recorded in the file.
+   * @param config Configuration of the distances (Problem::distanceConfig), recorded in the file.
+   * @return Whether the entries of an existing file are kept.
+   * @throws std::runtime_error if the file cannot be mapped or the machine is not little-endian.
+   */
+  bool open(std::filesystem::path path, size_t N, bool resume = true, int64_t band = -1, uint64_t data_hash = 0, uint32_t config = 0)
+  {
+    if (!isLittleEndian())
+      throw std::runtime_error("DistanceCache: distance matrix files are little-endian, which this machine is not.\n");
+
+    DistanceFileHeader expected;
+    expected.element_bytes = sizeof(data_t);
+    expected.N = N;
+    expected.band = band;
+    expected.data_hash = data_hash;
+    expected.config = config;
+    expected.layout = static_cast<uint32_t>(MatrixLayout::Packed);
+    expected.tile = DistanceMatrix<data_t>::tile;
+    expected.flags = DistanceFileHeader::has_states;
+    expected.seal();
+
+    const size_t entries = expected.entries(), value_bytes = expected.entryBytes();
+
+    if (isMapped()) close(); // Also when the file is mapped again with another size.
+
+    file = MappedFile(path, sizeof(DistanceFileHeader) + value_bytes + entries);
+    owned_states.reset();
+
+    auto *begin = static_cast<unsigned char *>(file.data());
+    values.attach(N, reinterpret_cast<data_t *>(begin + sizeof(DistanceFileHeader)));
+    states = reinterpret_cast<std::atomic<uint8_t> *>(begin + sizeof(DistanceFileHeader) + value_bytes);
+
+    DistanceFileHeader header;
+    std::memcpy(&header, begin, sizeof(DistanceFileHeader));
+    const bool matches = header.isValid() && header.element_bytes == expected.element_bytes && header.N == N && header.band == band
+                         && header.data_hash == data_hash && header.config == config && header.layout == expected.layout && header.tile == expected.tile
+                         && !(header.flags & DistanceFileHeader::has_tile_records); // Not all entries in a shard.
+
+    if (resume && matches) {
+      const bool has_states = header.flags & DistanceFileHeader::has_states;
+      for (size_t k = 0; k < entries; k++)
+        if (!has_states) // States appended to a file without them.
+          states[k].store(values[k] >= 0 ? Ready : Empty, std::memory_order_relaxed);
+        else if (states[k].load(std::memory_order_relaxed) == Computing)
+          states[k].store(Empty, std::memory_order_relaxed);
+
+      std::memcpy(begin, &expected, sizeof(DistanceFileHeader));
+      return true;
+    }
+
+    std::memset(begin, 0, sizeof(DistanceFileHeader)); // Invalid until the entries are emptied.
+    clear();
+    std::memcpy(begin, &expected, sizeof(DistanceFileHeader));
+    return false;
+  }
+
+  /**
+   * @brief Unmaps the file, keeping it, and leaves an empty 0 x 0 cache in memory. Not thread-safe.
+   */
+  void close()
+  {
+    values.resize(0);
+    allocateStates();
+    file.close();
+  }
+
+  /**
+   * @brief Rearranges the entries for another set of points, e.g., when points are appended or removed. Not thread-safe.
+   *
+   * @details Entry (i, j) becomes entry (from[i], from[j]), which is kept if it is ready; entries of
+   * new points are empty. Nothing is computed again. A mapped matrix is written to a new file next to
+   * its file (with the extension .tmp added), which then replaces it.
+   *
+   * @param from Current index of each point, negative for new points.
+   * @param band Band of the distances, recorded in a mapped file.
+   * @param data_hash Hash of the new data (Data::hash), recorded in a mapped file.
+   * @param config Configuration of the distances (Problem::distanceConfig), recorded in a mapped file.
+   * @throws std::runtime_error if an index is out of range, or the new file cannot be mapped.
+   */
+  void reindex(const std::vector<int> &from, int64_t band = -1, uint64_t data_hash = 0, uint32_t config = 0)
+  {
+    for (const int k : from)
+      if (k >= static_cast<int>(size()))
+        throw std::runtime_error("DistanceCache: index " + std::to_string(k) + " of " + std::to_string(size()) + " points is out of range.\n");
+
+    DistanceCache target;
+    std::filesystem::path temporary;
+    if (isMapped()) {
+      temporary = path();
+      temporary += ".tmp";
+      target.open(temporary, from.size(), false, band, data_hash, config);
+    } else
+      target.resize(from.size());
+
+    const auto &matrix = target.matrix();
+    for (size_t i = 0; i < from.size(); i++)
+      if (from[i] >= 0)
+        for (size_t j = i; j < from.size(); j++)
+          if (from[j] >= 0 && isReady(from[i], from[j]))
+            target.setAt(matrix.index(i, j), values(from[i], from[j]));
+
+    if (!isMapped()) {
+      *this = std::move(target);
+      return;
+    }
+
+    const auto file_path = path();
+    target.close();
+    close();
+    std::filesystem::rename(temporary, file_path);
+    open(file_path, from.size(), true, band, data_hash, config); // Its entries are kept.
+  }
+
+  /**
+   * @brief Records the band, data hash and configuration of the ready entries in a mapped file; nothing to do in memory. Not thread-safe.
+   * @details For changes which keep the ready entries valid, e.g., when the entries of a grown series are reset or updated.
+   */
+  void setHeader(int64_t band, uint64_t data_hash, uint32_t config = 0)
+  {
+    if (!isMapped()) return;
+
+    DistanceFileHeader header;
+    std::memcpy(&header, file.data(), sizeof(DistanceFileHeader));
+    header.band = band;
+    header.data_hash = data_hash;
+    header.config = config;
+    header.seal();
+    std::memcpy(file.data(), &header, sizeof(DistanceFileHeader));
+  }
+
+  bool isMapped() const { return file.data() != nullptr; }           //!< Whether the entries are in a mapped file.
+  const std::filesystem::path &path() const { return file.path(); } //!< Path of the mapped file.
+  void flush() const { file.flush(); }                               //!< Schedules the mapped file to be written.
+
+  /**
+   * @brief Replaces the entries with the ones of a matrix; non-negative entries are ready. Not thread-safe.
+   */
+  void assign(const DistanceMatrix<data_t> &matrix)
+  {
+    resize(matrix.size());
+    for (size_t k = 0; k < values.entries(); k++)
+      if (matrix[k] >= 0) {
+        values[k] = matrix[k];
+        states[k].store(Ready, std::memory_order_relaxed);
+      }
+  }
+
+  size_t size() const { return values.size(); }                                                     //!< Number of rows (and columns).
+  size_t bytes() const { return values.bytes() + values.entries() * sizeof(std::atomic<uint8_t>); } //!< Memory (or file) size of the entries and their states.
+
+  /**
+   * @brief Number of ready entries, N * (N + 1) / 2 when the matrix is filled.
+   */
+  size_t readyCount() const
+  {
+    size_t count = 0;
+    for (size_t k = 0; k < values.entries(); k++)
+      count += (states[k].load(std::memory_order_acquire) == Ready);
+
+    return count;
+  }
+
+  /**
+   * @brief The distances; entries which are not ready are -1. Only consistent when no entry is being computed.
+   */
+  const DistanceMatrix<data_t> &matrix() const { return values; }
+
+  bool isReady(size_t i, size_t j) const { return state(i, j).load(std::memory_order_acquire) == Ready; } //!< Whether (i, j) is computed.
+  bool isReadyAt(size_t k) const { return states[k].load(std::memory_order_acquire) == Ready; }          //!< Whether the entry at position k of the packed storage is computed.
+
+  /**
+   * @brief The distance (i, j) if it is ready, otherwise -1.
+   */
+  data_t operator()(size_t i, size_t j) const { return isReady(i, j) ? values(i, j) : data_t(-1); }
+
+  /**
+   * @brief Claims the empty entry (i, j) to compute it; then publish() or release() it.
+   * @return False if the entry is being computed by another thread or is ready.
+   */
+  bool claim(size_t i, size_t j)
+  {
+    uint8_t expected = Empty;
+    return state(i, j).compare_exchange_strong(expected, Computing, std::memory_order_acq_rel);
+  }
+
+  /**
+   * @brief Publishes the value of a claimed entry.
+   */
+  void publish(size_t i, size_t j, data_t value)
+  {
+    values(i, j) = value;
+    state(i, j).store(Ready, std::memory_order_release);
+  }
+
+  /**
+   * @brief Gives up a claimed entry without a value, e.g., when its computation was abandoned.
+   */
+  void release(size_t i, size_t j) { state(i, j).store(Empty, std::memory_order_release); }
+
+  /**
+   * @brief Sets entry (i, j) regardless of its state; only when no other thread accesses it.
+   */
+  void set(size_t i, size_t j, data_t value) { publish(i, j, value); }
+
+  /**
+   * @brief Sets the entry at position k of the packed storage (see DistanceMatrix::index); only when no other thread accesses it.
+   */
+  void setAt(size_t k, data_t value)
+  {
+    values[k] = value;
+    states[k].store(Ready, std::memory_order_release);
+  }
+
+  /**
+   * @brief Empties entry (i, j); only when no other thread accesses it.
+   */
+  void reset(size_t i, size_t j)
+  {
+    values(i, j) = -1;
+    state(i, j).store(Empty, std::memory_order_release);
+  }
+
+  /**
+   * @brief Returns the distance (i, j), computing it with compute() if nobody has.
+   *
+   * @details If another thread is computing the entry, waits for its value. If compute() throws,
+   * the entry is released and the exception is propagated.
+   *
+   * @param compute Function returning the distance (i, j).
+   */
+  template <typename Tfun>
+  data_t get(size_t i, size_t j, Tfun &&compute)
+  {
+    auto &s = state(i, j);
+    while (true) {
+      uint8_t current = s.load(std::memory_order_acquire);
+      if (current == Ready) return values(i, j);
+
+      if (current == Empty && s.compare_exchange_weak(current, Computing, std::memory_order_acq_rel)) {
+        data_t value;
+        try {
+          value = compute();
+        } catch (...) {
+          release(i, j);
+          throw;
+        }
+        publish(i, j, value);
+        return value;
+      }
+
+      std::this_thread::yield(); // Another thread is computing it.
+    }
+  }
+
+  /**
+   * @brief Waits until entry (i, j) is not being computed; returns its value if ready, otherwise -1.
+   */
+  data_t wait(size_t i, size_t j) const
+  {
+    uint8_t current;
+    while ((current = state(i, j).load(std::memory_order_acquire)) == Computing)
+      std::this_thread::yield();
+
+    return (current == Ready) ? values(i, j) : data_t(-1);
+  }
+};
+
+} // namespace dtwc
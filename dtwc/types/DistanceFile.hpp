@@ -0,0 +1,99 @@
+/**
+ * @file DistanceFile.hpp
+ * @brief Header of binary distance matrix files.
+ *
+ * @details A binary distance matrix file is a 64-byte DistanceFileHeader followed by the raw,
+ * little-endian entries: N x N column by column (MatrixLayout::Dense), or the N * (N + 1) / 2 entries
+ * of a DistanceMatrix in its tile order (MatrixLayout::Packed). Packed files can be memory-mapped
+ * and used without copying (see DistanceCache::open), in which case one state byte per entry
+ * follows the entries (DistanceFileHeader::has_states). Shards of a matrix only hold records of their
+ * tiles (DistanceFileHeader::has_tile_records, see ShardFile). The header records the band, a hash of
+ * the data (Data::hash) and a tag of the other settings (Problem::distanceConfig) the distances were
+ * computed with, and a checksum of the header itself.
+ *
+ * @date 17 Oct 2026
+ * @author Volkan Kumtepeli
+ * @author Becky Perriment
+ */
+
+#pragma once
+
+#include <cstddef> // for size_t
+#include <cstdint> // for uint8_t, uint32_t, uint64_t, int64_t
+#include <cstring> // for memcpy, memcmp
+
+namespace dtwc {
+
+/**
+ * @brief 64-bit FNV-1a hash of count bytes, taken eight bytes at a time.
+ * @param hash Hash of the preceding bytes, to hash several blocks one after the other.
+ */
+inline uint64_t hashBytes(const void *bytes, size_t count, uint64_t hash = 14695981039346656037ULL)
+{
+  constexpr uint64_t prime = 1099511628211ULL;
+  const auto *p = static_cast<const unsigned char *>(bytes);
+  for (; count >= 8; count -= 8, p += 8) {
+    uint64_t word;
+    std::memcpy(&word, p, 8);
+    hash = (hash ^ word) * prime;
+  }
+  for (; count > 0; count--, p++)
+    hash = (hash ^ *p) * prime;
+
+  return hash;
+}
+
+/**
+ * @brief Whether the machine is little-endian, the byte order of binary distance matrix files.
+ */
+inline bool isLittleEndian()
+{
+  const uint16_t one = 1;
+  uint8_t first;
+  std::memcpy(&first, &one, 1);
+  return first == 1;
+}
+
+enum class MatrixLayout : uint32_t {
+  Dense = 0, //<! N x N entries, column by column (row by row, as the matrix is symmetric).
+  Packed = 1 //<! Upper triangle in the tile order of DistanceMatrix.
+};
+
+struct DistanceFileHeader
+{
+  static constexpr char file_magic[8] = { 'D', 'T', 'W', 'C', 'D', 'M', 'A', 'T' };
+  static constexpr uint32_t file_version = 1;
+  static constexpr uint32_t has_states = 1;      //!< Flag: one state byte per entry follows the entries.
+  static constexpr uint32_t has_tile_bitmap = 2; //!< Flag: one bit per tile, set if it is complete, follows the entries (see TileCheckpoint).
+  static constexpr uint32_t has_tile_records = 4; //!< Flag: records of some tiles follow instead of the entries (see ShardFile).
+
+  char magic[8]{ 'D', 'T', 'W', 'C', 'D', 'M', 'A', 'T' };
+  uint32_t version{ file_version };
+  uint32_t element_bytes{ 0 }; //!< Size of an entry: 4 for float, 8 for double.
+  uint64_t N{ 0 };             //!< Number of rows (and columns).
+  int64_t band{ -1 };          //!< Band the distances were computed with, -1 for full DTW.
+  uint64_t data_hash{ 0 };     //!< Data::hash of the data, 0 if unknown.
+  uint32_t layout{ 0 };        //!< MatrixLayout of the entries.
+  uint32_t tile{ 0 };          //!< DistanceMatrix::tile for MatrixLayout::Packed.
+  uint32_t flags{ 0 };         //!< has_states, has_tile_bitmap or has_tile_records.
+  uint32_t config{ 0 };        //!< Problem::distanceConfig of the other settings of the distances, 0 if unknown.
+  uint64_t checksum{ 0 }; //!< hashBytes of the fields above, see seal().
+
+  size_t entries() const { return layout == static_cast<uint32_t>(MatrixLayout::Dense) ? N * N : N * (N + 1) / 2; } //!< Number of entries.
+  size_t entryBytes() const { return entries() * element_bytes; }                                                  //!< Size of the entries.
+
+  void seal() { checksum = hashBytes(this, offsetof(DistanceFileHeader, checksum)); } //!< Sets the checksum.
+
+  /**
+   * @brief Whether the magic, version and checksum are right, i.e., the bytes are a header written by seal().
+   */
+  bool isValid() const
+  {
+    return std::memcmp(magic, file_magic, sizeof(magic)) == 0 && version == file_version
+           && checksum == hashBytes(this, offsetof(DistanceFileHeader, checksum));
+  }
+};
+
+static_assert(sizeof(DistanceFileHeader) == 64, "Entries start 64 bytes into the file.");
+
+} // namespace dtwc
@@ -0,0 +1,249 @@
+/**
+ * @file DistanceMatrix.hpp
+ * @brief Symmetric distance matrix stored as a packed, tile-ordered upper triangle.
+ *
+ * @details DTW distances are symmetric, so only the N * (N + 1) / 2 entries (i, j) with
+ * i <= j are stored: half the memory of a dense N x N matrix. The triangle is cut into
+ * tile x tile tiles which are stored one after the other, tile row by tile row; diagonal tiles
+ * are themselves packed triangles. Each row of a tile is contiguous, and so is each tile row,
+ * so walking the matrix tile by tile (see forEachPair()) reads memory sequentially. This
+ * matters when the entries live in a memory-mapped file (see DistanceCache::open()).
+ *
+ * @date 17 Oct 2026
+ * @author Volkan Kumtepeli
+ * @author Becky Perriment
+ */
+
+#pragma once
+
+#include <cstddef>   // for size_t
+#include <algorithm> // for max_element, fill, copy, min, max
+#include <limits>    // for numeric_limits
+#include <stdexcept> // for runtime_error
+#include <string>    // for to_string
+#include <utility>   // for swap, exchange, move, pair
+#include <vector>    // for vector
+
+#include <armadillo>
+
+namespace dtwc {
+
+template <typename data_t>
+class DistanceMatrix
+{
+public:
+  static constexpr size_t tile = 64; //!< Side of the tiles; a 64 x 64 tile of doubles is 32 kB.
+
+private:
+  size_t N{ 0 };
+  std::vector<data_t> owned; //!< Entries, unless they are attached from elsewhere.
+  data_t *packed{ nullptr }; //!< Entries, tile by tile.
+
+  size_t side(size_t t) const { return side(N, t); } //!< Side of tile row t; the last one may be partial.
+  static size_t side(size_t N_, size_t t) { return std::min(tile, N_ - t * tile); }
+
+  /// Offset of tile row t: each full tile row before it holds a triangle and tile x (N - (t' + 1) * tile) entries.
+  size_t tileRowOffset(size_t t) const { return t * tile * N - tile * t * (tile * t - 1) / 2; }
+
+  /**
+   * @brief Calls f(i, j_first, begin, count) for the contiguous entries (i, j), j in [j_first, j_first + count),
+   * of each row of the tiles in tile row t, in storage order.
+   */
+  template <typename Tfun>
+  void forEachSegment(size_t t, Tfun &&f) const
+  {
+    const size_t i0 = t * tile, s = side(t);
+    const data_t *p = packed + tileRowOffset(t);
+    for (size_t r = 0; r < s; p += s - r, r++) // Diagonal tile.
+      f(i0 + r, i0 + r, p, s - r);
+
+    for (size_t j0 = i0 + s; j0 < N; j0 += tile) {
+      const size_t width = std::min(tile, N - j0);
+      for (size_t r = 0; r < s; r++, p += width)
+        f(i0 + r, j0, p, width);
+    }
+  }
+
+public:
+  DistanceMatrix() = default;
+
+  /**
+   * @brief Creates an N x N matrix with all entries set to value.
+   */
+  explicit DistanceMatrix(size_t N_, data_t value = -1) { resize(N_, value); }
+
+  /**
+   * @brief Creates a matrix from the upper triangle of a square Armadillo matrix.
+   * @throws std::runtime_error if the matrix is not square.
+   */
+  explicit DistanceMatrix(const arma::Mat<data_t> &matrix)
+  {
+    if (matrix.n_rows != matrix.n_cols)
+      throw std::runtime_error("DistanceMatrix: matrix of size " + std::to_string(matrix.n_rows) + " x " + std::to_string(matrix.n_cols) + " is not square.\n");
+
+    resize(matrix.n_rows);
+    for (size_t j = 0; j < N; j++)
+      for (size_t i = 0; i <= j; i++)
+        packed[index(i, j)] = matrix(i, j);
+  }
+
+  DistanceMatrix(const DistanceMatrix &other) { *this = other; }
+  DistanceMatrix &operator=(const DistanceMatrix &other) //!< Copies the entries; the copy owns them.
+  {
+    if (this == &other) return *this;
+    N = other.N;
+    owned.assign(other.packed, other.packed + other.entries());
+    packed = owned.data();
+    return *this;
+  }
+
+  DistanceMatrix(DistanceMatrix &&other) noexcept { *this = std::move(other); }
+  DistanceMatrix &operator=(DistanceMatrix &&other) noexcept
+  {
+    N = std::exchange(other.N, 0);
+    owned = std::move(other.owned);
+    packed = std::exchange(other.packed, nullptr);
+    return *this;
+  }
+
+  static size_t entries(size_t N_) { return N_ * (N_ + 1) / 2; } //!< Number of stored entries of an N_ x N_ matrix.
+  static size_t tileRows(size_t N_) { return (N_ + tile - 1) / tile; } //!< Number of tile rows of an N_ x N_ matrix.
+
+  /**
+   * @brief Number of entries of tile (ti, tj), ti <= tj, of an N_ x N_ matrix, without allocating it.
+   */
+  static size_t tileEntries(size_t N_, size_t ti, size_t tj)
+  {
+    const size_t s = side(N_, ti);
+    return (ti == tj) ? s * (s + 1) / 2 : s * side(N_, tj);
+  }
+
+  /**
+   * @brief Resizes to an N x N matrix with all entries set to value.
+   */
+  void resize(size_t N_, data_t value = -1)
+  {
+    N = N_;
+    owned.assign(entries(N), value);
+    packed = owned.data();
+  }
+
+  /**
+   * @brief Uses entries(N_) entries at external, e.g., a memory-mapped file, without initialising them.
+   * @details The storage is not owned; it must outlive the matrix or the next resize()/attach().
+   */
+  void attach(size_t N_, data_t *external)
+  {
+    N = N_;
+    owned.clear();
+    owned.shrink_to_fit();
+    packed = external;
+  }
+
+  /**
+   * @brief Position of entry (i, j), i.e., of (j, i), in the packed storage.
+   */
+  size_t index(size_t i, size_t j) const
+  {
+    if (i > j) std::swap(i, j);
+    const size_t ti = i / tile, tj = j / tile, s = side(ti), r = i - ti * tile;
+    if (ti == tj) return tileRowOffset(ti) + r * s - r * (r - 1) / 2 + (j - i); // Packed diagonal tile.
+
+    return tileRowOffset(ti) + s * (s + 1) / 2 + s * (tj - ti - 1) * tile + r * side(tj) + (j - tj * tile);
+  }
+
+  void fill(data_t value) { std::fill(packed, packed + entries(), value); } //!< Sets all entries to value.
+
+  size_t size() const { return N; }                          //!< Number of rows (and columns).
+  size_t entries() const { return entries(N); }              //!< Number of stored entries, N * (N + 1) / 2.
+  size_t bytes() const { return entries() * sizeof(data_t); } //!< Memory used by the entries.
+  size_t tileRows() const { return tileRows(N); }             //!< Number of tile rows, see forEachPair().
+  bool isAttached() const { return packed != owned.data(); }  //!< Whether the entries are stored elsewhere.
+  size_t tiles() const { return tileRows() * (tileRows() + 1) / 2; } //!< Number of tiles (ti, tj), ti <= tj.
+
+  /**
+   * @brief Position in the packed storage and number of the (contiguous) entries of tile (ti, tj), ti <= tj.
+   */
+  std::pair<size_t, size_t> tileBlock(size_t ti, size_t tj) const { return { index(ti * tile, tj * tile), tileEntries(N, ti, tj) }; }
+
+  data_t &operator()(size_t i, size_t j) { return packed[index(i, j)]; }
+  const data_t &operator()(size_t i, size_t j) const { return packed[index(i, j)]; }
+
+  data_t *data() { return packed; }             //!< The packed storage, see index().
+  const data_t *data() const { return packed; } //!< The packed storage, see index().
+
+  data_t &operator[](size_t k) { return packed[k]; }             //!< Entry at position k of the packed storage, see index().
+  const data_t &operator[](size_t k) const { return packed[k]; } //!< Entry at position k of the packed storage, see index().
+
+  /**
+   * @brief Largest entry, lowest value of data_t for an empty matrix.
+   */
+  data_t max() const { return N == 0 ? std::numeric_limits<data_t>::lowest() : *std::max_element(packed, packed + entries()); }
+
+  /**
+   * @brief Calls task(i, j, value) for the entries with i < j of tile row t, in storage order.
+   * @details Tile rows are independent, so they can be processed in parallel.
+   */
+  template <typename Tfun>
+  void forEachPair(size_t t, Tfun &&task) const
+  {
+    forEachSegment(t, [&](size_t i, size_t j_first, const data_t *p, size_t count) {
+      for (size_t k = (j_first == i) ? 1 : 0; k < count; k++) // Skips the diagonal.
+        task(i, j_first + k, p[k]);
+    });
+  }
+
+  /**
+   * @brief Calls task(i, j, value) for all entries with i < j, tile by tile.
+   */
+  template <typename Tfun>
+  void forEachPair(Tfun &&task) const
+  {
+    for (size_t t = 0; t < tileRows(); t++)
+      forEachPair(t, task);
+  }
+
+  /**
+   * @brief Copies the entries (i, j) for j in [first, last) to out.
+   * @details Entries with j >= i are copied in contiguous blocks, one per tile.
+   */
+  void row(size_t i, size_t first, size_t last, data_t *out) const
+  {
+    size_t j = first;
+    for (; j < std::min(i, last); j++)
+      *out++ = packed[index(j, i)];
+
+    while (j < last) {
+      const size_t block = std::min(last, (j / tile + 1) * tile) - j;
+      const auto begin = packed + index(i, j);
+      out = std::copy(begin, begin + block, out);
+      j += block;
+    }
+  }
+
+  /**
+   * @brief Copies row i to out, resizing it to N.
+   */
+  void row(size_t i, std::vector<data_t> &out) const
+  {
+    out.resize(N);
+    row(i, 0, N, out.data());
+  }
+
+  /**
+   * @brief Dense Armadillo copy of the matrix.
+   */
+  arma::Mat<data_t> toArma() const
+  {
+    arma::Mat<data_t> matrix(N, N);
+    for (size_t t = 0; t < tileRows(); t++)
+      forEachSegment(t, [&](size_t i, size_t j_first, const data_t *p, size_t count) {
+        for (size_t k = 0; k < count; k++)
+          matrix(i, j_first + k) = matrix(j_first + k, i) = p[k];
+      });
+
+    return matrix;
+  }
+};
+
+} // namespace dtwc
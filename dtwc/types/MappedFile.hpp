@@ -0,0 +1,150 @@
+/**
+ * @file MappedFile.hpp
+ * @brief Read-write memory mapping of a file.
+ *
+ * @details The file is created if it does not exist and resized to the requested number of bytes
+ * (new bytes are zero). Changes are written back to the file by the operating system, also if
+ * the program is interrupted; flush() schedules them to be written.
+ *
+ * @date 17 Oct 2026
+ * @author Volkan Kumtepeli
+ * @author Becky Perriment
+ */
+
+#pragma once
+
+#include <cstddef>    // for size_t
+#include <filesystem> // for path
+#include <stdexcept>  // for runtime_error
+#include <string>     // for string
+#include <utility>    // for exchange
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>    // for open
+#include <sys/mman.h> // for mmap, munmap, msync
+#include <unistd.h>   // for ftruncate, close
+#endif
+
+namespace dtwc {
+
+class MappedFile
+{
+  std::filesystem::path file;
+  void *ptr{ nullptr };
+  size_t length{ 0 };
+#ifdef _WIN32
+  HANDLE file_handle{ INVALID_HANDLE_VALUE };
+  HANDLE mapping{ nullptr };
+#else
+  int fd{ -1 };
+#endif
+
+  [[noreturn]] void fail(const std::string &what)
+  {
+    close();
+    throw std::runtime_error("MappedFile: could not " + what + " " + file.string() + ".\n");
+  }
+
+public:
+  MappedFile() = default;
+
+  /**
+   * @brief Maps the file at path, created or resized to bytes.
+   * @throws std::runtime_error if the file cannot be opened, resized or mapped.
+   */
+  MappedFile(const std::filesystem::path &path, size_t bytes) : file{ path }, length{ bytes }
+  {
+#ifdef _WIN32
+    file_handle = CreateFileW(file.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE) fail("open");
+
+    LARGE_INTEGER size;
+    size.QuadPart = static_cast<LONGLONG>(length);
+    if (!SetFilePointerEx(file_handle, size, nullptr, FILE_BEGIN) || !SetEndOfFile(file_handle)) fail("resize");
+    if (length == 0) return;
+
+    mapping = CreateFileMappingW(file_handle, nullptr, PAGE_READWRITE, size.HighPart, size.LowPart, nullptr);
+    if (mapping == nullptr) fail("map");
+
+    ptr = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, length);
+    if (ptr == nullptr) fail("map");
+#else
+    fd = ::open(file.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) fail("open");
+    if (::ftruncate(fd, static_cast<off_t>(length)) != 0) fail("resize");
+    if (length == 0) return;
+
+    ptr = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED) {
+      ptr = nullptr;
+      fail("map");
+    }
+#endif
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  MappedFile(MappedFile &&other) noexcept { *this = std::move(other); }
+  MappedFile &operator=(MappedFile &&other) noexcept
+  {
+    if (this == &other) return *this;
+    close();
+    file = std::move(other.file);
+    ptr = std::exchange(other.ptr, nullptr);
+    length = std::exchange(other.length, 0);
+#ifdef _WIN32
+    file_handle = std::exchange(other.file_handle, INVALID_HANDLE_VALUE);
+    mapping = std::exchange(other.mapping, nullptr);
+#else
+    fd = std::exchange(other.fd, -1);
+#endif
+    return *this;
+  }
+
+  ~MappedFile() { close(); }
+
+  void *data() const { return ptr; }                         //!< Start of the mapped bytes.
+  size_t size() const { return length; }                     //!< Number of mapped bytes.
+  const std::filesystem::path &path() const { return file; } //!< Path of the file.
+
+  /**
+   * @brief Schedules the changes to be written to the file.
+   */
+  void flush() const
+  {
+    if (ptr == nullptr) return;
+#ifdef _WIN32
+    FlushViewOfFile(ptr, 0);
+#else
+    ::msync(ptr, length, MS_ASYNC);
+#endif
+  }
+
+  /**
+   * @brief Unmaps and closes the file; the file is kept.
+   */
+  void close()
+  {
+#ifdef _WIN32
+    if (ptr != nullptr) UnmapViewOfFile(ptr);
+    if (mapping != nullptr) CloseHandle(mapping);
+    if (file_handle != INVALID_HANDLE_VALUE) CloseHandle(file_handle);
+    mapping = nullptr;
+    file_handle = INVALID_HANDLE_VALUE;
+#else
+    if (ptr != nullptr) ::munmap(ptr, length);
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+#endif
+    ptr = nullptr;
+    length = 0;
+  }
+};
+
+} // namespace dtwc
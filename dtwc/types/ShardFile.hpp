@@ -0,0 +1,202 @@
+/**
+ * @file ShardFile.hpp
+ * @brief Files of the tiles of a distance matrix computed by one of several processes.
+ *
+ * @details A shard file is a DistanceFileHeader with DistanceFileHeader::has_tile_records, followed
+ * by one record per computed tile of the DistanceMatrix: the tile (ti, tj) as two uint32_t, then its
+ * entries in the storage order of the matrix (see DistanceMatrix::tileBlock). Only the tiles of the
+ * shard are stored, so a shard of 1/K of the tiles takes about 1/K of the size of the matrix. Records
+ * are appended as tiles are completed; if the process is killed, start() with resume keeps the
+ * complete records, so only the other tiles are computed again. Shards are combined by mergeShards.
+ *
+ * @date 17 Oct 2026
+ * @author Volkan Kumtepeli
+ * @author Becky Perriment
+ */
+
+#pragma once
+
+#include "DistanceMatrix.hpp" // for DistanceMatrix
+#include "DistanceFile.hpp"   // for DistanceFileHeader, isLittleEndian
+
+#include <cstddef>      // for size_t
+#include <cstdint>      // for uint8_t, uint32_t, int64_t, uint64_t
+#include <cstring>      // for memcmp
+#include <filesystem>   // for path, file_size, resize_file
+#include <fstream>      // for ifstream, ofstream
+#include <mutex>        // for mutex, lock_guard
+#include <optional>     // for optional, nullopt
+#include <stdexcept>    // for runtime_error
+#include <string>       // for string
+#include <system_error> // for error_code
+#include <utility>      // for move
+#include <vector>       // for vector
+
+namespace dtwc {
+
+template <typename data_t>
+class ShardFile
+{
+  std::filesystem::path file;
+  std::ofstream stream;
+  size_t saved{ 0 }; //!< Number of saved tiles.
+  std::mutex mutex;
+
+  [[noreturn]] void fail(const std::string &what) const
+  {
+    throw std::runtime_error("ShardFile: could not " + what + " " + file.string() + ".\n");
+  }
+
+  static DistanceFileHeader makeHeader(size_t N, int64_t band, uint64_t data_hash, uint32_t config)
+  {
+    DistanceFileHeader h;
+    h.element_bytes = sizeof(data_t);
+    h.N = N;
+    h.band = band;
+    h.data_hash = data_hash;
+    h.config = config;
+    h.layout = static_cast<uint32_t>(MatrixLayout::Packed);
+    h.tile = DistanceMatrix<data_t>::tile;
+    h.flags = DistanceFileHeader::has_tile_records;
+    h.seal();
+    return h;
+  }
+
+public:
+  /**
+   * @brief Index of tile (ti, tj), ti <= tj, in the order of the tiles of a matrix with tile_rows tile rows.
+   */
+  static size_t tileIndex(size_t tile_rows, size_t ti, size_t tj) { return ti * tile_rows - ti * (ti - 1) / 2 + (tj - ti); }
+
+  /**
+   * @param path Path of the shard file.
+   */
+  explicit ShardFile(std::filesystem::path path) : file{ std::move(path) } {}
+
+  /**
+   * @brief Calls f(ti, tj, entries, count) for each complete record of the shard at path, in file order.
+   *
+   * @param path Path of the shard, e.g., written by Problem::fillDistanceMatrix.
+   * @param N Number of rows (and columns) the matrix must have.
+   * @param band Band the distances must have been computed with.
+   * @param data_hash Hash of the data (Data::hash) the distances must have been computed for.
+   * @param config Configuration (Problem::distanceConfig) the distances must have been computed with.
+   * @param f Function called with the tile, a pointer to its entries and their number.
+   * @param end If not null, set to the size of the header and the complete records.
+   * @return Number of records; nothing if path is not a shard of a matrix of size N, element type
+   * data_t, band, data hash and configuration.
+   * @throws std::runtime_error if a record is not a tile of the matrix.
+   */
+  template <typename Tfun>
+  static std::optional<size_t> load(const std::filesystem::path &path, size_t N, int64_t band, uint64_t data_hash, uint32_t config,
+                                    Tfun &&f, size_t *end = nullptr)
+  {
+    const auto expected = makeHeader(N, band, data_hash, config);
+
+    std::error_code ec;
+    const size_t file_bytes = std::filesystem::file_size(path, ec);
+    if (ec || file_bytes < sizeof(DistanceFileHeader)) return std::nullopt;
+
+    std::ifstream in(path, std::ios_base::binary);
+    DistanceFileHeader existing;
+    in.read(reinterpret_cast<char *>(&existing), sizeof(existing));
+    if (!in || std::memcmp(&existing, &expected, sizeof(expected)) != 0) return std::nullopt;
+
+    const size_t tile_rows = DistanceMatrix<data_t>::tileRows(N);
+    size_t count = 0, position = sizeof(DistanceFileHeader);
+    std::vector<data_t> block;
+    uint32_t tile[2];
+    while (position + sizeof(tile) <= file_bytes) {
+      in.read(reinterpret_cast<char *>(tile), sizeof(tile));
+      if (tile[0] > tile[1] || tile[1] >= tile_rows)
+        throw std::runtime_error("ShardFile: " + path.string() + " has a record of a tile out of the matrix.\n");
+
+      const size_t entries = DistanceMatrix<data_t>::tileEntries(N, tile[0], tile[1]);
+      if (position + sizeof(tile) + entries * sizeof(data_t) > file_bytes) break; // Incomplete record of a killed run.
+
+      block.resize(entries);
+      in.read(reinterpret_cast<char *>(block.data()), entries * sizeof(data_t));
+      if (!in) throw std::runtime_error("ShardFile: could not read " + path.string() + ".\n");
+
+      f(size_t(tile[0]), size_t(tile[1]), static_cast<const data_t *>(block.data()), entries);
+      position += sizeof(tile) + entries * sizeof(data_t);
+      count++;
+    }
+
+    if (end) *end = position;
+    return count;
+  }
+
+  /**
+   * @brief Prepares the shard of a matrix before its tiles are computed. Not thread-safe.
+   *
+   * @details With resume, the complete records of a shard of the same size, element type, band, data
+   * hash and configuration are kept and their tiles marked in done. Otherwise, or if there is no such shard, a new
+   * shard without records is written.
+   *
+   * @param done Bitmap of the tiles (see tileIndex), resized to (tiles + 7) / 8 bytes; the bits of kept tiles are set.
+   * @return Number of tiles kept.
+   * @throws std::runtime_error if the file cannot be read or written, or the machine is not little-endian.
+   */
+  size_t start(size_t N, int64_t band, uint64_t data_hash, uint32_t config, bool resume, std::vector<uint8_t> &done)
+  {
+    if (!isLittleEndian())
+      throw std::runtime_error("ShardFile: distance matrix files are little-endian, which this machine is not.\n");
+
+    const size_t tile_rows = DistanceMatrix<data_t>::tileRows(N);
+    done.assign((tile_rows * (tile_rows + 1) / 2 + 7) / 8, 0);
+    saved = 0;
+    stream.close();
+
+    size_t end = 0;
+    const auto keep = [&](size_t ti, size_t tj, const data_t *, size_t) {
+      const size_t t = tileIndex(tile_rows, ti, tj);
+      done[t / 8] |= uint8_t(1 << (t % 8));
+    };
+
+    if (resume)
+      if (const auto loaded = load(file, N, band, data_hash, config, keep, &end)) {
+        std::filesystem::resize_file(file, end); // Drops an incomplete record.
+        stream.open(file, std::ios_base::out | std::ios_base::binary | std::ios_base::app);
+        if (!stream) fail("open");
+        saved = *loaded;
+        return saved;
+      }
+
+    const auto header = makeHeader(N, band, data_hash, config);
+    stream.open(file, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    stream.flush();
+    if (!stream) fail("write");
+    return 0;
+  }
+
+  /**
+   * @brief Appends the record of tile (ti, tj) with its count entries. Thread-safe.
+   * @return Whether the record was written. If writing fails, the file is closed and no more records
+   * are written (see isOpen()).
+   */
+  bool save(size_t ti, size_t tj, const data_t *entries, size_t count)
+  {
+    const uint32_t tile[2] = { static_cast<uint32_t>(ti), static_cast<uint32_t>(tj) };
+    std::lock_guard lock(mutex);
+    if (!stream.is_open()) return false;
+
+    stream.write(reinterpret_cast<const char *>(tile), sizeof(tile));
+    stream.write(reinterpret_cast<const char *>(entries), count * sizeof(data_t));
+    stream.flush(); // Kept if the process is killed.
+    if (!stream) {
+      stream.close();
+      return false;
+    }
+
+    saved++;
+    return true;
+  }
+
+  bool isOpen() const { return stream.is_open(); }           //!< Whether records are written.
+  size_t savedTiles() const { return saved; }                //!< Number of tiles saved or kept.
+  const std::filesystem::path &path() const { return file; } //!< Path of the shard file.
+};
+
+} // namespace dtwc
@@ -0,0 +1,240 @@
+/**
+ * @file TileCheckpoint.hpp
+ * @brief Periodic checkpoints of the completed tiles of a distance matrix being filled.
+ *
+ * @details The checkpoint is a packed binary distance matrix file (see DistanceFile.hpp) followed by
+ * a bitmap with one bit per tile of the DistanceMatrix, set once the tile is complete and saved. While
+ * the matrix is filled, save() writes the tiles which have been completed since the last checkpoint
+ * and then the bitmap, at most every interval seconds. If the run is killed, start() with resume loads
+ * the complete tiles of the checkpoint, so only the others are computed again. Data written by the
+ * program is kept if the process is killed, but not necessarily if the machine fails. Shards of a
+ * matrix computed by several processes (see Problem::shard_count) only hold their tiles, see ShardFile.
+ *
+ * @date 17 Oct 2026
+ * @author Volkan Kumtepeli
+ * @author Becky Perriment
+ */
+
+#pragma once
+
+#include "DistanceCache.hpp" // for DistanceCache
+#include "DistanceFile.hpp"  // for DistanceFileHeader, isLittleEndian
+
+#include <cstddef>    // for size_t
+#include <cstdint>    // for uint8_t, int64_t, uint64_t
+#include <atomic>     // for atomic
+#include <chrono>     // for steady_clock
+#include <cstring>    // for memcmp
+#include <filesystem> // for path, file_size
+#include <fstream>    // for fstream, ifstream, ofstream
+#include <mutex>      // for mutex, unique_lock
+#include <optional>   // for optional, nullopt
+#include <stdexcept>  // for runtime_error
+#include <string>     // for string
+#include <system_error> // for error_code
+#include <utility>    // for move
+#include <vector>     // for vector
+
+namespace dtwc {
+
+template <typename data_t>
+class TileCheckpoint
+{
+  using clock = std::chrono::steady_clock;
+
+  std::filesystem::path file;
+  std::fstream stream;
+  DistanceFileHeader header;
+  std::vector<uint8_t> bitmap; //!< Bit t % 8 of byte t / 8 is set if tile t is saved.
+  size_t saved{ 0 };           //!< Number of saved tiles.
+  double interval;             //!< Minimum seconds between two checkpoints.
+
+  std::mutex mutex;
+  std::atomic<clock::rep> last{ 0 }; //!< Time of the last checkpoint.
+
+  bool isSaved(size_t t) const { return bitmap[t / 8] & (1 << (t % 8)); }
+
+  size_t bitmapOffset() const { return sizeof(DistanceFileHeader) + header.entryBytes(); }
+
+  [[noreturn]] void fail(const std::string &what) const
+  {
+    throw std::runtime_error("TileCheckpoint: could not " + what + " " + file.string() + ".\n");
+  }
+
+  static DistanceFileHeader makeHeader(size_t N, int64_t band, uint64_t data_hash, uint32_t config)
+  {
+    DistanceFileHeader h;
+    h.element_bytes = sizeof(data_t);
+    h.N = N;
+    h.band = band;
+    h.data_hash = data_hash;
+    h.config = config;
+    h.layout = static_cast<uint32_t>(MatrixLayout::Packed);
+    h.tile = DistanceMatrix<data_t>::tile;
+    h.flags = DistanceFileHeader::has_tile_bitmap;
+    h.seal();
+    return h;
+  }
+
+public:
+  /**
+   * @param path Path of the checkpoint file.
+   * @param interval_seconds Minimum time between two checkpoints.
+   */
+  TileCheckpoint(std::filesystem::path path, double interval_seconds) : file{ std::move(path) }, interval{ interval_seconds } {}
+
+  /**
+   * @brief Loads the complete tiles of the checkpoint at path into cache, without modifying the file. Not thread-safe.
+   *
+   * @param path Path of the checkpoint, e.g., written by Problem::fillDistanceMatrix.
+   * @param band Band the distances must have been computed with.
+   * @param data_hash Hash of the data (Data::hash) the distances must have been computed for.
+   * @param config Configuration (Problem::distanceConfig) the distances must have been computed with.
+   * @param loaded Bitmap of the tiles, (tiles() + 7) / 8 bytes; the bits of loaded tiles are set, the others kept.
+   * @return Number of tiles loaded; nothing if path is not a checkpoint of a matrix of the size of cache,
+   * element type data_t, band, data hash and configuration.
+   * @throws std::runtime_error if the checkpoint cannot be read.
+   */
+  static std::optional<size_t> load(const std::filesystem::path &path, DistanceCache<data_t> &cache, int64_t band,
+                                    uint64_t data_hash, uint32_t config, std::vector<uint8_t> &loaded)
+  {
+    const auto &matrix = cache.matrix();
+    const auto expected = makeHeader(matrix.size(), band, data_hash, config);
+    const size_t bitmap_offset = sizeof(DistanceFileHeader) + expected.entryBytes(), bitmap_bytes = (matrix.tiles() + 7) / 8;
+
+    std::error_code ec;
+    if (std::filesystem::file_size(path, ec) != bitmap_offset + bitmap_bytes || ec) return std::nullopt;
+
+    std::ifstream in(path, std::ios_base::binary);
+    DistanceFileHeader existing;
+    in.read(reinterpret_cast<char *>(&existing), sizeof(existing));
+    if (!in || std::memcmp(&existing, &expected, sizeof(expected)) != 0) return std::nullopt;
+
+    std::vector<uint8_t> bits(bitmap_bytes);
+    in.seekg(bitmap_offset);
+    in.read(reinterpret_cast<char *>(bits.data()), bits.size());
+
+    size_t count = 0;
+    std::vector<data_t> block;
+    for (size_t ti = 0, t = 0; ti < matrix.tileRows(); ti++)
+      for (size_t tj = ti; tj < matrix.tileRows(); tj++, t++)
+        if (bits[t / 8] & (1 << (t % 8))) {
+          const auto [offset, entries] = matrix.tileBlock(ti, tj);
+          block.resize(entries);
+          in.seekg(sizeof(DistanceFileHeader) + offset * sizeof(data_t));
+          in.read(reinterpret_cast<char *>(block.data()), entries * sizeof(data_t));
+          for (size_t k = 0; k < entries; k++)
+            cache.setAt(offset + k, block[k]);
+          loaded[t / 8] |= uint8_t(1 << (t % 8));
+          count++;
+        }
+
+    if (!in) throw std::runtime_error("TileCheckpoint: could not read " + path.string() + ".\n");
+    return count;
+  }
+
+  /**
+   * @brief Prepares the checkpoint of a matrix before it is filled. Not thread-safe.
+   *
+   * @details With resume, the complete tiles of a checkpoint of the same size, element type, band,
+   * data hash and configuration are loaded into cache (see load()). Otherwise, or if there is no such checkpoint,
+   * a new one is written with the entries of cache computed so far.
+   *
+   * @return Number of tiles loaded.
+   * @throws std::runtime_error if the file cannot be read or written, or the machine is not little-endian.
+   */
+  size_t start(DistanceCache<data_t> &cache, int64_t band, uint64_t data_hash, uint32_t config, bool resume)
+  {
+    if (!isLittleEndian())
+      throw std::runtime_error("TileCheckpoint: distance matrix files are little-endian, which this machine is not.\n");
+
+    const auto &matrix = cache.matrix();
+    header = makeHeader(matrix.size(), band, data_hash, config);
+    bitmap.assign((matrix.tiles() + 7) / 8, 0);
+    saved = 0;
+    last = clock::now().time_since_epoch().count();
+
+    stream.close();
+    if (resume)
+      if (const auto loaded = load(file, cache, band, data_hash, config, bitmap)) {
+        stream.open(file, std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+        if (!stream) fail("open");
+        saved = *loaded;
+        return saved;
+      }
+
+    { // New checkpoint, which is also a valid binary distance matrix file.
+      std::ofstream out(file, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+      out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+      out.write(reinterpret_cast<const char *>(matrix.data()), header.entryBytes());
+      out.write(reinterpret_cast<const char *>(bitmap.data()), bitmap.size());
+      if (!out) fail("write");
+    }
+
+    stream.open(file, std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+    if (!stream) fail("open");
+    return 0;
+  }
+
+  /**
+   * @brief Saves the tiles of cache completed since the last checkpoint, if interval seconds have passed. Thread-safe.
+   * @details Returns at once if another thread is saving. Entries are only read once they are ready.
+   * @param force Saves regardless of the time since the last checkpoint, and waits for another thread saving.
+   * @return Whether a checkpoint was written. If writing fails, the file is closed and no more checkpoints
+   * are written (see isOpen()), so that the computation goes on.
+   */
+  bool save(const DistanceCache<data_t> &cache, bool force = false)
+  {
+    const auto now = clock::now();
+    if (!force && std::chrono::duration<double>(now - clock::time_point(clock::duration(last.load()))).count() < interval)
+      return false;
+
+    std::unique_lock lock(mutex, std::defer_lock);
+    if (force)
+      lock.lock();
+    else if (!lock.try_lock())
+      return false;
+
+    if (!stream.is_open()) return false;
+
+    const auto &matrix = cache.matrix();
+    bool added = false;
+    for (size_t ti = 0, t = 0; ti < matrix.tileRows(); ti++)
+      for (size_t tj = ti; tj < matrix.tileRows(); tj++, t++) {
+        if (isSaved(t)) continue;
+
+        const auto [offset, count] = matrix.tileBlock(ti, tj);
+        bool complete = true;
+        for (size_t k = 0; k < count && complete; k++)
+          complete = cache.isReadyAt(offset + k);
+
+        if (!complete) continue;
+
+        stream.seekp(sizeof(DistanceFileHeader) + offset * sizeof(data_t));
+        stream.write(reinterpret_cast<const char *>(matrix.data() + offset), count * sizeof(data_t));
+        bitmap[t / 8] |= uint8_t(1 << (t % 8));
+        saved++;
+        added = true;
+      }
+
+    if (added) { // The bitmap only after its tiles.
+      stream.flush();
+      stream.seekp(bitmapOffset());
+      stream.write(reinterpret_cast<const char *>(bitmap.data()), bitmap.size());
+      stream.flush();
+      if (!stream) {
+        stream.close();
+        return false;
+      }
+    }
+
+    last = clock::now().time_since_epoch().count();
+    return added;
+  }
+
+  bool isOpen() const { return stream.is_open(); }           //!< Whether checkpoints are written.
+  size_t savedTiles() const { return saved; }                //!< Number of tiles saved or loaded.
+  const std::filesystem::path &path() const { return file; } //!< Path of the checkpoint file.
+};
+
+} // namespace dtwc
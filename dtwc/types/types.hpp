@@ -9,4 +9,10 @@
 #pragma once
 
 #include "Range.hpp"
-#include "element_types.hpp"
\ No newline at end of file
+#include "element_types.hpp"
+#include "DistanceMatrix.hpp"
+#include "DistanceCache.hpp"
+#include "MappedFile.hpp"
+#include "DistanceFile.hpp"
+#include "TileCheckpoint.hpp"
+#include "ShardFile.hpp"
\ No newline at end of file
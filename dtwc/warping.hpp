@@ -13,6 +13,10 @@
 
 #pragma once
 
+#include "settings.hpp"      // for DEFAULT_BAND_LENGTH
+#include "costs.hpp"         // for cost::L1
+#include "warping_fixed.hpp" // for fixedKernel
+
 #include <cstdlib>   // for abs, size_t
 #include <algorithm> // for min, max
 #include <cmath>     // for floor, round
@@ -24,18 +28,93 @@
 
 namespace dtwc {
 
+/**
+ * @brief Scratch memory of the DTW kernels.
+ *
+ * @details Allocate one workspace per worker thread, pre-size it with reserve() for the
+ * longest series and pass it to the kernels, so that they do not allocate. Buffers only grow;
+ * release() frees them. A workspace must not be used by two threads at the same time.
+ * Overloads without a workspace use threadWorkspace().
+ *
+ * @tparam data_t Data type of the elements in the sequences.
+ * @tparam acc_t Data type of the accumulated costs, int32_t for the quantised kernels (see QuantisedWorkspace).
+ */
+template <typename data_t, typename acc_t = data_t>
+struct DtwWorkspace
+{
+  std::vector<acc_t> prev, curr, next; //!< Rows, columns or anti-diagonals of the cost matrix.
+  std::vector<data_t> series;          //!< Rearranged sequence: reversed (dtwWavefront), interleaved candidates (dtwBatch) or projection (lbImproved).
+  std::vector<int> lo, hi;             //!< Band of each row or column (dtwWavefront, dtwBatch and the quantised kernels), or envelope candidates (lbImproved).
+  std::vector<data_t> upper, lower;    //!< Envelope of the projection (lbImproved).
+  arma::Mat<acc_t> C;                  //!< Full cost matrix of dtwFull.
+
+  DtwWorkspace() = default;
+  explicit DtwWorkspace(size_t max_length) { reserve(max_length); } //!< See reserve.
+
+  /**
+   * @brief Reserves the buffers of the single-pair kernels for sequences of up to max_length elements.
+   * @details The full matrix of dtwFull is not reserved as it needs max_length^2 elements, nor
+   * are the buffers of dtwBatch, which need one copy per SIMD lane.
+   */
+  void reserve(size_t max_length)
+  {
+    for (auto *v : { &prev, &curr, &next })
+      v->reserve(max_length + 1);
+    for (auto *v : { &series, &upper, &lower })
+      v->reserve(max_length);
+    lo.reserve(max_length);
+    hi.reserve(max_length);
+  }
+
+  /**
+   * @brief Frees all memory of the workspace.
+   */
+  void release()
+  {
+    for (auto *v : { &prev, &curr, &next })
+      std::vector<acc_t>().swap(*v);
+    for (auto *v : { &series, &upper, &lower })
+      std::vector<data_t>().swap(*v);
+    std::vector<int>().swap(lo);
+    std::vector<int>().swap(hi);
+    C.reset();
+  }
+
+  /**
+   * @brief Allocated memory.
+   */
+  size_t bytes() const
+  {
+    return (prev.capacity() + curr.capacity() + next.capacity() + C.n_elem) * sizeof(acc_t)
+           + (series.capacity() + upper.capacity() + lower.capacity()) * sizeof(data_t) + (lo.capacity() + hi.capacity()) * sizeof(int);
+  }
+};
+
+/**
+ * @brief Workspace of the calling thread, used by the kernel overloads without a workspace argument.
+ * @details E.g., call threadWorkspace<data_t>().release() in a long-running thread after a batch of large series.
+ */
+template <typename data_t, typename acc_t = data_t>
+DtwWorkspace<data_t, acc_t> &threadWorkspace()
+{
+  thread_local DtwWorkspace<data_t, acc_t> workspace;
+  return workspace;
+}
+
 /**
  * @brief Computes the full dynamic time warping distance between two sequences.
  *
  * @tparam data_t Data type of the elements in the sequences.
+ * @tparam Tcost Pointwise cost policy, see costs.hpp.
  * @param x First sequence.
  * @param y Second sequence.
+ * @param workspace Scratch memory, see DtwWorkspace.
  * @return The dynamic time warping distance.
  */
-template <typename data_t>
-data_t dtwFull(const std::vector<data_t> &x, const std::vector<data_t> &y)
+template <typename data_t, typename Tcost = cost::L1>
+data_t dtwFull(const std::vector<data_t> &x, const std::vector<data_t> &y, DtwWorkspace<data_t> &workspace)
 {
-  thread_local arma::Mat<data_t> C;
+  auto &C = workspace.C;
   constexpr data_t maxValue = std::numeric_limits<data_t>::max();
 
   if (&x == &y) return 0; // If they are the same data then distance is 0.
@@ -43,9 +122,9 @@ data_t dtwFull(const std::vector<data_t> &x, const std::vector<data_t> &y)
   const int mx = x.size();
   const int my = y.size();
 
-  C.resize(mx, my);
+  C.set_size(mx, my); // All cells are overwritten.
 
-  auto distance = [](data_t x, data_t y) { return std::abs(x - y); };
+  const Tcost distance{};
 
   if ((mx == 0) || (my == 0)) return maxValue;
 
@@ -68,6 +147,15 @@ data_t dtwFull(const std::vector<data_t> &x, const std::vector<data_t> &y)
   return C(mx - 1, my - 1);
 }
 
+/**
+ * @brief Computes the full dynamic time warping distance between two sequences, see above.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+data_t dtwFull(const std::vector<data_t> &x, const std::vector<data_t> &y)
+{
+  return dtwFull<data_t, Tcost>(x, y, threadWorkspace<data_t>());
+}
+
 /**
  * @brief Computes the dynamic time warping distance using the light method.
  *
@@ -75,40 +163,42 @@ data_t dtwFull(const std::vector<data_t> &x, const std::vector<data_t> &y)
  * It only uses one vector to traverse instead of matrices.
  *
  * @tparam data_t Data type of the elements in the sequences.
+ * @tparam Tcost Pointwise cost policy, see costs.hpp.
  * @param x First sequence.
  * @param y Second sequence.
+ * @param workspace Scratch memory, see DtwWorkspace.
  * @return The dynamic time warping distance.
  */
-template <typename data_t>
-data_t dtwFull_L(const std::vector<data_t> &x, const std::vector<data_t> &y)
+template <typename data_t, typename Tcost = cost::L1>
+data_t dtwFull_L(const std::vector<data_t> &x, const std::vector<data_t> &y, DtwWorkspace<data_t> &workspace)
 {
   if (&x == &y) return 0; // If they are the same data then distance is 0.
+  if (const auto kernel = fixedKernel<data_t, Tcost>(x.size(), y.size())) return kernel(x.data(), y.data()); //<! Short series of common lengths.
+  if (x.size() < y.size()) return dtwFull_L<data_t, detail::swapped_t<Tcost>>(y, x, workspace);            //<! So that x is the long side.
   constexpr data_t maxValue = std::numeric_limits<data_t>::max();
-  thread_local static std::vector<data_t> short_side(10000);
+  auto &short_side = workspace.prev;
 
-  const auto &[short_vec, long_vec] = (x.size() < y.size()) ? std::tie(x, y) : std::tie(y, x);
+  const auto &short_vec = y, &long_vec = x;
   const auto m_short{ short_vec.size() }, m_long{ long_vec.size() };
 
   short_side.resize(m_short);
 
-  auto distance = [](data_t x, data_t y) { return std::abs(x - y); };
+  const Tcost distance{};
 
   if ((m_short == 0) || (m_long == 0)) return maxValue;
 
-  short_side[0] = distance(short_vec[0], long_vec[0]);
+  short_side[0] = distance(long_vec[0], short_vec[0]);
 
   for (size_t i = 1; i < m_short; i++)
-    short_side[i] = short_side[i - 1] + distance(short_vec[i], long_vec[0]);
+    short_side[i] = short_side[i - 1] + distance(long_vec[0], short_vec[i]);
 
   for (size_t j = 1; j < m_long; j++) {
     auto diag = short_side[0];
-    short_side[0] += distance(short_vec[0], long_vec[j]);
+    short_side[0] += distance(long_vec[j], short_vec[0]);
 
     for (size_t i = 1; i < m_short; i++) {
       const data_t min1 = std::min(short_side[i - 1], short_side[i]);
-      const auto shr = short_vec.at(i);
-      const auto lng = long_vec.at(j);
-      const data_t dist = std::abs(shr - lng);
+      const data_t dist = distance(long_vec[j], short_vec[i]);
       const data_t next = std::min(diag, min1) + dist;
 
       diag = short_side[i];
@@ -119,6 +209,120 @@ data_t dtwFull_L(const std::vector<data_t> &x, const std::vector<data_t> &y)
   return short_side.back();
 }
 
+/**
+ * @brief Computes the dynamic time warping distance using the light method, see above.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+data_t dtwFull_L(const std::vector<data_t> &x, const std::vector<data_t> &y)
+{
+  return dtwFull_L<data_t, Tcost>(x, y, threadWorkspace<data_t>());
+}
+
+/**
+ * @brief Result of an early-abandoning dynamic time warping computation.
+ *
+ * @tparam data_t Data type of the distance.
+ */
+template <typename data_t>
+struct DtwResult
+{
+  data_t distance{ 0 }; //!< The distance if is_exact, otherwise a lower bound of it which is larger than best_so_far.
+  bool is_exact{ true }; //!< False if the computation was abandoned early.
+};
+
+/**
+ * @brief Early-abandoning version of dtwFull_L.
+ *
+ * @details Every warping path visits every row of the cost matrix, so once all cells of the
+ * current row exceed best_so_far, the distance cannot be smaller than best_so_far and the
+ * computation is abandoned. The smallest cell of that row is returned as a lower bound.
+ *
+ * @tparam data_t Data type of the elements in the sequences.
+ * @tparam Tcost Pointwise cost policy, see costs.hpp.
+ * @param x First sequence.
+ * @param y Second sequence.
+ * @param best_so_far Upper bound of interest, e.g., the distance to the best candidate so far.
+ * @param workspace Scratch memory, see DtwWorkspace.
+ * @return The exact distance, or a lower bound larger than best_so_far with is_exact = false.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+DtwResult<data_t> dtwFull_L(const std::vector<data_t> &x, const std::vector<data_t> &y, data_t best_so_far, DtwWorkspace<data_t> &workspace)
+{
+  if (&x == &y) return { 0, true }; // If they are the same data then distance is 0.
+  if (x.size() < y.size()) return dtwFull_L<data_t, detail::swapped_t<Tcost>>(y, x, best_so_far, workspace); //<! So that x is the long side.
+  constexpr data_t maxValue = std::numeric_limits<data_t>::max();
+  auto &short_side = workspace.prev;
+
+  const auto &short_vec = y, &long_vec = x;
+  const auto m_short{ short_vec.size() }, m_long{ long_vec.size() };
+
+  short_side.resize(m_short);
+
+  const Tcost distance{};
+
+  if ((m_short == 0) || (m_long == 0)) return { maxValue, true };
+
+  short_side[0] = distance(long_vec[0], short_vec[0]);
+
+  for (size_t i = 1; i < m_short; i++)
+    short_side[i] = short_side[i - 1] + distance(long_vec[0], short_vec[i]);
+
+  data_t row_min = short_side[0]; // First row is increasing.
+
+  for (size_t j = 1; j < m_long; j++) {
+    if (row_min > best_so_far) return { row_min, false };
+
+    auto diag = short_side[0];
+    short_side[0] += distance(long_vec[j], short_vec[0]);
+    row_min = short_side[0];
+
+    for (size_t i = 1; i < m_short; i++) {
+      const data_t min1 = std::min(short_side[i - 1], short_side[i]);
+      const data_t next = std::min(diag, min1) + distance(long_vec[j], short_vec[i]);
+
+      diag = short_side[i];
+      short_side[i] = next;
+      row_min = std::min(row_min, next);
+    }
+  }
+
+  return { short_side.back(), true };
+}
+
+/**
+ * @brief Early-abandoning version of dtwFull_L, see above.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+DtwResult<data_t> dtwFull_L(const std::vector<data_t> &x, const std::vector<data_t> &y, data_t best_so_far)
+{
+  return dtwFull_L<data_t, Tcost>(x, y, best_so_far, threadWorkspace<data_t>());
+}
+
+
+/**
+ * @brief Creates the Sakoe-Chiba band used by banded kernels.
+ *
+ * @details The band is skewed along the line joining the first and last cells, so it also
+ * works for sequences of different lengths. The returned function maps a column of the short
+ * side to the half-open range [low, high) of allowed cells on the long side, clipped to [0, m_long).
+ *
+ * @param m_long Length of the long sequence.
+ * @param m_short Length of the short sequence (should be at least 2).
+ * @param band The bandwidth parameter that controls the vicinity around the diagonal.
+ * @return Function int -> std::pair<int, int> giving the bounds of a column.
+ */
+inline auto sakoeChibaBounds(int m_long, int m_short, int band)
+{
+  const double slope = static_cast<double>(m_long - 1) / (m_short - 1);
+  const auto window = std::max((double)band, slope / 2);
+
+  return [slope, window, m_long](int x) {
+    const auto y = slope * x;
+    const int low = std::ceil(std::round(100 * (y - window)) / 100.0);
+    const int high = std::floor(std::round(100 * (y + window)) / 100.0) + 1;
+    return std::pair(std::max(low, 0), std::min(high, m_long));
+  };
+}
 
 /**
  * @brief Computes the banded dynamic time warping distance between two sequences.
@@ -135,64 +339,158 @@ data_t dtwFull_L(const std::vector<data_t> &x, const std::vector<data_t> &y)
  * See https://pyts.readthedocs.io/en/stable/auto_examples/metrics/plot_sakoe_chiba.html
  * for a detailed explanation.
  *
+ * Only two columns of the band are stored, so memory and initialisation cost scale with
+ * the band width instead of the full m_long x m_short matrix.
+ *
  * @tparam data_t Data type of the elements in the sequences.
+ * @tparam Tcost Pointwise cost policy, see costs.hpp.
  * @param x First sequence.
  * @param y Second sequence.
  * @param band The bandwidth parameter that controls the vicinity around the diagonal.
+ * @param workspace Scratch memory, see DtwWorkspace.
  * @return The dynamic time warping distance.
  */
-template <typename data_t = float>
-data_t dtwBanded(const std::vector<data_t> &x, const std::vector<data_t> &y, int band = settings::DEFAULT_BAND_LENGTH)
+template <typename data_t = float, typename Tcost = cost::L1>
+data_t dtwBanded(const std::vector<data_t> &x, const std::vector<data_t> &y, int band, DtwWorkspace<data_t> &workspace)
 {
-  if (band < 0) return dtwFull_L<data_t>(x, y); //<! Band is negative, so returning full dtw.
+  if (band < 0) return dtwFull_L<data_t, Tcost>(x, y, workspace);                       //<! Band is negative, so returning full dtw.
+  if (x.size() < y.size()) return dtwBanded<data_t, detail::swapped_t<Tcost>>(y, x, band, workspace); //<! So that x is the long side.
 
-  thread_local arma::Mat<data_t> C;
   constexpr data_t maxValue = std::numeric_limits<data_t>::max();
 
-  const auto &[short_vec, long_vec] = (x.size() < y.size()) ? std::tie(x, y) : std::tie(y, x);
+  const auto &short_vec = y, &long_vec = x;
   const int m_short(short_vec.size()), m_long(long_vec.size());
 
-  C.resize(m_long, m_short);
-  C.fill(maxValue);
-
-  auto distance = [](data_t xi, data_t yi) { return std::abs(xi - yi); };
+  const Tcost distance{};
 
   if ((m_short == 0) || (m_long == 0)) return maxValue;
-  if ((m_short == 1) || (m_long == 1)) return dtwFull_L<data_t>(x, y); //<! Band is meaningless when one length is one, so return full DTW
-  if (m_long <= (band + 1)) return dtwFull_L<data_t>(x, y);            //<! Band is bigger than long side so full DTW can be done.
+  if ((m_short == 1) || (m_long == 1)) return dtwFull_L<data_t, Tcost>(x, y, workspace); //<! Band is meaningless when one length is one, so return full DTW
+  if (m_long <= (band + 1)) return dtwFull_L<data_t, Tcost>(x, y, workspace);            //<! Band is bigger than long side so full DTW can be done.
 
 
-  const double slope = static_cast<double>(m_long - 1) / (m_short - 1);
-  const auto window = std::max((double)band, slope / 2);
+  const auto get_bounds = sakoeChibaBounds(m_long, m_short, band);
 
-  auto get_bounds = [slope, window](int x) {
-    const auto y = slope * x;
-    const int low = std::ceil(std::round(100 * (y - window)) / 100.0);
-    const int high = std::floor(std::round(100 * (y + window)) / 100.0) + 1;
-    return std::pair(low, high);
-  };
+  // Only two columns of the band are kept. Column j holds the cells [lo, hi) of
+  // the long side at positions [0, hi - lo); cells outside the band are maxValue.
+  auto &col_prev = workspace.prev, &col_curr = workspace.curr;
+
+  auto [lo_prev, hi_prev] = get_bounds(0);
+  col_prev.resize(hi_prev - lo_prev);
 
-  C(0, 0) = distance(long_vec[0], short_vec[0]);
+  col_prev[0] = distance(long_vec[0], short_vec[0]);
+  for (int i = 1; i < hi_prev; ++i)
+    col_prev[i] = col_prev[i - 1] + distance(long_vec[i], short_vec[0]);
 
+  for (int j = 1; j < m_short; j++) //<! Scan the short part!
   {
-    const auto [lo, hi] = get_bounds(0);
-    for (int i = 1; i < hi; ++i)
-      C(i, 0) = C(i - 1, 0) + distance(long_vec[i], short_vec[0]);
+    const auto [lo, hi] = get_bounds(j);
+    col_curr.resize(hi - lo);
+
+    auto prev = [&, lo_prev = lo_prev, hi_prev = hi_prev](int i) {
+      return (lo_prev <= i && i < hi_prev) ? col_prev[i - lo_prev] : maxValue;
+    };
+
+    data_t up = maxValue; // C(i - 1, j)
+    for (int i = lo; i < hi; ++i) {
+      const auto minimum = (i == 0) ? prev(0) : std::min({ up, prev(i), prev(i - 1) });
+      up = col_curr[i - lo] = minimum + distance(long_vec[i], short_vec[j]);
+    }
+
+    std::swap(col_prev, col_curr);
+    lo_prev = lo;
+    hi_prev = hi;
   }
 
+  return col_prev.back();
+}
+
+/**
+ * @brief Computes the banded dynamic time warping distance between two sequences, see above.
+ */
+template <typename data_t = float, typename Tcost = cost::L1>
+data_t dtwBanded(const std::vector<data_t> &x, const std::vector<data_t> &y, int band = settings::DEFAULT_BAND_LENGTH)
+{
+  return dtwBanded<data_t, Tcost>(x, y, band, threadWorkspace<data_t>());
+}
+
+/**
+ * @brief Early-abandoning version of dtwBanded.
+ *
+ * @details Every warping path visits every column of the band, so once all cells of the
+ * current column exceed best_so_far, the computation is abandoned.
+ *
+ * @tparam data_t Data type of the elements in the sequences.
+ * @tparam Tcost Pointwise cost policy, see costs.hpp.
+ * @param x First sequence.
+ * @param y Second sequence.
+ * @param band The bandwidth parameter that controls the vicinity around the diagonal, -1 for full DTW.
+ * @param best_so_far Upper bound of interest, e.g., the distance to the best candidate so far.
+ * @param workspace Scratch memory, see DtwWorkspace.
+ * @return The exact distance, or a lower bound larger than best_so_far with is_exact = false.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+DtwResult<data_t> dtwBanded(const std::vector<data_t> &x, const std::vector<data_t> &y, int band, data_t best_so_far, DtwWorkspace<data_t> &workspace)
+{
+  if (band < 0) return dtwFull_L<data_t, Tcost>(x, y, best_so_far, workspace);                                    //<! Band is negative, so returning full dtw.
+  if (x.size() < y.size()) return dtwBanded<data_t, detail::swapped_t<Tcost>>(y, x, band, best_so_far, workspace); //<! So that x is the long side.
+
+  constexpr data_t maxValue = std::numeric_limits<data_t>::max();
+
+  const auto &short_vec = y, &long_vec = x;
+  const int m_short(short_vec.size()), m_long(long_vec.size());
+
+  const Tcost distance{};
+
+  if ((m_short == 0) || (m_long == 0)) return { maxValue, true };
+  if ((m_short == 1) || (m_long == 1)) return dtwFull_L<data_t, Tcost>(x, y, best_so_far, workspace); //<! Band is meaningless when one length is one, so return full DTW
+  if (m_long <= (band + 1)) return dtwFull_L<data_t, Tcost>(x, y, best_so_far, workspace);            //<! Band is bigger than long side so full DTW can be done.
+
+  const auto get_bounds = sakoeChibaBounds(m_long, m_short, band);
+
+  auto &col_prev = workspace.prev, &col_curr = workspace.curr;
+
+  auto [lo_prev, hi_prev] = get_bounds(0);
+  col_prev.resize(hi_prev - lo_prev);
+
+  col_prev[0] = distance(long_vec[0], short_vec[0]);
+  for (int i = 1; i < hi_prev; ++i)
+    col_prev[i] = col_prev[i - 1] + distance(long_vec[i], short_vec[0]);
+
+  data_t col_min = col_prev[0]; // First column is increasing.
+
   for (int j = 1; j < m_short; j++) //<! Scan the short part!
   {
-    const auto [lo, hi] = get_bounds(j);
-    if (lo <= 0)
-      C(0, j) = C(0, j - 1) + distance(long_vec[0], short_vec[j]);
+    if (col_min > best_so_far) return { col_min, false };
 
-    const auto high = std::min(hi, m_long);
-    for (int i = std::max(lo, 1); i < high; ++i) {
-      const auto minimum = std::min({ C(i - 1, j), C(i, j - 1), C(i - 1, j - 1) });
-      C(i, j) = minimum + distance(long_vec[i], short_vec[j]);
+    const auto [lo, hi] = get_bounds(j);
+    col_curr.resize(hi - lo);
+
+    auto prev = [&, lo_prev = lo_prev, hi_prev = hi_prev](int i) {
+      return (lo_prev <= i && i < hi_prev) ? col_prev[i - lo_prev] : maxValue;
+    };
+
+    data_t up = maxValue; // C(i - 1, j)
+    col_min = maxValue;
+    for (int i = lo; i < hi; ++i) {
+      const auto minimum = (i == 0) ? prev(0) : std::min({ up, prev(i), prev(i - 1) });
+      up = col_curr[i - lo] = minimum + distance(long_vec[i], short_vec[j]);
+      col_min = std::min(col_min, up);
     }
+
+    std::swap(col_prev, col_curr);
+    lo_prev = lo;
+    hi_prev = hi;
   }
 
-  return C(m_long - 1, m_short - 1);
+  return { col_prev.back(), true };
+}
+
+/**
+ * @brief Early-abandoning version of dtwBanded, see above.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+DtwResult<data_t> dtwBanded(const std::vector<data_t> &x, const std::vector<data_t> &y, int band, data_t best_so_far)
+{
+  return dtwBanded<data_t, Tcost>(x, y, band, best_so_far, threadWorkspace<data_t>());
 }
 } // namespace dtwc
\ No newline at end of file
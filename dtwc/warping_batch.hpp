@@ -0,0 +1,266 @@
+/**
+ * @file warping_batch.hpp
+ * @brief Inter-pair SIMD dynamic time warping: several DTW distances per call.
+ *
+ * @details When the candidates of a query all have the same length, every candidate has the
+ * same cost-matrix shape (and the same band), so the ordinary row-by-row recurrence of
+ * dtwFull_L can run for several pairs at once, one pair per SIMD lane, without any shuffles.
+ * Candidates are interleaved so that lane l of cell c is at index c * L + l.
+ *
+ * The kernel is compiled for several instruction sets and the one supported by the CPU is
+ * picked at runtime (see simd/cpu_dispatch.hpp). Results are identical to dtwBanded.
+ *
+ * @date 17 Oct 2026
+ * @author Volkan Kumtepeli
+ * @author Becky Perriment
+ */
+
+#pragma once
+
+#include "settings.hpp"          // for DEFAULT_BAND_LENGTH
+#include "warping.hpp"           // for sakoeChibaBounds, DtwWorkspace
+#include "costs.hpp"             // for cost::L1
+#include "simd/cpu_dispatch.hpp" // for simd::level, DTWC_TARGET_*
+
+#include <cstddef>   // for size_t
+#include <algorithm> // for min, max, fill
+#include <cmath>     // for abs
+#include <limits>    // for numeric_limits
+#include <stdexcept> // for runtime_error
+#include <tuple>     // for tie
+#include <vector>    // for vector
+
+namespace dtwc {
+
+namespace detail {
+
+  /**
+   * @brief Lane-wise DTW recurrence for L candidates of length m against a query of length n.
+   *
+   * @param query Query sequence of length n.
+   * @param cand Interleaved candidates, cand[c * L + l] is element c of candidate l.
+   * @param lo, hi Allowed range [lo[q], hi[q]) of candidate indices for each query index, non-decreasing.
+   * @param row0, row1 Scratch rows of (m + 1) * L elements.
+   * @param out Output distances, L elements.
+   */
+  template <typename data_t, int L, typename Tcost>
+  DTWC_ALWAYS_INLINE void dtwBatchLanes(const data_t *query, int n, const data_t *cand, int m,
+                                        const int *lo, const int *hi, data_t *row0, data_t *row1, data_t *out)
+  {
+    constexpr data_t maxValue = std::numeric_limits<data_t>::max();
+
+    // Rows are indexed by the candidate index + 1, so that slot 0 (index -1) reads as maxValue.
+    std::fill(row0, row0 + (m + 1) * L, maxValue);
+    std::fill(row1, row1 + (m + 1) * L, maxValue);
+
+    data_t *prev = row0, *curr = row1;
+    std::fill(prev, prev + L, data_t(0)); // Virtual C(-1, -1) = 0 so that C(0, 0) = dist(0, 0).
+
+    int lo_old{ 0 }; // Lower bound of the row which is being overwritten.
+    for (int q = 0; q < n; q++) {
+      std::fill(curr + (lo_old + 1) * L, curr + (std::max(lo[q], lo_old) + 1) * L, maxValue);
+      const data_t qv = query[q];
+
+      for (int c = lo[q]; c < hi[q]; c++) {
+        const data_t *up = prev + (c + 1) * L, *diag = prev + c * L, *left = curr + c * L, *cv = cand + c * L;
+        data_t *cell = curr + (c + 1) * L;
+
+#pragma omp simd
+        for (int l = 0; l < L; l++)
+          cell[l] = std::min(std::min(up[l], diag[l]), left[l]) + Tcost{}(qv, cv[l]);
+      }
+
+      if (q == 0) std::fill(prev, prev + L, maxValue);
+      lo_old = (q == 0) ? 0 : lo[q - 1];
+      std::swap(prev, curr);
+    }
+
+    std::copy(prev + m * L, prev + (m + 1) * L, out);
+  }
+
+#if DTWC_X86_DISPATCH
+  template <typename data_t, int L, typename Tcost>
+  DTWC_TARGET_SSE42 void dtwBatchLanes_sse42(const data_t *query, int n, const data_t *cand, int m, const int *lo, const int *hi, data_t *row0, data_t *row1, data_t *out)
+  {
+    dtwBatchLanes<data_t, L, Tcost>(query, n, cand, m, lo, hi, row0, row1, out);
+  }
+
+  template <typename data_t, int L, typename Tcost>
+  DTWC_TARGET_AVX2 void dtwBatchLanes_avx2(const data_t *query, int n, const data_t *cand, int m, const int *lo, const int *hi, data_t *row0, data_t *row1, data_t *out)
+  {
+    dtwBatchLanes<data_t, L, Tcost>(query, n, cand, m, lo, hi, row0, row1, out);
+  }
+
+  template <typename data_t, int L, typename Tcost>
+  DTWC_TARGET_AVX512 void dtwBatchLanes_avx512(const data_t *query, int n, const data_t *cand, int m, const int *lo, const int *hi, data_t *row0, data_t *row1, data_t *out)
+  {
+    dtwBatchLanes<data_t, L, Tcost>(query, n, cand, m, lo, hi, row0, row1, out);
+  }
+#endif
+
+  template <typename data_t, int L, typename Tcost>
+  void dtwBatchLanes_generic(const data_t *query, int n, const data_t *cand, int m, const int *lo, const int *hi, data_t *row0, data_t *row1, data_t *out)
+  {
+    dtwBatchLanes<data_t, L, Tcost>(query, n, cand, m, lo, hi, row0, row1, out);
+  }
+
+  /**
+   * @brief Allowed range [lo[q], hi[q]) of candidate indices for each query index, same band as dtwBanded.
+   * @param n Length of the query.
+   * @param m Length of the candidates.
+   * @param band The bandwidth parameter, -1 for full DTW.
+   */
+  inline void batchBounds(int n, int m, int band, std::vector<int> &lo, std::vector<int> &hi)
+  {
+    lo.assign(n, 0);
+    hi.assign(n, m);
+
+    const int m_long = std::max(n, m), m_short = std::min(n, m);
+    if (band < 0 || m_short <= 1 || m_long <= (band + 1)) return; // Full DTW.
+
+    const auto get_bounds = sakoeChibaBounds(m_long, m_short, band);
+    if (n < m) // Query is the short side, so bounds are already per query index.
+      for (int q = 0; q < n; q++)
+        std::tie(lo[q], hi[q]) = get_bounds(q);
+    else { // Candidates are the short side; transpose the bounds. dtwBanded uses the second argument for ties.
+      std::fill(lo.begin(), lo.end(), m);
+      std::fill(hi.begin(), hi.end(), 0);
+      for (int c = 0; c < m; c++) {
+        const auto [low, high] = get_bounds(c);
+        for (int q = low; q < high; q++) {
+          lo[q] = std::min(lo[q], c);
+          hi[q] = std::max(hi[q], c + 1);
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Runs the batch kernel with L lanes over all candidates, padding the last group.
+   * @tparam acc_t Data type of the accumulated costs (differs from data_t for quantised kernels).
+   * @param workspace Scratch memory with the bounds of batchBounds in lo and hi.
+   */
+  template <typename data_t, int L, typename acc_t = data_t, typename Tkernel>
+  void dtwBatchGroups(Tkernel kernel, const std::vector<data_t> &query, const std::vector<data_t> *const *candidates,
+                      int n_cand, DtwWorkspace<data_t, acc_t> &workspace, acc_t *out)
+  {
+    const int n = query.size(), m = candidates[0]->size();
+
+    const auto &lo = workspace.lo, &hi = workspace.hi;
+    auto &cand = workspace.series, &row0 = workspace.prev, &row1 = workspace.curr;
+    cand.resize(static_cast<size_t>(m) * L);
+    row0.resize(static_cast<size_t>(m + 1) * L);
+    row1.resize(static_cast<size_t>(m + 1) * L);
+
+    acc_t lane_out[L];
+    for (int first = 0; first < n_cand; first += L) {
+      for (int l = 0; l < L; l++) {
+        const auto &c = *candidates[std::min(first + l, n_cand - 1)]; // Pad with the last candidate.
+        for (int i = 0; i < m; i++)
+          cand[i * L + l] = c[i];
+      }
+
+      kernel(query.data(), n, cand.data(), m, lo.data(), hi.data(), row0.data(), row1.data(), lane_out);
+      std::copy(lane_out, lane_out + std::min(L, n_cand - first), out + first);
+    }
+  }
+
+} // namespace detail
+
+/**
+ * @brief Number of DTW pairs computed together by dtwBatch on this CPU.
+ * @details Two vectors per group so that the latency of the recurrence is hidden.
+ */
+template <typename data_t>
+int dtwBatchLanes()
+{
+  const int vec_bytes = [] {
+    switch (simd::level()) {
+    case simd::Level::AVX512:
+      return 64;
+    case simd::Level::AVX2:
+      return 32;
+    default:
+      return 16;
+    }
+  }();
+
+  return 2 * vec_bytes / static_cast<int>(sizeof(data_t));
+}
+
+/**
+ * @brief Computes the (banded) DTW distances between a query and several candidates of the same length.
+ *
+ * @details Same results as calling dtwBanded<data_t, Tcost>(query, *candidates[k], band) for every k, but
+ * pairs are computed in SIMD lanes. The query may have a different length than the candidates.
+ *
+ * @tparam data_t Data type of the elements in the sequences.
+ * @tparam Tcost Pointwise cost policy, see costs.hpp.
+ * @param query Query sequence.
+ * @param candidates Pointers to n_cand candidate sequences, all of the same length.
+ * @param n_cand Number of candidates.
+ * @param out Output array of n_cand distances.
+ * @param band The bandwidth parameter that controls the vicinity around the diagonal, -1 for full DTW.
+ * @param workspace Scratch memory, see DtwWorkspace.
+ * @throws std::runtime_error if the candidates have different lengths.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+void dtwBatch(const std::vector<data_t> &query, const std::vector<data_t> *const *candidates, int n_cand,
+              data_t *out, int band, DtwWorkspace<data_t> &workspace)
+{
+  constexpr data_t maxValue = std::numeric_limits<data_t>::max();
+  if (n_cand <= 0) return;
+
+  const int n = query.size(), m = candidates[0]->size();
+  for (int k = 1; k < n_cand; k++)
+    if (static_cast<int>(candidates[k]->size()) != m)
+      throw std::runtime_error("dtwBatch requires all candidates to have the same length.\n");
+
+  if (n == 0 || m == 0) {
+    std::fill(out, out + n_cand, maxValue);
+    return;
+  }
+
+  detail::batchBounds(n, m, band, workspace.lo, workspace.hi);
+
+  using kernel_t = void (*)(const data_t *, int, const data_t *, int, const int *, const int *, data_t *, data_t *, data_t *);
+  constexpr int V = 16 / sizeof(data_t); // Lanes of a 128-bit vector.
+
+#if DTWC_X86_DISPATCH
+  switch (simd::level()) {
+  case simd::Level::AVX512:
+    return detail::dtwBatchGroups<data_t, 8 * V>(static_cast<kernel_t>(&detail::dtwBatchLanes_avx512<data_t, 8 * V, Tcost>), query, candidates, n_cand, workspace, out);
+  case simd::Level::AVX2:
+    return detail::dtwBatchGroups<data_t, 4 * V>(static_cast<kernel_t>(&detail::dtwBatchLanes_avx2<data_t, 4 * V, Tcost>), query, candidates, n_cand, workspace, out);
+  case simd::Level::SSE42:
+    return detail::dtwBatchGroups<data_t, 2 * V>(static_cast<kernel_t>(&detail::dtwBatchLanes_sse42<data_t, 2 * V, Tcost>), query, candidates, n_cand, workspace, out);
+  default:
+    break;
+  }
+#endif
+  detail::dtwBatchGroups<data_t, 2 * V>(static_cast<kernel_t>(&detail::dtwBatchLanes_generic<data_t, 2 * V, Tcost>), query, candidates, n_cand, workspace, out);
+}
+
+/**
+ * @brief Computes the (banded) DTW distances between a query and several candidates of the same length, see above.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+void dtwBatch(const std::vector<data_t> &query, const std::vector<data_t> *const *candidates, int n_cand,
+              data_t *out, int band = settings::DEFAULT_BAND_LENGTH)
+{
+  dtwBatch<data_t, Tcost>(query, candidates, n_cand, out, band, threadWorkspace<data_t>());
+}
+
+/**
+ * @brief Convenience overload of dtwBatch returning the distances, e.g., dtwBatch(q, { &c0, &c1 }, band).
+ */
+template <typename data_t, typename Tcost = cost::L1>
+std::vector<data_t> dtwBatch(const std::vector<data_t> &query, const std::vector<const std::vector<data_t> *> &candidates,
+                             int band = settings::DEFAULT_BAND_LENGTH)
+{
+  std::vector<data_t> out(candidates.size());
+  dtwBatch<data_t, Tcost>(query, candidates.data(), static_cast<int>(candidates.size()), out.data(), band);
+  return out;
+}
+
+} // namespace dtwc
@@ -0,0 +1,125 @@
+/**
+ * @file warping_fast.hpp
+ * @brief Multiscale approximate dynamic time warping (FastDTW).
+ *
+ * @details Both sequences are coarsened by averaging pairs of elements until they are short,
+ * DTW is solved exactly at the coarsest level, and the warping path is projected to the next
+ * finer level where it is refined within a window of the given radius around the projection.
+ * The cost is O((n + m) * radius) instead of O(n * m). The result is the cost of an actual
+ * warping path, so it is never smaller than the exact (full) DTW distance.
+ *
+ * Reference: S. Salvador and P. Chan, "Toward accurate dynamic time warping in linear time
+ *            and space". Intelligent Data Analysis, 11(5), 561-580 (2007).
+ *
+ * @date 17 Oct 2026
+ * @author Volkan Kumtepeli
+ * @author Becky Perriment
+ */
+
+#pragma once
+
+#include "warping_window.hpp" // for WarpingWindow, dtwWindowed
+#include "warping_path.hpp"   // for dtwPath
+#include "costs.hpp"          // for cost::L1
+
+#include <algorithm> // for min, max
+#include <limits>    // for numeric_limits
+#include <stdexcept> // for runtime_error
+#include <utility>   // for pair, move
+#include <vector>    // for vector
+
+namespace dtwc {
+
+/**
+ * @brief Relative gap (approximate - exact) / exact between approximate and exact distances on a sample of pairs.
+ */
+struct ApproximationError
+{
+  double mean{ 0 }; //!< Mean relative gap.
+  double max{ 0 };  //!< Maximum relative gap.
+  int N_pairs{ 0 }; //!< Number of pairs compared.
+};
+
+namespace detail {
+
+  /// Halves the resolution of x by averaging pairs of elements (the last element stays alone for odd lengths).
+  template <typename data_t>
+  std::vector<data_t> coarsen(const std::vector<data_t> &x)
+  {
+    std::vector<data_t> out((x.size() + 1) / 2);
+    for (size_t i = 0; i < x.size() / 2; i++)
+      out[i] = (x[2 * i] + x[2 * i + 1]) / 2;
+
+    if (x.size() % 2) out.back() = x.back();
+
+    return out;
+  }
+
+  /**
+   * @brief Window of a path at half resolution projected to sequences of lengths n and m, widened by radius.
+   */
+  inline WarpingWindow projectPath(const std::vector<std::pair<int, int>> &path, int n, int m, int radius)
+  {
+    std::vector<int> lo(n, m), hi(n, 0);
+    for (const auto &[i, j] : path)
+      for (int r = 2 * i; r <= std::min(2 * i + 1, n - 1); r++) {
+        lo[r] = std::min(lo[r], 2 * j);
+        hi[r] = std::max(hi[r], std::min(2 * j + 2, m));
+      }
+
+    std::vector<int> lo_wide(n), hi_wide(n);
+    for (int r = 0; r < n; r++) {
+      int l{ m }, h{ 0 };
+      for (int k = std::max(r - radius, 0); k <= std::min(r + radius, n - 1); k++) {
+        l = std::min(l, lo[k]);
+        h = std::max(h, hi[k]);
+      }
+      lo_wide[r] = std::max(l - radius, 0);
+      hi_wide[r] = std::min(h + radius, m);
+    }
+
+    return WarpingWindow(std::move(lo_wide), std::move(hi_wide), m);
+  }
+
+  /**
+   * @brief FastDTW window for x and y: the full window for short sequences, otherwise the
+   * projection of the path found at half resolution.
+   */
+  template <typename data_t, typename Tcost>
+  WarpingWindow fastWindow(const std::vector<data_t> &x, const std::vector<data_t> &y, int radius)
+  {
+    const int n = x.size(), m = y.size();
+    if (std::min(n, m) <= radius + 2) return WarpingWindow(n, m);
+
+    const auto x_coarse = coarsen(x), y_coarse = coarsen(y);
+    const auto window = fastWindow<data_t, Tcost>(x_coarse, y_coarse, radius);
+    return projectPath(dtwPath<data_t, Tcost>(x_coarse, y_coarse, window).path, n, m, radius);
+  }
+
+} // namespace detail
+
+/**
+ * @brief Computes an approximate dynamic time warping distance with FastDTW.
+ *
+ * @details Approximates full DTW (dtwFull_L) in O((n + m) * radius) time and memory. Larger
+ * radii are more accurate and slower; the result is exact if the sequences are shorter than radius + 3.
+ *
+ * @tparam data_t Data type of the elements in the sequences.
+ * @tparam Tcost Pointwise cost policy, see costs.hpp.
+ * @param x First sequence.
+ * @param y Second sequence.
+ * @param radius Number of cells around the projected path searched at each resolution.
+ * @return The cost of the warping path found, an upper bound of the exact DTW distance.
+ * @throws std::runtime_error if radius is negative.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+data_t dtwFast(const std::vector<data_t> &x, const std::vector<data_t> &y, int radius = 10)
+{
+  if (radius < 0) throw std::runtime_error("dtwFast: radius should be non-negative.\n");
+  if (&x == &y) return 0; // If they are the same data then distance is 0.
+  if (x.empty() || y.empty()) return std::numeric_limits<data_t>::max();
+
+  return dtwWindowed<data_t, Tcost>(x, y, detail::fastWindow<data_t, Tcost>(x, y, radius));
+}
+
+} // namespace dtwc
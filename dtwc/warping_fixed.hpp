@@ -0,0 +1,179 @@
+/**
+ * @file warping_fixed.hpp
+ * @brief Dynamic time warping kernels for short sequences of compile-time lengths.
+ *
+ * @details For short sequences (tens to a hundred samples) the bookkeeping of the general
+ * kernels (vector indirection, buffer resizing, bounds) costs as much as the recurrence
+ * itself. dtwFixed<N, M> keeps its row in a std::array of compile-time size on the stack, so the
+ * loops have constant trip counts, and computes four rows at a time so that the latency of the
+ * recurrence is hidden. fixedKernel() picks the right instantiation at runtime; dtwFull_L uses
+ * it automatically.
+ *
+ * @date 17 Oct 2026
+ * @author Volkan Kumtepeli
+ * @author Becky Perriment
+ */
+
+#pragma once
+
+#include "costs.hpp" // for cost::L1
+
+#include <cstddef>   // for size_t
+#include <algorithm> // for min, fill_n, copy_n
+#include <array>     // for array
+#include <limits>    // for numeric_limits
+#include <utility>   // for integer_sequence
+
+namespace dtwc {
+
+namespace detail {
+
+  /**
+   * @brief Computes the next four rows of the cost matrix from the row above, in place.
+   *
+   * @details Rows are processed in a skewed order: at step t, row k of the stripe computes
+   * column t - k. The four cells of a step are independent, so four dependency chains overlap
+   * in the pipeline instead of one. The steady state is written out so that all cells stay in registers.
+   */
+  template <int M, typename data_t, typename Tcost>
+  void fixedStripe(const data_t *x, const data_t *y, std::array<data_t, M> &row)
+  {
+    constexpr int K = 4;
+    static_assert(M >= K, "Stripe is longer than the row.");
+    constexpr data_t maxValue = std::numeric_limits<data_t>::max();
+    const Tcost distance{};
+
+    data_t curr[K], prev[K]; // Cells computed by each row of the stripe at the last two steps.
+    std::fill_n(curr, K, maxValue);
+    std::fill_n(prev, K, maxValue);
+
+    // Prologue and epilogue: some rows of the stripe are outside the matrix.
+    auto partialStep = [&](int t) {
+      data_t next[K];
+      for (int k = 0; k < K; k++) {
+        const int j = t - k;
+        next[k] = curr[k];
+        if (j < 0 || j >= M) continue;
+
+        const data_t up = (k == 0) ? row[j] : curr[k - 1];
+        const data_t dist = distance(x[k], y[j]);
+        if (j == 0)
+          next[k] = up + dist;
+        else {
+          const data_t diag = (k == 0) ? row[j - 1] : prev[k - 1];
+          next[k] = std::min(std::min(diag, up) + dist, curr[k] + dist);
+        }
+      }
+
+      if (t >= K - 1) row[t - K + 1] = next[K - 1]; // Row above is not read anymore at this column.
+      std::copy_n(curr, K, prev);
+      std::copy_n(next, K, curr);
+    };
+
+    int t = 0;
+    for (; t < K; t++) partialStep(t);
+
+    const data_t x0 = x[0], x1 = x[1], x2 = x[2], x3 = x[3];
+    data_t c0 = curr[0], c1 = curr[1], c2 = curr[2], c3 = curr[3];
+    data_t p0 = prev[0], p1 = prev[1], p2 = prev[2];
+    for (; t < M; t++) {
+      const data_t d0 = distance(x0, y[t]), d1 = distance(x1, y[t - 1]);
+      const data_t d2 = distance(x2, y[t - 2]), d3 = distance(x3, y[t - 3]);
+
+      const data_t n0 = std::min(std::min(row[t - 1], row[t]) + d0, c0 + d0);
+      const data_t n1 = std::min(std::min(p0, c0) + d1, c1 + d1);
+      const data_t n2 = std::min(std::min(p1, c1) + d2, c2 + d2);
+      const data_t n3 = std::min(std::min(p2, c2) + d3, c3 + d3);
+      row[t - 3] = n3;
+
+      p0 = c0, p1 = c1, p2 = c2;
+      c0 = n0, c1 = n1, c2 = n2, c3 = n3;
+    }
+
+    curr[0] = c0, curr[1] = c1, curr[2] = c2, curr[3] = c3;
+    prev[0] = p0, prev[1] = p1, prev[2] = p2;
+    for (; t < M + K - 1; t++) partialStep(t);
+  }
+
+} // namespace detail
+
+/**
+ * @brief Computes the full dynamic time warping distance of sequences of lengths N and M.
+ *
+ * @details Same result as dtwFull_L, bit for bit. The row of the cost matrix is a std::array<data_t, M>.
+ *
+ * @tparam N Length of x.
+ * @tparam M Length of y.
+ * @tparam data_t Data type of the elements in the sequences.
+ * @tparam Tcost Pointwise cost policy, see costs.hpp.
+ * @param x Pointer to the first sequence (N elements).
+ * @param y Pointer to the second sequence (M elements).
+ * @return The dynamic time warping distance.
+ */
+template <int N, int M, typename data_t, typename Tcost = cost::L1>
+data_t dtwFixed(const data_t *x, const data_t *y)
+{
+  static_assert(N > 0 && M > 0, "dtwFixed: lengths should be positive.");
+  const Tcost distance{};
+
+  std::array<data_t, M> row;
+  row[0] = distance(x[0], y[0]);
+  for (int j = 1; j < M; j++)
+    row[j] = row[j - 1] + distance(x[0], y[j]);
+
+  int i = 1;
+  if constexpr (M >= 4)
+    for (; i + 4 <= N; i += 4)
+      detail::fixedStripe<M, data_t, Tcost>(x + i, y, row);
+
+  for (; i < N; i++) {
+    const data_t xi = x[i];
+    data_t diag = row[0];
+    data_t left = row[0] += distance(xi, y[0]);
+
+    for (int j = 1; j < M; j++) {
+      // min(a, b) + d == min(a + d, b + d) as rounding is monotonic, so only one addition depends on the left cell.
+      const data_t dist = distance(xi, y[j]);
+      const data_t next = std::min(std::min(diag, row[j]) + dist, left + dist);
+      diag = row[j];
+      left = row[j] = next;
+    }
+  }
+
+  return row[M - 1];
+}
+
+namespace detail {
+
+  constexpr int fixed_step = 8;      //!< Lengths with a fixed kernel are multiples of fixed_step,
+  constexpr int fixed_max_len = 128; //!< up to fixed_max_len.
+
+  template <typename data_t, typename Tcost>
+  using fixed_kernel_t = data_t (*)(const data_t *, const data_t *);
+
+  template <typename data_t, typename Tcost, int... I>
+  constexpr auto fixedKernelTable(std::integer_sequence<int, I...>)
+  {
+    return std::array<fixed_kernel_t<data_t, Tcost>, sizeof...(I)>{ &dtwFixed<(I + 1) * fixed_step, (I + 1) * fixed_step, data_t, Tcost>... };
+  }
+
+} // namespace detail
+
+/**
+ * @brief Returns the dtwFixed kernel for sequences of lengths n and m, if there is one.
+ *
+ * @details Kernels exist for equal lengths which are multiples of 8 up to 128 (typical window sizes).
+ *
+ * @return Pointer to dtwFixed<n, m>, or nullptr if the lengths have no fixed kernel.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+detail::fixed_kernel_t<data_t, Tcost> fixedKernel(size_t n, size_t m)
+{
+  static constexpr auto table = detail::fixedKernelTable<data_t, Tcost>(std::make_integer_sequence<int, detail::fixed_max_len / detail::fixed_step>{});
+
+  if (n != m || n == 0 || n > detail::fixed_max_len || n % detail::fixed_step != 0) return nullptr;
+
+  return table[n / detail::fixed_step - 1];
+}
+
+} // namespace dtwc
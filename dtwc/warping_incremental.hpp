@@ -0,0 +1,111 @@
+/**
+ * @file warping_incremental.hpp
+ * @brief Incremental dynamic time warping for sequences which grow over time.
+ *
+ * @details IncrementalDtw keeps the last row and the last column of the cost matrix of a pair,
+ * so that when samples are appended to either sequence only the new rows and columns are
+ * computed: O(appended * other length) time and O(n + m) memory per pair.
+ *
+ * The distance is unconstrained (full) DTW, the same as dtwFull_L. The Sakoe-Chiba band of
+ * dtwBanded is skewed by the length ratio of the sequences, so it moves whenever one of them
+ * grows and banded distances cannot be updated this way.
+ *
+ * @date 17 Oct 2026
+ * @author Volkan Kumtepeli
+ * @author Becky Perriment
+ */
+
+#pragma once
+
+#include "costs.hpp" // for cost::L1
+
+#include <cstddef>   // for size_t
+#include <algorithm> // for min
+#include <limits>    // for numeric_limits
+#include <stdexcept> // for runtime_error
+#include <vector>    // for vector
+
+namespace dtwc {
+
+/**
+ * @brief State of the DTW recurrence of a pair of growing sequences, see warping_incremental.hpp.
+ *
+ * @details The sequences are not stored; pass the whole (grown) sequences to update() each time.
+ * Samples seen before must not change.
+ *
+ * @tparam data_t Data type of the elements in the sequences.
+ * @tparam Tcost Pointwise cost policy, see costs.hpp.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+class IncrementalDtw
+{
+  static constexpr data_t maxValue = std::numeric_limits<data_t>::max();
+
+  std::vector<data_t> row; //!< C(n - 1, j) for j in [0, m), maxValue if n = 0.
+  std::vector<data_t> col; //!< C(i, m - 1) for i in [0, n), maxValue if m = 0.
+
+public:
+  size_t rows() const { return col.size(); } //!< Number of samples of x seen so far.
+  size_t cols() const { return row.size(); } //!< Number of samples of y seen so far.
+
+  /**
+   * @brief DTW distance of the samples seen so far, maximum value of data_t if a sequence is empty.
+   */
+  data_t distance() const { return (rows() == 0 || cols() == 0) ? maxValue : row.back(); }
+
+  /**
+   * @brief Forgets the sequences.
+   */
+  void reset()
+  {
+    row.clear();
+    col.clear();
+  }
+
+  /**
+   * @brief Extends the cost matrix with the samples appended to x and y since the last update.
+   *
+   * @param x First sequence, of at least rows() samples.
+   * @param y Second sequence, of at least cols() samples.
+   * @return The DTW distance between x and y.
+   * @throws std::runtime_error if a sequence has fewer samples than seen before.
+   */
+  data_t update(const std::vector<data_t> &x, const std::vector<data_t> &y)
+  {
+    const size_t n = rows(), m = cols(), n_new = x.size(), m_new = y.size();
+    if (n_new < n || m_new < m)
+      throw std::runtime_error("IncrementalDtw: sequences can only grow.\n");
+
+    const Tcost distance_fun{};
+
+    // New rows of x against the first m samples of y, from the last row:
+    for (size_t i = n; i < n_new; i++) {
+      data_t diag = (i == 0) ? 0 : maxValue; // C(i - 1, -1); virtual C(-1, -1) = 0.
+      data_t left = maxValue;                // C(i, -1)
+      for (size_t j = 0; j < m; j++) {
+        const data_t up = row[j];
+        const data_t best = std::min(std::min(diag, up), left);
+        diag = up;
+        left = row[j] = best + distance_fun(x[i], y[j]);
+      }
+      col.push_back((m > 0) ? row[m - 1] : maxValue);
+    }
+
+    // New columns of y against all samples of x, from the last column:
+    for (size_t j = m; j < m_new; j++) {
+      data_t diag = (j == 0) ? 0 : maxValue; // C(-1, j - 1)
+      data_t up = maxValue;                  // C(-1, j)
+      for (size_t i = 0; i < n_new; i++) {
+        const data_t left = col[i];
+        const data_t best = std::min(std::min(diag, left), up);
+        diag = left;
+        up = col[i] = best + distance_fun(x[i], y[j]);
+      }
+      row.push_back((n_new > 0) ? col[n_new - 1] : maxValue);
+    }
+
+    return distance();
+  }
+};
+
+} // namespace dtwc
@@ -0,0 +1,190 @@
+/**
+ * @file warping_multivariate.hpp
+ * @brief Dynamic time warping of multivariate (multichannel) series.
+ *
+ * @details A series of length n with ndim channels is stored channel-interleaved in a single
+ * vector of n * ndim elements: element c of frame t is at index t * ndim + c. Two kinds of
+ * multivariate DTW are provided:
+ * - Dependent (DTW_D): all channels share one warping path; the cost of matching two frames is
+ *   the sum of the pointwise costs of their channels.
+ * - Independent (DTW_I): every channel is warped on its own; the distance is the sum of the
+ *   univariate distances of the channels.
+ *
+ * Both take the same warping windows and step patterns as dtwWindowed, with lengths in frames.
+ *
+ * Reference: M. Shokoohi-Yekta, B. Hu, H. Jin, J. Wang and E. Keogh, "Generalizing DTW to the
+ *            multi-dimensional case requires an adaptive approach". Data Mining and Knowledge
+ *            Discovery, 31(1), 1-31 (2017).
+ *
+ * @date 17 Oct 2026
+ * @author Volkan Kumtepeli
+ * @author Becky Perriment
+ */
+
+#pragma once
+
+#include "settings.hpp"       // for DEFAULT_BAND_LENGTH, StepPattern
+#include "warping_window.hpp" // for WarpingWindow, detail::dtwWindowedCells
+#include "warping_path.hpp"   // for DtwPath, detail::dtwPathCells
+#include "costs.hpp"          // for cost::L1, detail::FrameCost, detail::ChannelCost
+
+#include <cstddef>   // for size_t
+#include <limits>    // for numeric_limits
+#include <stdexcept> // for runtime_error
+#include <string>    // for to_string
+#include <vector>    // for vector
+
+namespace dtwc {
+
+namespace detail {
+
+  /// Number of frames of a channel-interleaved series; throws if its size is not a multiple of ndim.
+  template <typename data_t>
+  int frames(const std::vector<data_t> &x, int ndim)
+  {
+    if (ndim < 1 || x.size() % ndim != 0)
+      throw std::runtime_error("Multivariate series of " + std::to_string(x.size()) + " elements cannot have " + std::to_string(ndim) + " channels.\n");
+
+    return static_cast<int>(x.size() / ndim);
+  }
+
+} // namespace detail
+
+/**
+ * @brief Computes the dependent multivariate DTW distance (DTW_D) within a warping window.
+ *
+ * @details The channels share one warping path. For ndim = 1 the result is the same as dtwWindowed.
+ *
+ * @tparam data_t Data type of the elements in the sequences.
+ * @tparam Tcost Pointwise cost policy, see costs.hpp; summed over the channels.
+ * @param x First channel-interleaved sequence.
+ * @param y Second channel-interleaved sequence.
+ * @param ndim Number of channels.
+ * @param window Allowed cells, with window.rows() and window.cols() the numbers of frames of x and y.
+ * @param pattern Step pattern.
+ * @param workspace Scratch memory, see DtwWorkspace.
+ * @return The dynamic time warping distance, or maximum value of data_t if there is no warping path.
+ * @throws std::runtime_error if the sizes are not multiples of ndim or the window does not match them.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+data_t dtwDependent(const std::vector<data_t> &x, const std::vector<data_t> &y, int ndim, const WarpingWindow &window,
+                    StepPattern pattern, DtwWorkspace<data_t> &workspace)
+{
+  const int n = detail::frames(x, ndim), m = detail::frames(y, ndim);
+  detail::checkWindow(window, n, m, "dtwDependent");
+
+  if (&x == &y) return 0; // If they are the same data then distance is 0.
+  if (n == 0 || m == 0) return std::numeric_limits<data_t>::max();
+
+  return detail::dtwWindowedCells<data_t>(n, m, window, pattern, detail::FrameCost<data_t, Tcost>{ x.data(), y.data(), ndim }, workspace);
+}
+
+/**
+ * @brief Computes the dependent multivariate DTW distance (DTW_D) within a warping window, see above.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+data_t dtwDependent(const std::vector<data_t> &x, const std::vector<data_t> &y, int ndim, const WarpingWindow &window,
+                    StepPattern pattern = StepPattern::Symmetric1)
+{
+  return dtwDependent<data_t, Tcost>(x, y, ndim, window, pattern, threadWorkspace<data_t>());
+}
+
+/**
+ * @brief Computes the dependent multivariate DTW distance (DTW_D) within a Sakoe-Chiba band, see above.
+ * @param band The bandwidth parameter in frames, -1 for full DTW.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+data_t dtwDependent(const std::vector<data_t> &x, const std::vector<data_t> &y, int ndim, int band = settings::DEFAULT_BAND_LENGTH)
+{
+  return dtwDependent<data_t, Tcost>(x, y, ndim, WarpingWindow::sakoeChiba(detail::frames(x, ndim), detail::frames(y, ndim), band));
+}
+
+/**
+ * @brief Computes the independent multivariate DTW distance (DTW_I) within a warping window.
+ *
+ * @details Sum of the DTW distances of the channels, each with its own warping path.
+ *
+ * @tparam data_t Data type of the elements in the sequences.
+ * @tparam Tcost Pointwise cost policy, see costs.hpp.
+ * @param x First channel-interleaved sequence.
+ * @param y Second channel-interleaved sequence.
+ * @param ndim Number of channels.
+ * @param window Allowed cells, with window.rows() and window.cols() the numbers of frames of x and y.
+ * @param pattern Step pattern.
+ * @param workspace Scratch memory, see DtwWorkspace.
+ * @return The dynamic time warping distance, or maximum value of data_t if there is no warping path.
+ * @throws std::runtime_error if the sizes are not multiples of ndim or the window does not match them.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+data_t dtwIndependent(const std::vector<data_t> &x, const std::vector<data_t> &y, int ndim, const WarpingWindow &window,
+                      StepPattern pattern, DtwWorkspace<data_t> &workspace)
+{
+  constexpr data_t maxValue = std::numeric_limits<data_t>::max();
+  const int n = detail::frames(x, ndim), m = detail::frames(y, ndim);
+  detail::checkWindow(window, n, m, "dtwIndependent");
+
+  if (&x == &y) return 0; // If they are the same data then distance is 0.
+  if (n == 0 || m == 0) return maxValue;
+
+  data_t sum{ 0 };
+  for (int c = 0; c < ndim; c++) {
+    const auto d = detail::dtwWindowedCells<data_t>(n, m, window, pattern, detail::ChannelCost<data_t, Tcost>{ x.data() + c, y.data() + c, ndim }, workspace);
+    if (d == maxValue) return maxValue; // No warping path.
+    sum += d;
+  }
+
+  return sum;
+}
+
+/**
+ * @brief Computes the independent multivariate DTW distance (DTW_I) within a warping window, see above.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+data_t dtwIndependent(const std::vector<data_t> &x, const std::vector<data_t> &y, int ndim, const WarpingWindow &window,
+                      StepPattern pattern = StepPattern::Symmetric1)
+{
+  return dtwIndependent<data_t, Tcost>(x, y, ndim, window, pattern, threadWorkspace<data_t>());
+}
+
+/**
+ * @brief Computes the independent multivariate DTW distance (DTW_I) within a Sakoe-Chiba band, see above.
+ * @param band The bandwidth parameter in frames, -1 for full DTW.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+data_t dtwIndependent(const std::vector<data_t> &x, const std::vector<data_t> &y, int ndim, int band = settings::DEFAULT_BAND_LENGTH)
+{
+  return dtwIndependent<data_t, Tcost>(x, y, ndim, WarpingWindow::sakoeChiba(detail::frames(x, ndim), detail::frames(y, ndim), band));
+}
+
+/**
+ * @brief Computes the shared warping path of dependent multivariate DTW (DTW_D) in O(n + m) memory.
+ *
+ * @param x First channel-interleaved sequence.
+ * @param y Second channel-interleaved sequence.
+ * @param ndim Number of channels.
+ * @param window Allowed cells, with window.rows() and window.cols() the numbers of frames of x and y.
+ * @param workspace Scratch memory, see DtwWorkspace.
+ * @return Pairs of matched frame indices and the distance along the path (the same as dtwDependent, up to rounding).
+ *         An empty path and maximum value of data_t if there is no warping path.
+ * @throws std::runtime_error if the sizes are not multiples of ndim or the window does not match them.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+DtwPath<data_t> dtwPathDependent(const std::vector<data_t> &x, const std::vector<data_t> &y, int ndim, const WarpingWindow &window,
+                                 DtwWorkspace<data_t> &workspace)
+{
+  const int n = detail::frames(x, ndim), m = detail::frames(y, ndim);
+  detail::checkWindow(window, n, m, "dtwPathDependent");
+
+  return detail::dtwPathCells<data_t>(n, m, window, detail::FrameCost<data_t, Tcost>{ x.data(), y.data(), ndim }, workspace);
+}
+
+/**
+ * @brief Computes the shared warping path of dependent multivariate DTW (DTW_D) in O(n + m) memory, see above.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+DtwPath<data_t> dtwPathDependent(const std::vector<data_t> &x, const std::vector<data_t> &y, int ndim, const WarpingWindow &window)
+{
+  return dtwPathDependent<data_t, Tcost>(x, y, ndim, window, threadWorkspace<data_t>());
+}
+
+} // namespace dtwc
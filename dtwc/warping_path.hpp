@@ -0,0 +1,347 @@
+/**
+ * @file warping_path.hpp
+ * @brief Optimal warping path (alignment) of two sequences in linear memory.
+ *
+ * @details The distance kernels only keep a few rows of the cost matrix, so they cannot
+ * trace the optimal path back. dtwPath recovers it in O(n + m) memory besides the path itself,
+ * with about twice the work of the distance:
+ * - Wide windows (e.g., full DTW) are split with Hirschberg's divide and conquer: the cell where
+ *   the path crosses the middle row is found from a forward pass over the upper half and a
+ *   backward pass over the lower half; then both halves are solved recursively.
+ * - Narrow windows (e.g., Sakoe-Chiba bands) are traced back block by block from a few checkpoint
+ *   rows kept during a single forward pass, as halving the rows would not reduce the work there.
+ *
+ * Reference: D. S. Hirschberg, "A linear space algorithm for computing maximal common
+ *            subsequences". Communications of the ACM, 18(6), 341-343 (1975).
+ *
+ * @date 17 Oct 2026
+ * @author Volkan Kumtepeli
+ * @author Becky Perriment
+ */
+
+#pragma once
+
+#include "settings.hpp"       // for DEFAULT_BAND_LENGTH
+#include "warping_window.hpp" // for WarpingWindow, detail::WindowRows, detail::checkWindow, DtwWorkspace
+#include "costs.hpp"          // for cost::L1, detail::PointCost
+
+#include <cstddef>   // for size_t
+#include <algorithm> // for min, max, reverse
+#include <limits>    // for numeric_limits
+#include <stdexcept> // for runtime_error
+#include <utility>   // for pair
+#include <vector>    // for vector
+
+namespace dtwc {
+
+/**
+ * @brief Warping path with its distance.
+ */
+template <typename data_t>
+struct DtwPath
+{
+  data_t distance{ std::numeric_limits<data_t>::max() }; //!< Sum of the costs along the path.
+  std::vector<std::pair<int, int>> path;                 //!< Pairs of matched indices (i of x, j of y), from (0, 0) to (n - 1, m - 1).
+};
+
+namespace detail {
+
+  /**
+   * @brief Finds the optimal warping path between two cells of the cost matrix.
+   *
+   * @details Subproblems are rectangles [r0, r1] x [c0, c1] whose path starts at (r0, c0) and ends
+   * at (r1, c1). If the cells of the window in the rectangle can be stored in blocks of rows with
+   * few checkpoint rows in between (narrow windows), the path is traced back block by block after
+   * a single forward pass. Otherwise (wide windows), the rectangle is split at its middle row.
+   * Tcell is a cell cost, see costs.hpp.
+   */
+  template <typename data_t, typename Tcell>
+  class HirschbergPath
+  {
+    static constexpr data_t maxValue = std::numeric_limits<data_t>::max();
+
+    /// Cells of a row in columns [lo, hi); other cells read as maxValue.
+    struct RowView
+    {
+      int lo{ 0 }, hi{ 0 };
+      const data_t *values{ nullptr };
+
+      data_t operator()(int j) const { return (lo <= j && j < hi) ? values[j - lo] : maxValue; }
+    };
+
+    const Tcell &cell;
+    const WarpingWindow &window;
+    std::vector<std::pair<int, int>> &path;
+    const size_t budget; //!< Maximum number of cells stored at once.
+    DtwWorkspace<data_t> &workspace;
+
+    /// Allowed columns of row i within [c0, c1].
+    std::pair<int, int> columns(int i, int c0, int c1) const
+    {
+      return { std::max(window.lo(i), c0), std::min(window.hi(i), c1 + 1) };
+    }
+
+    /// Computes the cells of row i in columns [a, b) from the previous row.
+    void computeRow(int i, int a, int b, RowView prev, data_t *out) const
+    {
+      data_t left = maxValue;
+      for (int j = a; j < b; j++) {
+        const data_t best = std::min({ left, prev(j), prev(j - 1) });
+        left = out[j - a] = (best == maxValue) ? maxValue : best + cell(i, j);
+      }
+    }
+
+    /**
+     * @brief Last row of the cost matrix of paths starting at (r_first, c_first), computed row by row towards r_last.
+     * @details Backward passes (r_last < r_first) walk the rectangle upside down and right to left;
+     * out[k] is the cell of column c_first + k or c_first - k respectively.
+     */
+    void lastRow(int r_first, int r_last, int c_first, int c_last, std::vector<data_t> &out) const
+    {
+      const int dir = (r_first <= r_last) ? 1 : -1;
+      const int width = dir * (c_last - c_first) + 1;
+      const int c0 = std::min(c_first, c_last), c1 = std::max(c_first, c_last);
+
+      WindowRows<data_t, 2> rows({ &workspace.prev, &workspace.curr }, width);
+
+      for (int i = r_first; i != r_last + dir; i += dir) {
+        const auto [a, b] = columns(i, c0, c1);
+        const int k_begin = (dir > 0) ? a - c0 : c1 - b + 1;
+        const int k_end = std::max(k_begin, (dir > 0) ? b - c0 : c1 - a + 1);
+        rows.rotate(k_begin, k_end);
+
+        const data_t *prev = rows.row[0];
+        data_t *curr = rows.row[1];
+        data_t left = maxValue;
+        for (int k = k_begin; k < k_end; k++) {
+          const data_t diag = (k == 0) ? ((i == r_first) ? 0 : maxValue) : prev[k - 1];
+          const data_t best = std::min({ left, prev[k], diag });
+          left = curr[k] = (best == maxValue) ? maxValue : best + cell(i, c_first + dir * k);
+        }
+      }
+
+      out.assign(rows.row[1], rows.row[1] + width);
+    }
+
+    /**
+     * @brief Splits rows [r0, r1] into blocks of at most budget / 2 cells.
+     * @return First rows of the blocks followed by r1 + 1, or an empty vector if the checkpoint
+     * rows (last rows of all blocks but the last one) need more than budget / 2 cells.
+     */
+    std::vector<int> blocks(int r0, int r1, int c0, int c1) const
+    {
+      std::vector<int> first_rows{ r0 };
+      size_t block_cells{ 0 }, checkpoint_cells{ 0 };
+      for (int i = r0; i <= r1; i++) {
+        const auto [a, b] = columns(i, c0, c1);
+        const size_t width = std::max(b - a, 0);
+        if (block_cells > 0 && block_cells + width > budget / 2) {
+          const auto [a_prev, b_prev] = columns(i - 1, c0, c1);
+          checkpoint_cells += std::max(b_prev - a_prev, 0);
+          if (checkpoint_cells > budget / 2) return {};
+
+          first_rows.push_back(i);
+          block_cells = 0;
+        }
+        block_cells += width;
+      }
+
+      first_rows.push_back(r1 + 1);
+      return first_rows;
+    }
+
+    /// Forward pass keeping the last row of every block, then traceback block by block. False if there is no path.
+    bool tracebackBlocks(int r0, int r1, int c0, int c1, const std::vector<int> &first_rows)
+    {
+      const int N_blocks = first_rows.size() - 1;
+      const data_t zero{ 0 };
+      const RowView start{ c0 - 1, c0, &zero }; // Virtual C(r0 - 1, c0 - 1) = 0 so that C(r0, c0) = dist(r0, c0).
+
+      std::vector<data_t> checkpoints, rolling[2];
+      std::vector<RowView> checkpoint_rows;
+      std::vector<size_t> checkpoint_offsets;
+      RowView prev = start;
+      for (int i = r0, k = 1; k < N_blocks; i++) {
+        const auto [a, b] = columns(i, c0, c1);
+        auto &curr = rolling[i % 2];
+        curr.resize(std::max(b - a, 0));
+        computeRow(i, a, b, prev, curr.data());
+        prev = RowView{ a, std::max(a, b), curr.data() };
+
+        if (i + 1 == first_rows[k]) {
+          checkpoint_offsets.push_back(checkpoints.size());
+          checkpoints.insert(checkpoints.end(), curr.begin(), curr.end());
+          checkpoint_rows.push_back(prev);
+          k++;
+        }
+      }
+      for (size_t k = 0; k < checkpoint_rows.size(); k++)
+        checkpoint_rows[k].values = checkpoints.data() + checkpoint_offsets[k];
+
+      const auto first = path.size();
+      std::vector<data_t> cells;
+      std::vector<RowView> rows;
+      int i{ r1 }, j{ c1 };
+      for (int k = N_blocks - 1; k >= 0; k--) {
+        const int b_first = first_rows[k], b_last = first_rows[k + 1] - 1;
+
+        std::vector<size_t> offsets;
+        cells.clear();
+        rows.clear();
+        for (int r = b_first; r <= b_last; r++) {
+          const auto [a, b] = columns(r, c0, c1);
+          offsets.push_back(cells.size());
+          cells.resize(cells.size() + std::max(b - a, 0));
+          rows.push_back(RowView{ a, std::max(a, b), nullptr });
+        }
+
+        for (int r = b_first; r <= b_last; r++) {
+          auto &row = rows[r - b_first];
+          row.values = cells.data() + offsets[r - b_first];
+          computeRow(r, row.lo, row.hi, (r == b_first) ? (k == 0 ? start : checkpoint_rows[k - 1]) : rows[r - b_first - 1],
+                     cells.data() + offsets[r - b_first]);
+        }
+
+        const auto row_of = [&](int r) { return (r >= b_first) ? rows[r - b_first] : (k == 0 ? start : checkpoint_rows[k - 1]); };
+        if (row_of(i)(j) == maxValue) return false;
+
+        while (i >= b_first) {
+          path.emplace_back(i, j);
+          if (i == r0 && j == c0) break;
+
+          const data_t diag = row_of(i - 1)(j - 1), up = row_of(i - 1)(j), left = row_of(i)(j - 1);
+          if (diag <= up && diag <= left)
+            --i, --j;
+          else if (up <= left)
+            --i;
+          else
+            --j;
+        }
+      }
+
+      std::reverse(path.begin() + first, path.end());
+      return true;
+    }
+
+  public:
+    HirschbergPath(const Tcell &cell_, const WarpingWindow &window_, std::vector<std::pair<int, int>> &path_, DtwWorkspace<data_t> &workspace_)
+      : cell{ cell_ }, window{ window_ }, path{ path_ }, budget{ std::max<size_t>(1 << 12, 4 * (window_.rows() + window_.cols())) },
+        workspace{ workspace_ } {}
+
+    /// Appends the optimal path from (r0, c0) to (r1, c1) to the path. False if there is no path.
+    bool solve(int r0, int r1, int c0, int c1)
+    {
+      if (r0 == r1 || c0 == c1) { // Straight line.
+        for (int i = r0; i <= r1; i++)
+          for (int j = c0; j <= c1; j++) {
+            if (j < window.lo(i) || j >= window.hi(i)) return false;
+            path.emplace_back(i, j);
+          }
+        return true;
+      }
+
+      if (const auto first_rows = blocks(r0, r1, c0, c1); !first_rows.empty())
+        return tracebackBlocks(r0, r1, c0, c1, first_rows);
+
+      const int mid = r0 + (r1 - r0) / 2;
+      int j_up{ c0 }, j_down{ c0 }; // The path steps from (mid, j_up) to (mid + 1, j_down).
+      {
+        std::vector<data_t> forward, backward;
+        lastRow(r0, mid, c0, c1, forward);      // forward[j - c0]: (r0, c0) -> (mid, j).
+        lastRow(r1, mid + 1, c1, c0, backward); // backward[c1 - j]: (mid + 1, j) -> (r1, c1).
+
+        data_t best = maxValue;
+        for (int j = c0; j <= c1; j++) {
+          const data_t f = forward[j - c0];
+          if (f == maxValue) continue;
+
+          for (int next : { j, j + 1 }) {
+            if (next > c1) continue;
+            const data_t b = backward[c1 - next];
+            if (b != maxValue && f + b < best) {
+              best = f + b;
+              j_up = j;
+              j_down = next;
+            }
+          }
+        }
+
+        if (best == maxValue) return false;
+      }
+
+      return solve(r0, mid, c0, j_up) && solve(mid + 1, r1, j_down, c1);
+    }
+  };
+
+  /**
+   * @brief Optimal warping path for sequences of lengths n and m and cell cost cell(i, j), see dtwPath.
+   */
+  template <typename data_t, typename Tcell>
+  DtwPath<data_t> dtwPathCells(int n, int m, const WarpingWindow &window, const Tcell &cell, DtwWorkspace<data_t> &workspace)
+  {
+    DtwPath<data_t> result;
+    if (n == 0 || m == 0) return result;
+
+    result.path.reserve(n + m - 1);
+    if (!HirschbergPath<data_t, Tcell>(cell, window, result.path, workspace).solve(0, n - 1, 0, m - 1)) {
+      result.path.clear(); // No warping path.
+      return result;
+    }
+
+    result.distance = 0;
+    for (const auto &[i, j] : result.path)
+      result.distance += cell(i, j);
+
+    return result;
+  }
+
+} // namespace detail
+
+/**
+ * @brief Computes the optimal warping path within a warping window in O(n + m) memory.
+ *
+ * @tparam data_t Data type of the elements in the sequences.
+ * @tparam Tcost Pointwise cost policy, see costs.hpp.
+ * @param x First sequence.
+ * @param y Second sequence.
+ * @param window Allowed cells, with window.rows() == x.size() and window.cols() == y.size().
+ * @param workspace Scratch memory, see DtwWorkspace.
+ * @return The path and its distance (the same as dtwWindowed with StepPattern::Symmetric1, up to rounding).
+ *         An empty path and maximum value of data_t if there is no warping path.
+ * @throws std::runtime_error if the window does not match the lengths of the sequences.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+DtwPath<data_t> dtwPath(const std::vector<data_t> &x, const std::vector<data_t> &y, const WarpingWindow &window, DtwWorkspace<data_t> &workspace)
+{
+  const int n = x.size(), m = y.size();
+  detail::checkWindow(window, n, m, "dtwPath");
+
+  return detail::dtwPathCells<data_t>(n, m, window, detail::PointCost<data_t, Tcost>{ x.data(), y.data() }, workspace);
+}
+
+/**
+ * @brief Computes the optimal warping path within a warping window in O(n + m) memory, see above.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+DtwPath<data_t> dtwPath(const std::vector<data_t> &x, const std::vector<data_t> &y, const WarpingWindow &window)
+{
+  return dtwPath<data_t, Tcost>(x, y, window, threadWorkspace<data_t>());
+}
+
+/**
+ * @brief Computes the optimal warping path within a Sakoe-Chiba band in O(n + m) memory.
+ *
+ * @tparam data_t Data type of the elements in the sequences.
+ * @tparam Tcost Pointwise cost policy, see costs.hpp.
+ * @param x First sequence.
+ * @param y Second sequence.
+ * @param band The bandwidth parameter that controls the vicinity around the diagonal, -1 for full DTW.
+ * @return The path and its distance (the same as dtwBanded, up to rounding).
+ */
+template <typename data_t, typename Tcost = cost::L1>
+DtwPath<data_t> dtwPath(const std::vector<data_t> &x, const std::vector<data_t> &y, int band = settings::DEFAULT_BAND_LENGTH)
+{
+  return dtwPath<data_t, Tcost>(x, y, WarpingWindow::sakoeChiba(x.size(), y.size(), band));
+}
+
+} // namespace dtwc
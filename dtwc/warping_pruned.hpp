@@ -0,0 +1,219 @@
+/**
+ * @file warping_pruned.hpp
+ * @brief Pruned dynamic time warping (PrunedDTW) with an upper bound.
+ *
+ * @details Cells whose accumulated cost exceeds an upper bound of the distance cannot lie on
+ * an optimal warping path. PrunedDTW skips such cells at the start of each column, and stops
+ * a column once the cells of the previous column are pruned as well, so only the live interval
+ * of each column is computed. The result stays exact.
+ *
+ * The upper bound is the cost of a path along the diagonal of the band: the lock-step (L1)
+ * distance for sequences of equal length, a staircase path otherwise.
+ *
+ * Reference: D. F. Silva and G. E. A. P. A. Batista, "Speeding up all-pairwise dynamic time
+ *            warping matrix calculation". SIAM International Conference on Data Mining (2016).
+ *
+ * @date 17 Oct 2026
+ * @author Volkan Kumtepeli
+ * @author Becky Perriment
+ */
+
+#pragma once
+
+#include "settings.hpp" // for DEFAULT_BAND_LENGTH
+#include "warping.hpp"  // for sakoeChibaBounds, dtwBanded, DtwResult, DtwWorkspace
+#include "costs.hpp"    // for cost::L1
+
+#include <algorithm> // for min, max
+#include <cmath>     // for abs, nextafter
+#include <limits>    // for numeric_limits
+#include <tuple>     // for tie
+#include <utility>   // for pair
+#include <vector>    // for vector
+
+namespace dtwc {
+
+namespace detail {
+
+  /**
+   * @brief Cost of a warping path close to the diagonal of the band, an upper bound of DTW.
+   *
+   * @details Column j of the short side covers the rows [b(j - 1) + 1, b(j)] of the long side with
+   * b(j) = floor(slope * (j + 1/2)), which is the lock-step path for sequences of equal length.
+   * Cells are summed in path order so that the bound also holds in floating point arithmetic.
+   *
+   * @return The cost of the path, or maxValue if it leaves the band.
+   */
+  template <typename Tcost, typename data_t, typename Tbounds>
+  data_t diagonalPathCost(const std::vector<data_t> &short_vec, const std::vector<data_t> &long_vec, Tbounds get_bounds)
+  {
+    const long m_short(short_vec.size()), m_long(long_vec.size());
+
+    data_t cost{ 0 };
+    long first{ 0 };
+    for (long j = 0; j < m_short; j++) {
+      const long last = (j == m_short - 1) ? m_long - 1 : ((m_long - 1) * (2 * j + 1)) / (2 * (m_short - 1));
+      const auto [lo, hi] = get_bounds(j);
+      if (first < lo || last >= hi) return std::numeric_limits<data_t>::max();
+
+      for (long i = first; i <= last; i++)
+        cost += Tcost{}(long_vec[i], short_vec[j]);
+
+      first = last + 1;
+    }
+
+    return cost;
+  }
+
+  /**
+   * @brief PrunedDTW recurrence. Cells larger than upper_bound are pruned.
+   * @return The exact distance, or is_exact = false if the distance is larger than upper_bound.
+   */
+  template <typename Tcost, typename data_t, typename Tbounds>
+  DtwResult<data_t> dtwPrunedColumns(const std::vector<data_t> &short_vec, const std::vector<data_t> &long_vec,
+                                     Tbounds get_bounds, data_t upper_bound, DtwWorkspace<data_t> &workspace)
+  {
+    constexpr data_t maxValue = std::numeric_limits<data_t>::max();
+    const int m_short(short_vec.size()), m_long(long_vec.size());
+    const Tcost distance{};
+
+    // Columns are indexed by the long-side index + 1, so that slot 0 (index -1) reads as maxValue.
+    // Cells outside the computed range of a column are pruned and read as maxValue as well.
+    auto &buf0 = workspace.prev, &buf1 = workspace.curr;
+    buf0.assign(m_long + 1, maxValue);
+    buf1.assign(m_long + 1, maxValue);
+
+    data_t *prev = buf0.data(), *curr = buf1.data();
+    prev[0] = 0; // Virtual C(-1, -1) = 0 so that C(0, 0) = dist(0, 0).
+
+    int sc{ 0 }, ec{ -1 };        // First and last cells of the previous column which are not larger than upper_bound.
+    int b_old{ 0 }, e_old{ 0 };   // Computed range of the column which is being overwritten.
+    int b_prev{ 0 }, e_prev{ 0 }; // Computed range of the previous column.
+
+    for (int j = 0; j < m_short; j++) {
+      const auto [lo, hi] = get_bounds(j);
+      const int begin = std::max(lo, sc); // Cells before sc are larger than upper_bound.
+      const data_t yj = short_vec[j];
+
+      int i = begin;
+      data_t up = maxValue; // C(i - 1, j)
+      for (const int end = std::min(hi, ec + 2); i < end; ++i)
+        up = curr[i + 1] = std::min({ up, prev[i + 1], prev[i] }) + distance(long_vec[i], yj);
+
+      // The previous column is pruned from here on, so only the left neighbour can be smaller than upper_bound:
+      for (; i < hi && up <= upper_bound; ++i)
+        up = curr[i + 1] = up + distance(long_vec[i], yj);
+
+      // Clear the cells of the overwritten column which are not computed in this one:
+      std::fill(curr + b_old + 1, curr + std::max(b_old, std::min(begin, e_old)) + 1, maxValue);
+      std::fill(curr + std::min(std::max(i, b_old), e_old) + 1, curr + e_old + 1, maxValue);
+
+      int new_sc = begin, new_ec = i - 1;
+      while (new_sc < i && curr[new_sc + 1] > upper_bound) ++new_sc;
+      while (new_ec >= new_sc && curr[new_ec + 1] > upper_bound) --new_ec;
+
+      if (new_sc == i) return { std::nextafter(upper_bound, maxValue), false }; // All cells are pruned.
+
+      if (j == 0) prev[0] = maxValue;
+      std::swap(prev, curr);
+      std::tie(sc, ec, b_old, e_old, b_prev, e_prev) = std::tuple(new_sc, new_ec, b_prev, e_prev, begin, i);
+    }
+
+    if (ec == m_long - 1) return { prev[m_long], true };
+
+    return { std::nextafter(upper_bound, maxValue), false };
+  }
+
+  /**
+   * @brief Runs f(short_vec, long_vec, get_bounds) with the same band as dtwBanded, for x the long side.
+   * @details The recurrences above call Tcost(long_vec[i], short_vec[j]), i.e., Tcost(x[i], y[j]).
+   */
+  template <typename data_t, typename Tfun>
+  auto withBandBounds(const std::vector<data_t> &x, const std::vector<data_t> &y, int band, Tfun f)
+  {
+    const auto &short_vec = y, &long_vec = x;
+    const int m_short(short_vec.size()), m_long(long_vec.size());
+
+    if (band < 0 || m_long <= (band + 1)) // Full DTW.
+      return f(short_vec, long_vec, [m_long](int) { return std::pair(0, m_long); });
+
+    return f(short_vec, long_vec, sakoeChibaBounds(m_long, m_short, band));
+  }
+
+} // namespace detail
+
+/**
+ * @brief Computes the (banded) dynamic time warping distance with PrunedDTW.
+ *
+ * @details Same result as dtwBanded with the same band (full DTW for negative band). Cells
+ * which are more expensive than the cost of the diagonal path are not computed.
+ *
+ * @tparam data_t Data type of the elements in the sequences.
+ * @tparam Tcost Pointwise cost policy, see costs.hpp.
+ * @param x First sequence.
+ * @param y Second sequence.
+ * @param band The bandwidth parameter that controls the vicinity around the diagonal, -1 for full DTW.
+ * @param workspace Scratch memory, see DtwWorkspace.
+ * @return The dynamic time warping distance.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+data_t dtwPruned(const std::vector<data_t> &x, const std::vector<data_t> &y, int band, DtwWorkspace<data_t> &workspace)
+{
+  if (&x == &y) return 0; // If they are the same data then distance is 0.
+  if (x.size() <= 1 || y.size() <= 1) return dtwBanded<data_t, Tcost>(x, y, band, workspace); //<! Nothing to prune.
+  if (x.size() < y.size()) return dtwPruned<data_t, detail::swapped_t<Tcost>>(y, x, band, workspace); //<! So that x is the long side.
+
+  const auto result = detail::withBandBounds(x, y, band, [&workspace](const auto &short_vec, const auto &long_vec, auto get_bounds) {
+    const auto upper_bound = detail::diagonalPathCost<Tcost>(short_vec, long_vec, get_bounds);
+    return detail::dtwPrunedColumns<Tcost>(short_vec, long_vec, get_bounds, upper_bound, workspace);
+  });
+
+  return result.is_exact ? result.distance : dtwBanded<data_t, Tcost>(x, y, band, workspace); // Only if the band has no diagonal path.
+}
+
+/**
+ * @brief Computes the (banded) dynamic time warping distance with PrunedDTW, see above.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+data_t dtwPruned(const std::vector<data_t> &x, const std::vector<data_t> &y, int band = settings::DEFAULT_BAND_LENGTH)
+{
+  return dtwPruned<data_t, Tcost>(x, y, band, threadWorkspace<data_t>());
+}
+
+/**
+ * @brief Early-abandoning version of dtwPruned.
+ *
+ * @details Cells larger than min(best_so_far, cost of the diagonal path) are pruned.
+ *
+ * @tparam data_t Data type of the elements in the sequences.
+ * @tparam Tcost Pointwise cost policy, see costs.hpp.
+ * @param x First sequence.
+ * @param y Second sequence.
+ * @param band The bandwidth parameter that controls the vicinity around the diagonal, -1 for full DTW.
+ * @param best_so_far Upper bound of interest, e.g., the distance to the best candidate so far.
+ * @param workspace Scratch memory, see DtwWorkspace.
+ * @return The exact distance, or a lower bound larger than best_so_far with is_exact = false.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+DtwResult<data_t> dtwPruned(const std::vector<data_t> &x, const std::vector<data_t> &y, int band, data_t best_so_far, DtwWorkspace<data_t> &workspace)
+{
+  if (&x == &y) return { 0, true }; // If they are the same data then distance is 0.
+  if (x.size() <= 1 || y.size() <= 1) return dtwBanded<data_t, Tcost>(x, y, band, best_so_far, workspace); //<! Nothing to prune.
+  if (x.size() < y.size()) return dtwPruned<data_t, detail::swapped_t<Tcost>>(y, x, band, best_so_far, workspace); //<! So that x is the long side.
+
+  return detail::withBandBounds(x, y, band, [best_so_far, &workspace](const auto &short_vec, const auto &long_vec, auto get_bounds) {
+    const auto upper_bound = std::min(best_so_far, detail::diagonalPathCost<Tcost>(short_vec, long_vec, get_bounds));
+    return detail::dtwPrunedColumns<Tcost>(short_vec, long_vec, get_bounds, upper_bound, workspace);
+  });
+}
+
+/**
+ * @brief Early-abandoning version of dtwPruned, see above.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+DtwResult<data_t> dtwPruned(const std::vector<data_t> &x, const std::vector<data_t> &y, int band, data_t best_so_far)
+{
+  return dtwPruned<data_t, Tcost>(x, y, band, best_so_far, threadWorkspace<data_t>());
+}
+
+} // namespace dtwc
@@ -0,0 +1,281 @@
+/**
+ * @file warping_quantised.hpp
+ * @brief Quantised (int16) inter-pair SIMD dynamic time warping with saturating int32 costs.
+ *
+ * @details Series are quantised to int16 with one offset and scale per dataset (Quantiser), and
+ * the L1 cost |qx - qy| is accumulated in int32 lanes which saturate at INT32_MAX instead of
+ * overflowing. A vector then holds twice as many lanes as with double (16 per AVX-512 register)
+ * and the series take a quarter of the memory. Distances are rescaled to data_t on exit.
+ *
+ * Quantisation changes every pointwise cost by at most one quantisation step (scale), so the
+ * rescaled distance differs from the exact one by at most (n + m - 1) * scale; see
+ * Quantiser::tolerance. Integer data whose range fits in int16 (e.g., ADC readings) keep a unit
+ * scale and an integer offset, so that the result is exact.
+ *
+ * The kernel is compiled for several instruction sets and the one supported by the CPU is
+ * picked at runtime (see simd/cpu_dispatch.hpp).
+ *
+ * @date 17 Oct 2026
+ * @author Volkan Kumtepeli
+ * @author Becky Perriment
+ */
+
+#pragma once
+
+#include "settings.hpp"          // for DEFAULT_BAND_LENGTH
+#include "warping_batch.hpp"     // for detail::batchBounds, detail::dtwBatchGroups, DtwWorkspace
+#include "simd/cpu_dispatch.hpp" // for simd::level, DTWC_TARGET_*
+
+#include <cstddef>   // for size_t
+#include <cstdint>   // for int16_t, int32_t
+#include <algorithm> // for min, max, fill, copy
+#include <cmath>     // for round, floor, abs
+#include <limits>    // for numeric_limits
+#include <stdexcept> // for runtime_error
+#include <vector>    // for vector
+
+namespace dtwc {
+
+/**
+ * @brief Scratch memory of the quantised kernels: int16 series and int32 costs.
+ */
+using QuantisedWorkspace = DtwWorkspace<int16_t, int32_t>;
+
+/**
+ * @brief Affine map between data_t values and int16 codes: x ~ offset + scale * q.
+ */
+template <typename data_t>
+struct Quantiser
+{
+  static constexpr int max_code = std::numeric_limits<int16_t>::max(); //!< Codes are in [-max_code, max_code].
+  static constexpr int32_t saturated = std::numeric_limits<int32_t>::max();
+
+  data_t offset{ 0 };  //!< Value of code 0.
+  data_t scale{ 1 };   //!< Value of one quantisation step.
+  bool exact{ false }; //!< Codes represent the fitted values without rounding error.
+
+  /**
+   * @brief Fits the offset and scale so that all values of all series use the full int16 range.
+   * @details Integer data spanning at most 2 * max_code keep a unit scale and an integer offset
+   * instead, so that they are quantised exactly.
+   * @param series Data of the whole dataset.
+   */
+  static Quantiser fit(const std::vector<std::vector<data_t>> &series)
+  {
+    data_t lo = std::numeric_limits<data_t>::max(), hi = std::numeric_limits<data_t>::lowest();
+    bool integer = true;
+    for (const auto &x : series)
+      for (const auto v : x) {
+        lo = std::min(lo, v);
+        hi = std::max(hi, v);
+        integer = integer && (std::floor(v) == v);
+      }
+
+    if (lo > hi) return {}; // No data.
+
+    const data_t range = hi - lo;
+    if (integer && range <= 2 * max_code)
+      return { lo + std::floor(range / 2), data_t(1), true };
+
+    return { lo + range / 2, (range > 0) ? range / (2 * max_code) : data_t(1) };
+  }
+
+  /**
+   * @brief Quantises a series; values outside the fitted range are clamped.
+   */
+  std::vector<int16_t> quantise(const std::vector<data_t> &x) const
+  {
+    std::vector<int16_t> q(x.size());
+    for (size_t i = 0; i < x.size(); i++) {
+      const auto code = std::round((x[i] - offset) / scale);
+      q[i] = static_cast<int16_t>(std::max<data_t>(-max_code, std::min<data_t>(max_code, code)));
+    }
+
+    return q;
+  }
+
+  /**
+   * @brief Rescales a quantised distance; saturated distances are returned as maximum value of data_t.
+   */
+  data_t distance(int32_t raw) const { return (raw == saturated) ? std::numeric_limits<data_t>::max() : raw * scale; }
+
+  /**
+   * @brief Maximum difference between the rescaled and the exact DTW distance of series of lengths n and m
+   * whose values are within the fitted range.
+   */
+  data_t tolerance(size_t n, size_t m) const { return exact ? data_t(0) : (n + m - 1) * scale; }
+};
+
+namespace detail {
+
+  /**
+   * @brief Lane-wise quantised DTW recurrence for L candidates of length m against a query of length n.
+   * @details Same layout as dtwBatchLanes; cells saturate at INT32_MAX.
+   */
+  template <int L>
+  DTWC_ALWAYS_INLINE void dtwQuantisedLanes(const int16_t *query, int n, const int16_t *cand, int m,
+                                            const int *lo, const int *hi, int32_t *row0, int32_t *row1, int32_t *out)
+  {
+    constexpr int32_t maxValue = std::numeric_limits<int32_t>::max();
+
+    // Rows are indexed by the candidate index + 1, so that slot 0 (index -1) reads as maxValue.
+    std::fill(row0, row0 + (m + 1) * L, maxValue);
+    std::fill(row1, row1 + (m + 1) * L, maxValue);
+
+    int32_t *prev = row0, *curr = row1;
+    std::fill(prev, prev + L, 0); // Virtual C(-1, -1) = 0 so that C(0, 0) = dist(0, 0).
+
+    int lo_old{ 0 }; // Lower bound of the row which is being overwritten.
+    for (int q = 0; q < n; q++) {
+      std::fill(curr + (lo_old + 1) * L, curr + (std::max(lo[q], lo_old) + 1) * L, maxValue);
+      const int32_t qv = query[q];
+
+      for (int c = lo[q]; c < hi[q]; c++) {
+        const int32_t *up = prev + (c + 1) * L, *diag = prev + c * L, *left = curr + c * L;
+        const int16_t *cv = cand + c * L;
+        int32_t *cell = curr + (c + 1) * L;
+
+#pragma omp simd
+        for (int l = 0; l < L; l++) {
+          const int32_t dist = std::abs(qv - static_cast<int32_t>(cv[l]));
+          const int32_t best = std::min(std::min(up[l], diag[l]), left[l]); // Separate, or GCC does not if-convert the loop.
+          cell[l] = std::min(best, maxValue - dist) + dist;                  // Saturating addition.
+        }
+      }
+
+      if (q == 0) std::fill(prev, prev + L, maxValue);
+      lo_old = (q == 0) ? 0 : lo[q - 1];
+      std::swap(prev, curr);
+    }
+
+    std::copy(prev + m * L, prev + (m + 1) * L, out);
+  }
+
+#if DTWC_X86_DISPATCH
+  template <int L>
+  DTWC_TARGET_SSE42 void dtwQuantisedLanes_sse42(const int16_t *query, int n, const int16_t *cand, int m, const int *lo, const int *hi, int32_t *row0, int32_t *row1, int32_t *out)
+  {
+    dtwQuantisedLanes<L>(query, n, cand, m, lo, hi, row0, row1, out);
+  }
+
+  template <int L>
+  DTWC_TARGET_AVX2 void dtwQuantisedLanes_avx2(const int16_t *query, int n, const int16_t *cand, int m, const int *lo, const int *hi, int32_t *row0, int32_t *row1, int32_t *out)
+  {
+    dtwQuantisedLanes<L>(query, n, cand, m, lo, hi, row0, row1, out);
+  }
+
+  template <int L>
+  DTWC_TARGET_AVX512 void dtwQuantisedLanes_avx512(const int16_t *query, int n, const int16_t *cand, int m, const int *lo, const int *hi, int32_t *row0, int32_t *row1, int32_t *out)
+  {
+    dtwQuantisedLanes<L>(query, n, cand, m, lo, hi, row0, row1, out);
+  }
+#endif
+
+  template <int L>
+  void dtwQuantisedLanes_generic(const int16_t *query, int n, const int16_t *cand, int m, const int *lo, const int *hi, int32_t *row0, int32_t *row1, int32_t *out)
+  {
+    dtwQuantisedLanes<L>(query, n, cand, m, lo, hi, row0, row1, out);
+  }
+
+} // namespace detail
+
+/**
+ * @brief Computes the quantised (banded) DTW distances between a query and several candidates of the same length.
+ *
+ * @details Same band as dtwBanded. Distances are in quantisation steps; use Quantiser::distance to rescale them.
+ *
+ * @param query Quantised query sequence.
+ * @param candidates Pointers to n_cand quantised candidate sequences, all of the same length.
+ * @param n_cand Number of candidates.
+ * @param out Output array of n_cand distances, INT32_MAX if saturated (or if a sequence is empty).
+ * @param band The bandwidth parameter that controls the vicinity around the diagonal, -1 for full DTW.
+ * @param workspace Scratch memory, see DtwWorkspace.
+ * @throws std::runtime_error if the candidates have different lengths.
+ */
+inline void dtwBatchQuantised(const std::vector<int16_t> &query, const std::vector<int16_t> *const *candidates, int n_cand,
+                              int32_t *out, int band, QuantisedWorkspace &workspace)
+{
+  if (n_cand <= 0) return;
+
+  const int n = query.size(), m = candidates[0]->size();
+  for (int k = 1; k < n_cand; k++)
+    if (static_cast<int>(candidates[k]->size()) != m)
+      throw std::runtime_error("dtwBatchQuantised requires all candidates to have the same length.\n");
+
+  if (n == 0 || m == 0) {
+    std::fill(out, out + n_cand, std::numeric_limits<int32_t>::max());
+    return;
+  }
+
+  detail::batchBounds(n, m, band, workspace.lo, workspace.hi);
+
+  using kernel_t = void (*)(const int16_t *, int, const int16_t *, int, const int *, const int *, int32_t *, int32_t *, int32_t *);
+  constexpr int V = 4; // int32 lanes of a 128-bit vector.
+
+#if DTWC_X86_DISPATCH
+  switch (simd::level()) {
+  case simd::Level::AVX512:
+    return detail::dtwBatchGroups<int16_t, 8 * V, int32_t>(static_cast<kernel_t>(&detail::dtwQuantisedLanes_avx512<8 * V>), query, candidates, n_cand, workspace, out);
+  case simd::Level::AVX2:
+    return detail::dtwBatchGroups<int16_t, 4 * V, int32_t>(static_cast<kernel_t>(&detail::dtwQuantisedLanes_avx2<4 * V>), query, candidates, n_cand, workspace, out);
+  case simd::Level::SSE42:
+    return detail::dtwBatchGroups<int16_t, 2 * V, int32_t>(static_cast<kernel_t>(&detail::dtwQuantisedLanes_sse42<2 * V>), query, candidates, n_cand, workspace, out);
+  default:
+    break;
+  }
+#endif
+  detail::dtwBatchGroups<int16_t, 2 * V, int32_t>(static_cast<kernel_t>(&detail::dtwQuantisedLanes_generic<2 * V>), query, candidates, n_cand, workspace, out);
+}
+
+/**
+ * @brief Computes the quantised (banded) DTW distances between a query and several candidates of the same length, see above.
+ */
+inline void dtwBatchQuantised(const std::vector<int16_t> &query, const std::vector<int16_t> *const *candidates, int n_cand,
+                              int32_t *out, int band = settings::DEFAULT_BAND_LENGTH)
+{
+  dtwBatchQuantised(query, candidates, n_cand, out, band, threadWorkspace<int16_t, int32_t>());
+}
+
+/**
+ * @brief Convenience overload of dtwBatchQuantised returning the distances.
+ */
+inline std::vector<int32_t> dtwBatchQuantised(const std::vector<int16_t> &query, const std::vector<const std::vector<int16_t> *> &candidates,
+                                              int band = settings::DEFAULT_BAND_LENGTH)
+{
+  std::vector<int32_t> out(candidates.size());
+  dtwBatchQuantised(query, candidates.data(), static_cast<int>(candidates.size()), out.data(), band);
+  return out;
+}
+
+/**
+ * @brief Computes the quantised (banded) DTW distance of one pair, in quantisation steps.
+ * @param workspace Scratch memory, see DtwWorkspace.
+ * @return The distance, INT32_MAX if saturated or if a sequence is empty.
+ */
+inline int32_t dtwQuantised(const std::vector<int16_t> &x, const std::vector<int16_t> &y, int band, QuantisedWorkspace &workspace)
+{
+  if (&x == &y) return 0; // If they are the same data then distance is 0.
+
+  const int n = x.size(), m = y.size();
+  if (n == 0 || m == 0) return std::numeric_limits<int32_t>::max();
+
+  auto &lo = workspace.lo, &hi = workspace.hi;
+  auto &row0 = workspace.prev, &row1 = workspace.curr;
+  detail::batchBounds(n, m, band, lo, hi);
+  row0.resize(m + 1);
+  row1.resize(m + 1);
+
+  int32_t out;
+  detail::dtwQuantisedLanes_generic<1>(x.data(), n, y.data(), m, lo.data(), hi.data(), row0.data(), row1.data(), &out);
+  return out;
+}
+
+/**
+ * @brief Computes the quantised (banded) DTW distance of one pair, in quantisation steps, see above.
+ */
+inline int32_t dtwQuantised(const std::vector<int16_t> &x, const std::vector<int16_t> &y, int band = settings::DEFAULT_BAND_LENGTH)
+{
+  return dtwQuantised(x, y, band, threadWorkspace<int16_t, int32_t>());
+}
+
+} // namespace dtwc
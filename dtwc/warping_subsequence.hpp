@@ -0,0 +1,251 @@
+/**
+ * @file warping_subsequence.hpp
+ * @brief Subsequence dynamic time warping: best matches of a short query inside a long recording.
+ *
+ * @details A match may start and end anywhere in the recording (open-begin, open-end), so the
+ * first row of the cost matrix is free. The recording is processed in a single streaming pass
+ * with the single-row recurrence of dtwFull_L over the query, where every cell also keeps the
+ * start of its warping path (SPRING). Matches are at most max_length samples long (twice the query
+ * length by default): longer paths are dropped. Besides O(query length) for the recurrence, only the
+ * samples which live paths or the pending match may still cover are kept, so memory is
+ * O(query length + max_length) regardless of the recording length.
+ *
+ * Matches that overlap each other are reported once, as the best of them; the k best of these
+ * non-overlapping matches are kept. Once k matches are known, cells costlier than the k-th one
+ * are abandoned and the recurrence of a sample stops after the last live cell.
+ *
+ * After a match is reported, paths overlapping it are dropped, which may also drop the best path
+ * of a later match within its samples. Therefore, the distance of a match is computed with
+ * dtwFull_L over its samples when it is reported, so that matches are ranked by their exact distance.
+ *
+ * Reference: Y. Sakurai, C. Faloutsos and M. Yamamuro, "Stream monitoring under the time warping
+ *            distance". IEEE 23rd International Conference on Data Engineering, 1046-1055 (2007).
+ *
+ * @date 17 Oct 2026
+ * @author Volkan Kumtepeli
+ * @author Becky Perriment
+ */
+
+#pragma once
+
+#include "costs.hpp"   // for cost::L1
+#include "warping.hpp" // for dtwFull_L, DtwWorkspace
+
+#include <cstddef>   // for size_t
+#include <algorithm> // for min, push_heap, pop_heap, sort
+#include <limits>    // for numeric_limits
+#include <stdexcept> // for runtime_error
+#include <utility>   // for move
+#include <vector>    // for vector
+
+namespace dtwc {
+
+/**
+ * @brief A match of a query in a recording.
+ */
+template <typename data_t>
+struct SubsequenceMatch
+{
+  data_t distance{ std::numeric_limits<data_t>::max() }; //!< DTW distance between the query and recording[begin, end).
+  size_t begin{ 0 };                                     //!< Index of the first matched sample of the recording.
+  size_t end{ 0 };                                       //!< One past the index of the last matched sample.
+};
+
+/**
+ * @brief Streaming subsequence DTW search of a query in a recording, see warping_subsequence.hpp.
+ *
+ * @details Feed the recording with push() in as many pieces as convenient, then call finish().
+ *
+ * @tparam data_t Data type of the elements in the sequences.
+ * @tparam Tcost Pointwise cost policy, see costs.hpp.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+class SubsequenceSearch
+{
+  static constexpr data_t maxValue = std::numeric_limits<data_t>::max();
+
+  std::vector<data_t> query;
+  std::vector<data_t> D;    //!< Cost of the best path to each query index at the current sample.
+  std::vector<size_t> S;    //!< Start (sample index) of that path.
+  int live_end{ 0 };        //!< Cells from live_end on are maxValue.
+  size_t t{ 0 };            //!< Index of the next sample.
+  size_t k;                 //!< Number of matches to keep.
+  size_t max_length;        //!< Maximum number of samples of a match.
+  SubsequenceMatch<data_t> candidate; //!< Best match which may still be improved by an overlapping one.
+  std::vector<SubsequenceMatch<data_t>> best; //!< Max-heap of the k best reported matches.
+
+  std::vector<data_t> history; //!< Samples from history_begin on, which live paths or the candidate may cover.
+  size_t history_begin{ 0 };   //!< Index of the first sample in history.
+  std::vector<data_t> segment; //!< Samples of the candidate.
+  DtwWorkspace<data_t> workspace;
+
+  static bool worse(const SubsequenceMatch<data_t> &a, const SubsequenceMatch<data_t> &b) { return a.distance < b.distance; }
+
+  /// Threshold of interest: cost of the k-th best match so far.
+  data_t threshold() const { return (best.size() == k) ? best.front().distance : maxValue; }
+
+  void report()
+  {
+    segment.assign(history.begin() + (candidate.begin - history_begin), history.begin() + (candidate.end - history_begin));
+    candidate.distance = dtwFull_L<data_t, Tcost>(query, segment, workspace); // At most the cost of its path.
+
+    if (candidate.distance >= threshold()) return;
+    if (best.size() == k) {
+      std::pop_heap(best.begin(), best.end(), worse);
+      best.pop_back();
+    }
+    best.push_back(candidate);
+    std::push_heap(best.begin(), best.end(), worse);
+  }
+
+public:
+  /**
+   * @brief Prepares a search for the k best non-overlapping matches of query.
+   * @param query_ Short pattern to search for.
+   * @param k_ Number of matches.
+   * @param max_length_ Maximum number of samples of a match, 0 for twice the query length.
+   * @throws std::runtime_error if the query is empty or k is zero.
+   */
+  explicit SubsequenceSearch(std::vector<data_t> query_, size_t k_ = 1, size_t max_length_ = 0)
+    : query{ std::move(query_) }, D(query.size(), maxValue), S(query.size(), 0), k{ k_ },
+      max_length{ (max_length_ > 0) ? max_length_ : 2 * query.size() }
+  {
+    if (query.empty()) throw std::runtime_error("SubsequenceSearch: query should not be empty.\n");
+    if (k == 0) throw std::runtime_error("SubsequenceSearch: number of matches should be positive.\n");
+    best.reserve(k + 1);
+    history.reserve(2 * max_length + 1);
+  }
+
+  /**
+   * @brief Processes the next sample of the recording.
+   */
+  void push(data_t value)
+  {
+    const Tcost distance{};
+    const int m = query.size();
+    const data_t eps = threshold();
+    history.push_back(value);
+
+    // Column of sample t; up/diag are cells of sample t - 1, left is the cell below in this column.
+    // The free first row means that a path may start at any sample: C(t, 0) = dist(t, 0), S = t.
+    data_t diag = D[0];
+    size_t diag_s = S[0];
+    const data_t first = distance(query[0], value);
+    D[0] = (first > eps) ? maxValue : first;
+    S[0] = t;
+
+    const int live_prev = live_end;
+    int live = (D[0] < maxValue) ? 1 : 0;
+    bool blocked = (D[0] < candidate.distance && S[0] < candidate.end); // An overlapping path may still beat the candidate.
+
+    int i = 1;
+    for (; i < m; i++) {
+      const data_t up = D[i], left = D[i - 1];
+      const size_t up_s = S[i], left_s = S[i - 1];
+
+      data_t min_cost = diag;
+      size_t min_s = diag_s;
+      if (up < min_cost) min_cost = up, min_s = up_s;
+      if (left < min_cost) min_cost = left, min_s = left_s;
+
+      diag = up;
+      diag_s = up_s;
+
+      data_t cell = maxValue;
+      if (min_cost < maxValue && t - min_s < max_length) { // Longer paths cannot lead to a match.
+        cell = min_cost + distance(query[i], value);
+        if (cell > eps) cell = maxValue; // Cannot lead to one of the k best matches.
+      }
+
+      D[i] = cell;
+      S[i] = min_s;
+      if (cell < maxValue) {
+        live = i + 1;
+        blocked = blocked || (cell < candidate.distance && min_s < candidate.end);
+      }
+      else if (i >= live_prev)
+        break; // Cells of the previous sample from here on are maxValue, so are the rest of this column.
+    }
+    live_end = live;
+
+    // The candidate cannot be improved by any path overlapping it, so it is reported:
+    if (candidate.distance < maxValue && !blocked) {
+      report();
+      for (int r = 0; r < live_end; r++)
+        if (S[r] < candidate.end) D[r] = maxValue; // Paths overlapping the reported match.
+      candidate = {};
+    }
+
+    if (D[m - 1] < candidate.distance)
+      candidate = { D[m - 1], S[m - 1], t + 1 };
+
+    t++;
+
+    // Samples before the start of every live path and of the candidate are not needed anymore.
+    // These start at most max_length samples ago, so at most 2 * max_length samples are kept:
+    size_t oldest = (candidate.distance < maxValue) ? candidate.begin : t;
+    for (int r = 0; r < live_end; r++)
+      if (D[r] < maxValue) oldest = std::min(oldest, S[r]);
+
+    if (oldest - history_begin > history.size() / 2) { // Amortised O(1) per sample.
+      history.erase(history.begin(), history.begin() + (oldest - history_begin));
+      history_begin = oldest;
+    }
+  }
+
+  /**
+   * @brief Processes the next samples of the recording.
+   */
+  template <typename Tit>
+  void push(Tit first, Tit last)
+  {
+    for (; first != last; ++first)
+      push(*first);
+  }
+
+  /**
+   * @brief Reports the last pending match; call after the last sample.
+   */
+  void finish()
+  {
+    if (candidate.distance < maxValue) report();
+    candidate = {};
+  }
+
+  /**
+   * @brief The best non-overlapping matches reported so far, sorted by distance.
+   */
+  std::vector<SubsequenceMatch<data_t>> matches() const
+  {
+    auto out = best;
+    std::sort(out.begin(), out.end(), worse);
+    return out;
+  }
+
+  size_t samples() const { return t; }                 //!< Number of samples processed.
+  size_t keptSamples() const { return history.size(); } //!< Number of recent samples kept to compute the distances of matches.
+};
+
+/**
+ * @brief Finds the k best non-overlapping matches of a query in a recording with subsequence DTW.
+ *
+ * @tparam data_t Data type of the elements in the sequences.
+ * @tparam Tcost Pointwise cost policy, see costs.hpp.
+ * @param query Short pattern to search for.
+ * @param recording Long sequence to search in.
+ * @param k Number of matches.
+ * @param max_length Maximum number of samples of a match, 0 for twice the query length.
+ * @return Up to k matches sorted by distance; match.distance is dtwFull_L(query, recording[begin, end)).
+ * @throws std::runtime_error if the query is empty or k is zero.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+std::vector<SubsequenceMatch<data_t>> dtwSubsequence(const std::vector<data_t> &query, const std::vector<data_t> &recording, size_t k = 1,
+                                                     size_t max_length = 0)
+{
+  SubsequenceSearch<data_t, Tcost> search(query, k, max_length);
+  search.push(recording.begin(), recording.end());
+  search.finish();
+  return search.matches();
+}
+
+} // namespace dtwc
@@ -0,0 +1,198 @@
+/**
+ * @file warping_wavefront.hpp
+ * @brief Anti-diagonal (wavefront) dynamic time warping with SIMD dispatch.
+ *
+ * @details In dtwFull_L and dtwBanded every cell depends on its left neighbour in the same
+ * row, so the inner loop is serial. Cells on the same anti-diagonal i + j = d only depend
+ * on the two previous anti-diagonals, so they can be computed with vector instructions.
+ * Three anti-diagonals are kept in memory (O(n + m)), and the short sequence is stored
+ * reversed so that all loads in the inner loop are contiguous.
+ *
+ * The inner loop is compiled for several instruction sets and the fastest one supported by
+ * the CPU is picked at runtime (see simd/cpu_dispatch.hpp). Results are identical to
+ * dtwBanded (and dtwFull_L for negative band) for every path.
+ *
+ * @date 17 Oct 2026
+ * @author Volkan Kumtepeli
+ * @author Becky Perriment
+ */
+
+#pragma once
+
+#include "settings.hpp"          // for DEFAULT_BAND_LENGTH, WAVEFRONT_MIN_LENGTH
+#include "warping.hpp"           // for sakoeChibaBounds, dtwFull_L, DtwWorkspace
+#include "costs.hpp"             // for cost::L1
+#include "simd/cpu_dispatch.hpp" // for simd::level, DTWC_TARGET_*
+
+#include <cstddef>   // for size_t
+#include <algorithm> // for min, max, fill, reverse_copy
+#include <cmath>     // for abs
+#include <limits>    // for numeric_limits
+#include <tuple>     // for tie
+#include <vector>    // for vector
+
+namespace dtwc {
+
+namespace detail {
+
+  /**
+   * @brief Computes len cells of an anti-diagonal: out[k] = min(d1[k], d1[k + 1], d0[k]) + cost(lng[k], rev[k]).
+   *
+   * @details d0 and d1 point to the matching cells of the anti-diagonals d - 2 and d - 1; rev points
+   * into the reversed short sequence such that rev[k] is the element matched with lng[k].
+   */
+  template <typename data_t, typename Tcost>
+  DTWC_ALWAYS_INLINE void wavefrontStep(const data_t *d0, const data_t *d1, data_t *out,
+                                        const data_t *lng, const data_t *rev, int len)
+  {
+#pragma omp simd
+    for (int k = 0; k < len; ++k) {
+      const data_t best = std::min(std::min(d1[k], d1[k + 1]), d0[k]);
+      out[k] = best + Tcost{}(lng[k], rev[k]);
+    }
+  }
+
+#if DTWC_X86_DISPATCH
+  template <typename data_t, typename Tcost>
+  DTWC_TARGET_SSE42 void wavefrontStep_sse42(const data_t *d0, const data_t *d1, data_t *out, const data_t *lng, const data_t *rev, int len)
+  {
+    wavefrontStep<data_t, Tcost>(d0, d1, out, lng, rev, len);
+  }
+
+  template <typename data_t, typename Tcost>
+  DTWC_TARGET_AVX2 void wavefrontStep_avx2(const data_t *d0, const data_t *d1, data_t *out, const data_t *lng, const data_t *rev, int len)
+  {
+    wavefrontStep<data_t, Tcost>(d0, d1, out, lng, rev, len);
+  }
+
+  template <typename data_t, typename Tcost>
+  DTWC_TARGET_AVX512 void wavefrontStep_avx512(const data_t *d0, const data_t *d1, data_t *out, const data_t *lng, const data_t *rev, int len)
+  {
+    wavefrontStep<data_t, Tcost>(d0, d1, out, lng, rev, len);
+  }
+#endif
+
+  /**
+   * @brief Returns the anti-diagonal step function for the given instruction set level.
+   */
+  template <typename data_t, typename Tcost = cost::L1>
+  auto wavefrontStepFor(simd::Level lvl)
+  {
+    using step_t = void (*)(const data_t *, const data_t *, data_t *, const data_t *, const data_t *, int);
+#if DTWC_X86_DISPATCH
+    switch (lvl) {
+    case simd::Level::AVX512:
+      return static_cast<step_t>(&wavefrontStep_avx512<data_t, Tcost>);
+    case simd::Level::AVX2:
+      return static_cast<step_t>(&wavefrontStep_avx2<data_t, Tcost>);
+    case simd::Level::SSE42:
+      return static_cast<step_t>(&wavefrontStep_sse42<data_t, Tcost>);
+    default:
+      break;
+    }
+#endif
+    return static_cast<step_t>(&wavefrontStep<data_t, Tcost>);
+  }
+
+} // namespace detail
+
+/**
+ * @brief Computes the (banded) dynamic time warping distance by sweeping anti-diagonals.
+ *
+ * @details Same result as dtwBanded with the same band (full DTW for negative band), but the
+ * cells of each anti-diagonal are computed with SIMD instructions. It pays off for long
+ * sequences with wide (or no) bands; see wavefrontIsProfitable().
+ *
+ * @tparam data_t Data type of the elements in the sequences.
+ * @tparam Tcost Pointwise cost policy, see costs.hpp.
+ * @param x First sequence.
+ * @param y Second sequence.
+ * @param band The bandwidth parameter that controls the vicinity around the diagonal, -1 for full DTW.
+ * @param workspace Scratch memory, see DtwWorkspace.
+ * @return The dynamic time warping distance.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+data_t dtwWavefront(const std::vector<data_t> &x, const std::vector<data_t> &y, int band, DtwWorkspace<data_t> &workspace)
+{
+  if (&x == &y) return 0; // If they are the same data then distance is 0.
+  if (x.size() < y.size()) return dtwWavefront<data_t, detail::swapped_t<Tcost>>(y, x, band, workspace); //<! So that x is the long side.
+  constexpr data_t maxValue = std::numeric_limits<data_t>::max();
+
+  const auto &short_vec = y, &long_vec = x;
+  const int m_short(short_vec.size()), m_long(long_vec.size());
+
+  if ((m_short == 0) || (m_long == 0)) return maxValue;
+  if ((m_short == 1) || (m_long == 1)) return dtwFull_L<data_t, Tcost>(x, y, workspace); //<! Nothing to vectorise.
+
+  // Bounds [lo, hi) on the long side for every column of the short side:
+  auto &lo = workspace.lo, &hi = workspace.hi;
+  lo.assign(m_short, 0);
+  hi.assign(m_short, m_long);
+
+  if (band >= 0 && m_long > (band + 1)) { //<! Otherwise full DTW, same as dtwBanded.
+    const auto get_bounds = sakoeChibaBounds(m_long, m_short, band);
+    for (int j = 0; j < m_short; j++)
+      std::tie(lo[j], hi[j]) = get_bounds(j);
+  }
+
+  auto &rev = workspace.series, &buf0 = workspace.prev, &buf1 = workspace.curr, &buf2 = workspace.next;
+  rev.resize(m_short);
+  std::reverse_copy(short_vec.begin(), short_vec.end(), rev.begin());
+
+  buf0.assign(m_long + 1, maxValue);
+  buf1.assign(m_long + 1, maxValue);
+  buf2.assign(m_long + 1, maxValue);
+
+  data_t *d0 = buf0.data(), *d1 = buf1.data(), *d2 = buf2.data(); // Anti-diagonals d - 2, d - 1, d.
+
+  const auto step = detail::wavefrontStepFor<data_t, Tcost>(simd::level());
+
+  // [a, b) is the range of long-side indices on the current anti-diagonal; both ends are non-decreasing.
+  // [a1, b1), [a2, b2), [a3, b3) are the ranges of the previous three anti-diagonals.
+  int a{ 0 }, b{ 1 }, a1{ 0 }, b1{ 0 }, a2{ 0 }, b2{ 0 }, a3{ 0 }, b3{ 0 };
+  d2[1] = Tcost{}(long_vec[0], short_vec[0]); // d = 0
+
+  const int d_end = m_long + m_short - 1;
+  for (int d = 1; d < d_end; d++) {
+    std::tie(d0, d1, d2) = std::tuple(d1, d2, d0); // d2 now holds anti-diagonal d - 3, which will be overwritten.
+    std::tie(a3, b3, a2, b2, a1, b1) = std::tuple(a2, b2, a1, b1, a, b);
+
+    const int i_max = std::min(d, m_long - 1);
+    a = std::max(a, d - m_short + 1);
+    while (a <= i_max && a < lo[d - a]) ++a;
+
+    b = std::max(b, a);
+    while (b <= i_max && b < hi[d - b]) ++b;
+
+    // Cells of anti-diagonal d - 3 that fall outside the new range must read as maxValue:
+    std::fill(d2 + a3 + 1, d2 + std::max(a3, std::min(a, b3)) + 1, maxValue);
+
+    // Buffers are indexed by the long-side index + 1, so slot 0 (index -1) always reads as maxValue.
+    if (a < b) step(d0 + a, d1 + a, d2 + a + 1, long_vec.data() + a, rev.data() + (m_short - 1 - d + a), b - a);
+  }
+
+  return (b == m_long) ? d2[m_long] : maxValue;
+}
+
+/**
+ * @brief Computes the (banded) dynamic time warping distance by sweeping anti-diagonals, see above.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+data_t dtwWavefront(const std::vector<data_t> &x, const std::vector<data_t> &y, int band = settings::DEFAULT_BAND_LENGTH)
+{
+  return dtwWavefront<data_t, Tcost>(x, y, band, threadWorkspace<data_t>());
+}
+
+/**
+ * @brief Whether dtwWavefront is expected to be faster than dtwBanded for the given sizes.
+ *
+ * @details The vector length of the wavefront kernel is bounded by the shorter sequence and
+ * by the band width, and there is a fixed cost per anti-diagonal. Thresholds are in settings.hpp.
+ */
+inline bool wavefrontIsProfitable(size_t m_x, size_t m_y, int band)
+{
+  const bool wide = (band < 0) || (band >= settings::WAVEFRONT_MIN_BAND);
+  return wide && (std::min(m_x, m_y) >= settings::WAVEFRONT_MIN_LENGTH);
+}
+
+} // namespace dtwc
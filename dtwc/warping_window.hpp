@@ -0,0 +1,323 @@
+/**
+ * @file warping_window.hpp
+ * @brief Global constraints (warping windows) and step patterns for dynamic time warping.
+ *
+ * @details A WarpingWindow stores the allowed range [lo(i), hi(i)) of indices of the second
+ * sequence for every index i of the first one. It is computed once for a pair of lengths and
+ * can be reused for all pairs with the same lengths. Besides the Sakoe-Chiba band, the Itakura
+ * parallelogram and user-supplied windows are supported.
+ *
+ * References:
+ * - F. Itakura, "Minimum prediction residual principle applied to speech recognition".
+ *   IEEE Transactions on Acoustics, Speech, and Signal Processing, 23(1), 67-72 (1975).
+ * - H. Sakoe and S. Chiba, "Dynamic programming algorithm optimization for spoken word
+ *   recognition". IEEE Transactions on Acoustics, Speech, and Signal Processing, 26(1), 43-49 (1978).
+ *
+ * @date 17 Oct 2026
+ * @author Volkan Kumtepeli
+ * @author Becky Perriment
+ */
+
+#pragma once
+
+#include "settings.hpp" // for StepPattern
+#include "warping.hpp"  // for sakoeChibaBounds, DtwWorkspace
+#include "costs.hpp"    // for cost::L1, detail::PointCost
+
+#include <cstddef>   // for size_t
+#include <algorithm> // for min, max, fill
+#include <array>     // for array
+#include <cmath>     // for ceil, floor
+#include <limits>    // for numeric_limits
+#include <stdexcept> // for runtime_error
+#include <string>    // for to_string
+#include <tuple>     // for tie
+#include <utility>   // for move, swap
+#include <vector>    // for vector
+
+namespace dtwc {
+
+/**
+ * @brief Allowed cells of the cost matrix: indices [lo(i), hi(i)) of y for every index i of x.
+ */
+class WarpingWindow
+{
+  int n_cols{ 0 };
+  std::vector<int> lo_, hi_;
+
+  /// Makes sure that the window contains a warping path close to the diagonal.
+  void addDiagonalPath()
+  {
+    const long n = rows(), m = n_cols;
+    long b_prev{ -1 };
+    for (long i = 0; i < n; i++) {
+      const long b = (i == n - 1) ? m - 1 : ((m - 1) * (2 * i + 1)) / (2 * (n - 1)); // Last column of row i on the path.
+      const long a = (i == 0) ? 0 : std::min(b_prev + 1, b);                       // First column of row i on the path.
+      lo_[i] = std::min<int>(lo_[i], a);
+      hi_[i] = std::max<int>(hi_[i], b + 1);
+      b_prev = b;
+    }
+  }
+
+public:
+  WarpingWindow() = default;
+
+  /**
+   * @brief Full window (no constraint) for sequences of lengths n_x and n_y.
+   */
+  WarpingWindow(int n_x, int n_y) : n_cols{ n_y }, lo_(n_x, 0), hi_(n_x, n_y) {}
+
+  /**
+   * @brief User-supplied window.
+   * @param lo Lower bounds, lo[i] is the first allowed index of y for index i of x.
+   * @param hi Upper bounds (exclusive), hi[i] is one past the last allowed index of y for index i of x.
+   * @param n_y Length of y.
+   * @throws std::runtime_error if the bounds are not of the same size or not in [0, n_y].
+   */
+  WarpingWindow(std::vector<int> lo, std::vector<int> hi, int n_y) : n_cols{ n_y }, lo_{ std::move(lo) }, hi_{ std::move(hi) }
+  {
+    if (lo_.size() != hi_.size())
+      throw std::runtime_error("WarpingWindow: lower and upper bounds should be of the same size.\n");
+
+    for (size_t i = 0; i < lo_.size(); i++)
+      if (lo_[i] < 0 || lo_[i] >= hi_[i] || hi_[i] > n_y)
+        throw std::runtime_error("WarpingWindow: invalid bounds [" + std::to_string(lo_[i]) + ", " + std::to_string(hi_[i]) + ") for row " + std::to_string(i) + ".\n");
+  }
+
+  /**
+   * @brief Sakoe-Chiba band, same cells as dtwBanded.
+   * @param n_x Length of x.
+   * @param n_y Length of y.
+   * @param band The bandwidth parameter, -1 for full DTW.
+   */
+  static WarpingWindow sakoeChiba(int n_x, int n_y, int band)
+  {
+    WarpingWindow window(n_x, n_y);
+
+    const int m_long = std::max(n_x, n_y), m_short = std::min(n_x, n_y);
+    if (band < 0 || m_short <= 1 || m_long <= (band + 1)) return window; // Full DTW, same as dtwBanded.
+
+    const auto get_bounds = sakoeChibaBounds(m_long, m_short, band);
+    if (n_x < n_y) // x is the short side, so bounds are already per index of x.
+      for (int i = 0; i < n_x; i++)
+        std::tie(window.lo_[i], window.hi_[i]) = get_bounds(i);
+    else { // y is the short side; transpose the bounds. dtwBanded uses the second argument for ties.
+      std::fill(window.lo_.begin(), window.lo_.end(), n_y);
+      std::fill(window.hi_.begin(), window.hi_.end(), 0);
+      for (int j = 0; j < n_y; j++) {
+        const auto [low, high] = get_bounds(j);
+        for (int i = low; i < high; i++) {
+          window.lo_[i] = std::min(window.lo_[i], j);
+          window.hi_[i] = std::max(window.hi_[i], j + 1);
+        }
+      }
+    }
+
+    return window;
+  }
+
+  /**
+   * @brief Itakura parallelogram: the local slope of warping paths is limited to [1 / max_slope, max_slope].
+   *
+   * @details The parallelogram is drawn between the first and the last cells after normalising
+   * both axes to [0, 1], so it also works for sequences of different lengths. Cells of the
+   * diagonal path are always included, so a warping path exists even for short sequences.
+   *
+   * @param n_x Length of x.
+   * @param n_y Length of y.
+   * @param max_slope Maximum slope, should be larger than 1 (2 is the classical choice).
+   * @throws std::runtime_error if max_slope is not larger than 1.
+   */
+  static WarpingWindow itakura(int n_x, int n_y, double max_slope = 2.0)
+  {
+    if (max_slope <= 1)
+      throw std::runtime_error("WarpingWindow: Itakura parallelogram requires a maximum slope larger than 1.\n");
+
+    WarpingWindow window(n_x, n_y);
+    if (n_x <= 1 || n_y <= 1) return window;
+
+    constexpr double eps = 1e-9;
+    for (int i = 0; i < n_x; i++) {
+      const double u = static_cast<double>(i) / (n_x - 1);
+      const double v_lo = std::max(u / max_slope, 1 - max_slope * (1 - u));
+      const double v_hi = std::min(max_slope * u, 1 - (1 - u) / max_slope);
+
+      window.lo_[i] = std::max(static_cast<int>(std::ceil(v_lo * (n_y - 1) - eps)), 0);
+      window.hi_[i] = std::min(static_cast<int>(std::floor(v_hi * (n_y - 1) + eps)) + 1, n_y);
+    }
+
+    window.addDiagonalPath();
+    return window;
+  }
+
+  int rows() const { return static_cast<int>(lo_.size()); } //!< Length of x.
+  int cols() const { return n_cols; }                       //!< Length of y.
+
+  int lo(int i) const { return lo_[i]; } //!< First allowed index of y for index i of x.
+  int hi(int i) const { return hi_[i]; } //!< One past the last allowed index of y for index i of x.
+
+  bool contains(int i, int j) const { return lo_[i] <= j && j < hi_[i]; } //!< Whether cell (i, j) is allowed.
+
+  /**
+   * @brief Number of allowed cells, i.e., the work of a DTW computation with this window.
+   */
+  size_t cells() const
+  {
+    size_t sum{ 0 };
+    for (size_t i = 0; i < lo_.size(); i++)
+      sum += hi_[i] - lo_[i];
+
+    return sum;
+  }
+};
+
+namespace detail {
+
+  /**
+   * @brief Rolling rows of the cost matrix for windowed kernels.
+   *
+   * @details Rows have n_y elements; cells outside the window of a row read as maxValue.
+   * When a buffer is reused, only the cells of its old range are cleared.
+   */
+  template <typename data_t, int N_rows>
+  struct WindowRows
+  {
+    static constexpr data_t maxValue = std::numeric_limits<data_t>::max();
+
+    data_t *row[N_rows];
+    int lo[N_rows]{}, hi[N_rows]{}; // Range written in each row.
+
+    WindowRows(const std::array<std::vector<data_t> *, N_rows> &buf, int n_y)
+    {
+      for (int k = 0; k < N_rows; k++) {
+        buf[k]->assign(n_y, maxValue);
+        row[k] = buf[k]->data();
+      }
+    }
+
+    /// Rotates the rows so that row[N_rows - 1] can be written for range [lo_new, hi_new).
+    void rotate(int lo_new, int hi_new)
+    {
+      for (int k = 0; k + 1 < N_rows; k++) {
+        std::swap(row[k], row[k + 1]);
+        std::swap(lo[k], lo[k + 1]);
+        std::swap(hi[k], hi[k + 1]);
+      }
+
+      int &l = lo[N_rows - 1], &h = hi[N_rows - 1];
+      data_t *r = row[N_rows - 1];
+      std::fill(r + l, r + std::max(l, std::min(h, lo_new)), maxValue);
+      std::fill(r + std::min(std::max(l, hi_new), h), r + h, maxValue);
+      l = lo_new;
+      h = hi_new;
+    }
+  };
+
+} // namespace detail
+
+namespace detail {
+
+  /**
+   * @brief Recurrence of dtwWindowed for sequences of lengths n and m and cell cost cell(i, j), see dtwWindowed.
+   */
+  template <typename data_t, typename Tcell>
+  data_t dtwWindowedCells(int n, int m, const WarpingWindow &window, StepPattern pattern, const Tcell &cell, DtwWorkspace<data_t> &workspace)
+  {
+    constexpr data_t maxValue = std::numeric_limits<data_t>::max();
+
+    if (pattern == StepPattern::SymmetricP1) {
+      WindowRows<data_t, 3> g({ &workspace.prev, &workspace.curr, &workspace.next }, m); // g.row[0], g.row[1], g.row[2]: rows i - 2, i - 1, i.
+
+      auto from = [](data_t g_prev, data_t step) { return (g_prev == maxValue) ? maxValue : g_prev + step; };
+
+      for (int i = 0; i < n; i++) {
+        g.rotate(window.lo(i), window.hi(i));
+        const data_t *g0 = g.row[0], *g1 = g.row[1];
+        data_t *g2 = g.row[2];
+
+        for (int j = window.lo(i); j < window.hi(i); j++) {
+          const data_t d = cell(i, j);
+          if (i == 0 || j == 0) {
+            g2[j] = (i == 0 && j == 0) ? d : maxValue;
+            continue;
+          }
+
+          // Steps (1, 2) and (2, 1) also pass through a middle cell, which should be in the window.
+          data_t best = from(g1[j - 1], 2 * d);                                                                // (i - 1, j - 1)
+          if (j >= 2 && j - 1 >= window.lo(i)) best = std::min(best, from(g1[j - 2], 2 * cell(i, j - 1) + d)); // (i - 1, j - 2)
+          if (i >= 2 && window.contains(i - 1, j)) best = std::min(best, from(g0[j - 1], 2 * cell(i - 1, j) + d)); // (i - 2, j - 1)
+          g2[j] = best;
+        }
+      }
+
+      return g.row[2][m - 1];
+    }
+
+    WindowRows<data_t, 2> C({ &workspace.prev, &workspace.curr }, m); // C.row[0], C.row[1]: rows i - 1, i.
+
+    for (int i = 0; i < n; i++) {
+      C.rotate(window.lo(i), window.hi(i));
+      const data_t *prev = C.row[0];
+      data_t *curr = C.row[1];
+
+      data_t left = maxValue; // C(i, j - 1)
+      for (int j = window.lo(i); j < window.hi(i); j++) {
+        const data_t up = prev[j], diag = (j == 0) ? ((i == 0) ? data_t(0) : maxValue) : prev[j - 1];
+        left = curr[j] = std::min({ up, diag, left }) + cell(i, j);
+      }
+    }
+
+    return C.row[1][m - 1];
+  }
+
+  /// Throws if the window does not match the lengths n and m; caller is the name of the kernel.
+  inline void checkWindow(const WarpingWindow &window, int n, int m, const char *caller)
+  {
+    if (window.rows() != n || window.cols() != m)
+      throw std::runtime_error(std::string(caller) + ": window is for " + std::to_string(window.rows()) + " x " + std::to_string(window.cols()) + " but sequences are " + std::to_string(n) + " x " + std::to_string(m) + ".\n");
+  }
+
+} // namespace detail
+
+/**
+ * @brief Computes the dynamic time warping distance within a warping window.
+ *
+ * @details With StepPattern::Symmetric1 the result is the same as dtwBanded when the window is
+ * WarpingWindow::sakoeChiba(x.size(), y.size(), band). With StepPattern::SymmetricP1 the local
+ * slope is limited to [1/2, 2] (steps (1, 2), (1, 1) and (2, 1) with weights 1 + 2, 2 and 2 + 1),
+ * so pairs whose lengths differ more than a factor of two have no warping path.
+ *
+ * @tparam data_t Data type of the elements in the sequences.
+ * @tparam Tcost Pointwise cost policy, see costs.hpp.
+ * @param x First sequence.
+ * @param y Second sequence.
+ * @param window Allowed cells, with window.rows() == x.size() and window.cols() == y.size().
+ * @param pattern Step pattern.
+ * @param workspace Scratch memory, see DtwWorkspace.
+ * @return The dynamic time warping distance, or maximum value of data_t if there is no warping path.
+ * @throws std::runtime_error if the window does not match the lengths of the sequences.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+data_t dtwWindowed(const std::vector<data_t> &x, const std::vector<data_t> &y, const WarpingWindow &window,
+                   StepPattern pattern, DtwWorkspace<data_t> &workspace)
+{
+  const int n(x.size()), m(y.size());
+  detail::checkWindow(window, n, m, "dtwWindowed");
+
+  if (&x == &y) return 0; // If they are the same data then distance is 0.
+  if (n == 0 || m == 0) return std::numeric_limits<data_t>::max();
+
+  return detail::dtwWindowedCells<data_t>(n, m, window, pattern, detail::PointCost<data_t, Tcost>{ x.data(), y.data() }, workspace);
+}
+
+/**
+ * @brief Computes the dynamic time warping distance within a warping window, see above.
+ */
+template <typename data_t, typename Tcost = cost::L1>
+data_t dtwWindowed(const std::vector<data_t> &x, const std::vector<data_t> &y, const WarpingWindow &window,
+                   StepPattern pattern = StepPattern::Symmetric1)
+{
+  return dtwWindowed<data_t, Tcost>(x, y, window, pattern, threadWorkspace<data_t>());
+}
+
+} // namespace dtwc
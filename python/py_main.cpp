@@ -25,15 +25,19 @@ PYBIND11_MODULE(dtwcpp, m)
     .def("get_name", (const std::string &(Problem::*)(size_t) const) & Problem::get_name, py::return_value_policy::reference)
     .def("p_vec", (const std::vector<data_t> &(Problem::*)(size_t) const) & Problem::p_vec, py::return_value_policy::reference)
     .def("refreshDistanceMatrix", &Problem::refreshDistanceMatrix)
+    .def("appendSamples", &Problem::appendSamples)
     .def("resize", &Problem::resize)
     .def("centroid_of", &Problem::centroid_of)
     .def("readDistanceMatrix", &Problem::readDistanceMatrix)
+    .def("mapDistanceMatrix", &Problem::mapDistanceMatrix)
     .def("set_numberOfClusters", &Problem::set_numberOfClusters)
     .def("set_clusters", &Problem::set_clusters)
     .def("set_solver", &Problem::set_solver)
     .def("set_data", &Problem::set_data)
+    .def("append_data", &Problem::append_data)
+    .def("remove_data", &Problem::remove_data)
     .def("maxDistance", &Problem::maxDistance)
-    .def("distByInd", &Problem::distByInd)
+    .def("distByInd", (data_t(Problem::*)(int, int)) & Problem::distByInd)
     .def("isDistanceMatrixFilled", &Problem::isDistanceMatrixFilled)
     .def("fillDistanceMatrix", &Problem::fillDistanceMatrix)
     .def("printDistanceMatrix", &Problem::printDistanceMatrix)
@@ -23,13 +23,13 @@ namespace dtwc::test_util {
 template <typename data_t>
 std::vector<std::vector<data_t>> get_random_data(int N_data, int L_data)
 {
-  std::vector<std::vector<double>> random_data;
+  std::vector<std::vector<data_t>> random_data;
   std::uniform_int_distribution<> dis(0, L_data);
 
 
   for (int i = 0; i < N_data; ++i) {
     int innerSize = dis(randGenerator); // Random size for the inner vector
-    std::vector<double> innerVector;
+    std::vector<data_t> innerVector;
 
     for (int j = 0; j < innerSize; ++j)
       innerVector.push_back(dis(randGenerator)); // Generate random number
@@ -0,0 +1,206 @@
+/*
+ * unit_test_DistanceCache.cpp
+ *
+ * Unit test file for DistanceCache class
+ *  Created on: 17 Oct 2026
+ *   Author(s): Volkan Kumtepeli, Becky Perriment
+ */
+
+#include <dtwc.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_string.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include <omp.h>
+
+using namespace dtwc;
+
+TEST_CASE("DistanceCache class functionality", "[DistanceCache]")
+{
+  SECTION("Claim, publish and release")
+  {
+    DistanceCache<double> cache(4);
+    REQUIRE(cache.size() == 4);
+    REQUIRE(!cache.isReady(1, 2));
+    REQUIRE(cache(1, 2) == -1);
+
+    REQUIRE(cache.claim(1, 2));
+    REQUIRE(!cache.claim(2, 1)); // Same entry.
+    cache.release(2, 1);
+    REQUIRE(cache(1, 2) == -1);
+
+    REQUIRE(cache.claim(1, 2));
+    cache.publish(1, 2, 3.5);
+    REQUIRE(cache.isReady(2, 1));
+    REQUIRE(cache(2, 1) == 3.5);
+    REQUIRE(cache.wait(1, 2) == 3.5);
+    REQUIRE(!cache.claim(1, 2)); // Ready.
+    REQUIRE(cache.matrix()(2, 1) == 3.5);
+
+    cache.reset(1, 2);
+    REQUIRE(!cache.isReady(1, 2));
+    REQUIRE(cache.wait(1, 2) == -1);
+
+    cache.set(0, 3, 1.0);
+    const auto copy = cache;
+    REQUIRE(copy(3, 0) == 1.0);
+    REQUIRE(!copy.isReady(0, 0));
+  }
+
+  SECTION("Assigning a matrix")
+  {
+    DistanceMatrix<double> matrix(3);
+    matrix(0, 1) = 2;
+    matrix(1, 2) = 0;
+    DistanceCache<double> cache;
+    cache.assign(matrix);
+    REQUIRE(cache.size() == 3);
+    REQUIRE(cache.isReady(1, 0));
+    REQUIRE(cache.isReady(2, 1));
+    REQUIRE(!cache.isReady(0, 2)); // -1 is not computed.
+  }
+
+  SECTION("Failed computations are released")
+  {
+    DistanceCache<double> cache(2);
+    REQUIRE_THROWS(cache.get(0, 1, []() -> double { throw std::runtime_error("failed"); }));
+    REQUIRE(!cache.isReady(0, 1));
+    REQUIRE(cache.get(0, 1, [] { return 4.0; }) == 4.0);
+  }
+
+  SECTION("Each entry is computed once by concurrent threads")
+  {
+    const int N = 40, repeats = 8;
+    DistanceCache<double> cache(N);
+    std::vector<std::atomic<int>> computed(N * N);
+    std::atomic<int> wrong{ 0 };
+
+    auto task = [&](int k) {
+      const int i = (k / repeats) % N, j = (k * 7) % N; // Several threads ask for the same pairs.
+      const double value = cache.get(i, j, [&] {
+        computed[std::min(i, j) * N + std::max(i, j)]++;
+        volatile double sum{ 0 };
+        for (int r = 0; r < 1000; r++) sum = sum + r; // Widens the window for races.
+        return double(i + j);
+      });
+      if (value != i + j) wrong++; // Catch assertions are not thread-safe.
+    };
+
+    const int threads = omp_get_max_threads();
+    omp_set_num_threads(8);
+    run(task, N * N * repeats);
+    omp_set_num_threads(threads);
+
+    REQUIRE(wrong == 0);
+
+    for (int i = 0; i < N; i++)
+      for (int j = i; j < N; j++)
+        REQUIRE(computed[i * N + j] <= 1);
+  }
+
+  SECTION("Memory-mapped file")
+  {
+    const fs::path file = "test_distance_cache.bin";
+    fs::remove(file);
+    const size_t N = 100;
+    {
+      DistanceCache<double> cache;
+      REQUIRE(!cache.open(file, N)); // New file.
+      REQUIRE(cache.isMapped());
+      REQUIRE(cache.size() == N);
+      REQUIRE(cache.readyCount() == 0);
+      REQUIRE(cache(3, 90) == -1);
+
+      cache.set(3, 90, 2.5);
+      REQUIRE(cache.get(70, 99, [] { return 1.5; }) == 1.5);
+      REQUIRE(cache.claim(4, 5)); // Interrupted while computing.
+      cache.flush();
+
+      const auto copy = cache;
+      REQUIRE(!copy.isMapped());
+      REQUIRE(copy(90, 3) == 2.5);
+    }
+    REQUIRE(fs::file_size(file) > N * (N + 1) / 2 * (sizeof(double) + 1));
+
+    {
+      DistanceCache<double> cache;
+      REQUIRE(cache.open(file, N)); // Reused.
+      REQUIRE(cache.readyCount() == 2);
+      REQUIRE(cache(90, 3) == 2.5);
+      REQUIRE(cache(99, 70) == 1.5);
+      REQUIRE(cache.claim(4, 5)); // Emptied.
+      cache.release(4, 5);
+
+      REQUIRE(!cache.open(file, N, false)); // Not reused.
+      REQUIRE(cache.readyCount() == 0);
+      cache.set(1, 2, 3);
+
+      REQUIRE(!cache.open(file, N + 1)); // Other size.
+      REQUIRE(cache.size() == N + 1);
+      REQUIRE(cache(1, 2) == -1);
+
+      cache.set(1, 2, 3);
+      cache.resize(10); // Stays mapped, emptied.
+      REQUIRE(cache.isMapped());
+      REQUIRE(cache(1, 2) == -1);
+
+      cache.close();
+      REQUIRE(!cache.isMapped());
+      REQUIRE(cache.size() == 0);
+    }
+    fs::remove(file);
+
+    DistanceCache<double> cache;
+    REQUIRE_THROWS(cache.open(fs::path("missing_folder") / "cache.bin", N));
+    REQUIRE(!cache.isMapped());
+  }
+
+  SECTION("Reindexing keeps the computed entries")
+  {
+    for (const bool mapped : { false, true }) {
+      const fs::path file = "test_reindex_cache.bin";
+      const size_t N = 100;
+      DistanceCache<double> cache;
+      if (mapped)
+        cache.open(file, N, false, 3, 11);
+      else
+        cache.resize(N);
+
+      for (size_t i = 0; i < N; i += 2) // Every other entry.
+        for (size_t j = i; j < N; j++)
+          cache.set(i, j, i * 1000.0 + j);
+
+      const size_t ready = cache.readyCount();
+      std::vector<int> from(N + 50, -1); // Appended points.
+      for (size_t i = 0; i < N; i++) from[i] = i;
+      cache.reindex(from, 3, 12);
+      REQUIRE(cache.isMapped() == mapped);
+      REQUIRE(cache.size() == N + 50);
+      REQUIRE(cache(98, 99) == 98099);
+      REQUIRE(!cache.isReady(97, 99));
+      REQUIRE(!cache.isReady(0, N));
+      REQUIRE(cache.readyCount() == ready);
+
+      cache.reindex({ 98, 4, -1, 0 }, 3, 13); // Removed and reordered points.
+      REQUIRE(cache.size() == 4);
+      REQUIRE(cache(0, 1) == 4098);
+      REQUIRE(cache(1, 3) == 4);
+      REQUIRE(cache(0, 0) == 98098);
+      REQUIRE(!cache.isReady(2, 2));
+      REQUIRE(!cache.isReady(0, 2));
+
+      if (mapped) {
+        REQUIRE(!fs::exists(file.string() + ".tmp"));
+        REQUIRE(readMatrixHeader(file).data_hash == 13);
+        cache.close();
+        fs::remove(file);
+      }
+      REQUIRE_THROWS(cache.reindex({ 5 }));
+    }
+  }
+}
@@ -0,0 +1,167 @@
+/*
+ * unit_test_DistanceMatrix.cpp
+ *
+ * Unit test file for DistanceMatrix class
+ *  Created on: 17 Oct 2026
+ *   Author(s): Volkan Kumtepeli, Becky Perriment
+ */
+
+#include <dtwc.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_string.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+using namespace dtwc;
+
+TEST_CASE("DistanceMatrix class functionality", "[DistanceMatrix]")
+{
+  SECTION("Default constructor")
+  {
+    DistanceMatrix<double> matrix;
+    REQUIRE(matrix.size() == 0);
+    REQUIRE(matrix.toArma().n_rows == 0);
+  }
+
+  SECTION("Entries are symmetric and packed")
+  {
+    const size_t N = 7;
+    DistanceMatrix<double> matrix(N);
+    REQUIRE(matrix.size() == N);
+    REQUIRE(matrix(3, 5) == -1);
+    REQUIRE(matrix.bytes() == N * (N + 1) / 2 * sizeof(double)); // Half of the dense matrix.
+
+    std::set<const double *> addresses;
+    for (size_t i = 0; i < N; i++)
+      for (size_t j = i; j < N; j++) {
+        matrix(i, j) = 10.0 * i + j;
+        REQUIRE(&matrix(i, j) == &matrix(j, i));
+        addresses.insert(&matrix(i, j));
+      }
+    REQUIRE(addresses.size() == N * (N + 1) / 2);
+    REQUIRE(matrix(5, 3) == 35);
+    REQUIRE(matrix.max() == 66);
+
+    matrix.fill(2);
+    REQUIRE(matrix(6, 0) == 2);
+    matrix.resize(3, 0);
+    REQUIRE(matrix.size() == 3);
+    REQUIRE(matrix.max() == 0);
+  }
+
+  SECTION("Blocked row access and Armadillo export")
+  {
+    const size_t N = 9;
+    DistanceMatrix<double> matrix(N);
+    for (size_t i = 0; i < N; i++)
+      for (size_t j = i; j < N; j++)
+        matrix(i, j) = (i == j) ? 0 : 1.0 + i * j + i + j;
+
+    const auto dense = matrix.toArma();
+    REQUIRE(dense.n_rows == N);
+    REQUIRE(dense.n_cols == N);
+
+    std::vector<double> row;
+    for (size_t i = 0; i < N; i++) {
+      matrix.row(i, row);
+      REQUIRE(row.size() == N);
+      for (size_t j = 0; j < N; j++) {
+        REQUIRE(row[j] == matrix(i, j));
+        REQUIRE(dense(i, j) == matrix(i, j));
+      }
+
+      for (size_t first = 0; first <= N; first++)
+        for (size_t last = first; last <= N; last++) {
+          std::vector<double> block(last - first, -5);
+          matrix.row(i, first, last, block.data());
+          for (size_t j = first; j < last; j++)
+            REQUIRE(block[j - first] == matrix(i, j));
+        }
+    }
+
+    const DistanceMatrix<double> copy(dense);
+    REQUIRE(copy.size() == N);
+    for (size_t i = 0; i < N; i++)
+      for (size_t j = 0; j < N; j++)
+        REQUIRE(copy(i, j) == matrix(i, j));
+
+    REQUIRE_THROWS(DistanceMatrix<double>(arma::Mat<double>(2, 3)));
+  }
+
+  SECTION("Tile-ordered layout")
+  {
+    const size_t N = 2 * DistanceMatrix<double>::tile + 22; // The last tile row is partial.
+    DistanceMatrix<double> matrix(N);
+    REQUIRE(matrix.tileRows() == 3);
+    REQUIRE(matrix.bytes() == N * (N + 1) / 2 * sizeof(double));
+
+    std::vector<int> used(matrix.entries(), 0);
+    for (size_t i = 0; i < N; i++)
+      for (size_t j = i; j < N; j++) {
+        REQUIRE(matrix.index(i, j) < matrix.entries());
+        used[matrix.index(i, j)]++;
+        matrix(i, j) = 1000.0 * i + j;
+      }
+    REQUIRE(static_cast<size_t>(std::count(used.begin(), used.end(), 1)) == matrix.entries()); // Every position once.
+
+    std::vector<double> row;
+    for (size_t i = 0; i < N; i++) {
+      matrix.row(i, row);
+      for (size_t j = 0; j < N; j++)
+        REQUIRE(row[j] == matrix(i, j));
+    }
+
+    size_t visited = 0, previous = 0;
+    bool in_order = true, correct = true;
+    matrix.forEachPair([&](size_t i, size_t j, double value) {
+      correct = correct && i < j && value == 1000.0 * i + j;
+      in_order = in_order && (visited == 0 || matrix.index(i, j) > previous); // Storage order.
+      previous = matrix.index(i, j);
+      visited++;
+    });
+    REQUIRE(correct);
+    REQUIRE(in_order);
+    REQUIRE(visited == N * (N - 1) / 2);
+    REQUIRE(matrix.max() == 1000.0 * (N - 1) + N - 1);
+
+    std::vector<double> external(matrix.entries());
+    DistanceMatrix<double> attached;
+    attached.attach(N, external.data());
+    REQUIRE(attached.isAttached());
+    attached(5, 130) = 7;
+    REQUIRE(external[attached.index(130, 5)] == 7);
+
+    const auto copy = attached; // Copies own their entries.
+    REQUIRE(!copy.isAttached());
+    REQUIRE(copy(130, 5) == 7);
+  }
+
+  SECTION("Writing and reading")
+  {
+    const size_t N = 6;
+    DistanceMatrix<double> matrix(N);
+    for (size_t i = 0; i < N; i++)
+      for (size_t j = i; j < N; j++)
+        matrix(i, j) = 0.1 * (i + 1) * (j + 3);
+
+    fs::path tempFilePath = "test_distance_matrix.csv";
+    writeMatrix(matrix, tempFilePath);
+
+    arma::Mat<double> dense;
+    readMatrix(dense, tempFilePath);
+    REQUIRE(arma::approx_equal(dense, matrix.toArma(), "absdiff", 1e-12));
+
+    DistanceMatrix<double> readMat;
+    readMatrix(readMat, tempFilePath);
+    REQUIRE(readMat.size() == N);
+    for (size_t i = 0; i < N; i++)
+      for (size_t j = 0; j < N; j++)
+        REQUIRE_THAT(readMat(i, j), Catch::Matchers::WithinAbs(matrix(i, j), 1e-12));
+
+    fs::remove(tempFilePath);
+  }
+}
@@ -0,0 +1,81 @@
+/*
+ * unit_test_ShardFile.cpp
+ *
+ * Unit test file for ShardFile class
+ *  Created on: 17 Oct 2026
+ *   Author(s): Volkan Kumtepeli, Becky Perriment
+ */
+
+#include <dtwc.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_string.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+using namespace dtwc;
+
+TEST_CASE("ShardFile class functionality", "[ShardFile]")
+{
+  const fs::path file = "test_shard_file.bin";
+  const size_t N = 150, T = DistanceMatrix<double>::tile; // 3 x 3 tiles, the last ones partial.
+  const size_t corner = (N - 2 * T) * (N - 2 * T + 1) / 2, record = 2 * sizeof(uint32_t);
+  fs::remove(file);
+
+  std::vector<uint8_t> done;
+  ShardFile<double> shard(file);
+  REQUIRE(shard.start(N, 4, 77, 9, true, done) == 0); // No shard yet.
+  REQUIRE(done.size() == 1);
+  REQUIRE(readMatrixHeader(file).isValid());
+  REQUIRE(fs::file_size(file) == sizeof(DistanceFileHeader));
+
+  std::vector<double> first(T * T, 0.5), last(corner, 2.0);
+  REQUIRE(shard.save(0, 1, first.data(), first.size()));
+  REQUIRE(shard.save(2, 2, last.data(), last.size()));
+  REQUIRE(shard.savedTiles() == 2);
+  REQUIRE(fs::file_size(file) == sizeof(DistanceFileHeader) + 2 * record + (T * T + corner) * sizeof(double)); // Only its tiles.
+
+  SECTION("Loading calls back for each tile")
+  {
+    std::vector<std::pair<size_t, size_t>> tiles;
+    double sum = 0;
+    const auto count = ShardFile<double>::load(file, N, 4, 77, 9, [&](size_t ti, size_t tj, const double *entries, size_t n) {
+      tiles.emplace_back(ti, tj);
+      for (size_t k = 0; k < n; k++) sum += entries[k];
+    });
+    REQUIRE(count == 2);
+    REQUIRE(tiles == std::vector<std::pair<size_t, size_t>>{ { 0, 1 }, { 2, 2 } });
+    REQUIRE(sum == 0.5 * T * T + 2.0 * corner);
+
+    auto ignore = [](size_t, size_t, const double *, size_t) {};
+    REQUIRE(!ShardFile<double>::load(file, N, 5, 77, 9, ignore)); // Other band.
+    REQUIRE(!ShardFile<double>::load(file, N, 4, 77, 10, ignore)); // Other configuration.
+    REQUIRE(!ShardFile<double>::load(file, N + 1, 4, 77, 9, ignore));
+
+    DistanceMatrix<double> matrix; // Not a whole matrix.
+    REQUIRE_THROWS(readBinaryMatrix(matrix, file));
+  }
+
+  SECTION("Resuming keeps the complete records only")
+  {
+    fs::resize_file(file, fs::file_size(file) - 8); // Killed while writing tile (2, 2).
+    ShardFile<double> again(file);
+    REQUIRE(again.start(N, 4, 77, 9, true, done) == 1);
+    REQUIRE(done[0] == 0b10); // Tile (0, 1).
+    REQUIRE(fs::file_size(file) == sizeof(DistanceFileHeader) + record + T * T * sizeof(double));
+
+    REQUIRE(again.save(2, 2, last.data(), last.size()));
+    REQUIRE(ShardFile<double>(file).start(N, 4, 77, 9, true, done) == 2);
+    REQUIRE(done[0] == 0b100010); // Tiles (0, 1) and (2, 2).
+  }
+
+  SECTION("Other shards are overwritten")
+  {
+    ShardFile<double> again(file);
+    REQUIRE(again.start(N, 5, 77, 9, true, done) == 0); // Other band.
+    REQUIRE(again.start(N, 4, 77, 9, false, done) == 0);
+    REQUIRE(done[0] == 0);
+    REQUIRE(fs::file_size(file) == sizeof(DistanceFileHeader));
+  }
+
+  fs::remove(file);
+}
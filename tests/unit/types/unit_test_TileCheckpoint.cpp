@@ -0,0 +1,83 @@
+/*
+ * unit_test_TileCheckpoint.cpp
+ *
+ * Unit test file for TileCheckpoint class
+ *  Created on: 17 Oct 2026
+ *   Author(s): Volkan Kumtepeli, Becky Perriment
+ */
+
+#include <dtwc.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_string.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+using namespace dtwc;
+
+TEST_CASE("TileCheckpoint class functionality", "[TileCheckpoint]")
+{
+  const fs::path file = "test_checkpoint.bin";
+  const size_t N = 150, T = DistanceMatrix<double>::tile; // 3 x 3 tiles, the last ones partial.
+  fs::remove(file);
+
+  DistanceCache<double> cache(N);
+  TileCheckpoint<double> checkpoint(file, 3600);
+  REQUIRE(checkpoint.start(cache, 4, 77, 9, true) == 0); // No checkpoint yet.
+  REQUIRE(readMatrixHeader(file).isValid());
+
+  for (size_t i = 0; i < T; i++) // Tile (0, 0) and part of tile (0, 1).
+    for (size_t j = i; j < T + 10; j++)
+      cache.set(i, j, i + 0.5 * j);
+
+  REQUIRE(!checkpoint.save(cache)); // Too early.
+  REQUIRE(checkpoint.save(cache, true));
+  REQUIRE(checkpoint.savedTiles() == 1);
+  REQUIRE(!checkpoint.save(cache, true)); // Nothing new.
+
+  for (size_t i = 2 * T; i < N; i++) // Tile (2, 2).
+    for (size_t j = i; j < N; j++)
+      cache.set(i, j, 1);
+  REQUIRE(checkpoint.save(cache, true));
+  REQUIRE(checkpoint.savedTiles() == 2);
+
+  SECTION("Resuming loads the complete tiles only")
+  {
+    DistanceCache<double> resumed(N);
+    TileCheckpoint<double> again(file, 3600);
+    REQUIRE(again.start(resumed, 4, 77, 9, true) == 2);
+    REQUIRE(resumed.readyCount() == T * (T + 1) / 2 + (N - 2 * T) * (N - 2 * T + 1) / 2);
+    REQUIRE(resumed(3, T - 1) == 3 + 0.5 * (T - 1));
+    REQUIRE(!resumed.isReady(0, T)); // Incomplete tile (0, 1).
+    REQUIRE(resumed(N - 1, N - 1) == 1);
+
+    DistanceMatrix<double> matrix; // Also a binary distance matrix file.
+    readBinaryMatrix(matrix, file);
+    REQUIRE(matrix(3, T - 1) == 3 + 0.5 * (T - 1));
+  }
+
+  SECTION("Loading leaves the file as it is")
+  {
+    DistanceCache<double> loaded(N);
+    std::vector<uint8_t> bitmap((loaded.matrix().tiles() + 7) / 8, 0);
+    REQUIRE(!TileCheckpoint<double>::load(file, loaded, 5, 77, 9, bitmap)); // Other band.
+    REQUIRE(!TileCheckpoint<double>::load(file, loaded, 4, 77, 10, bitmap)); // Other configuration.
+    REQUIRE(loaded.readyCount() == 0);
+    REQUIRE(TileCheckpoint<double>::load(file, loaded, 4, 77, 9, bitmap) == 2);
+    REQUIRE(bitmap[0] == 0b100001); // Tiles (0, 0) and (2, 2).
+    REQUIRE(TileCheckpoint<double>::load(file, loaded, 4, 77, 9, bitmap) == 2);
+
+    DistanceCache<double> resumed(N);
+    REQUIRE(TileCheckpoint<double>(file, 3600).start(resumed, 4, 77, 9, true) == 2);
+  }
+
+  SECTION("Other checkpoints are overwritten")
+  {
+    DistanceCache<double> other(N);
+    TileCheckpoint<double> again(file, 3600);
+    REQUIRE(again.start(other, 5, 77, 9, true) == 0); // Other band.
+    REQUIRE(again.start(other, 4, 77, 9, false) == 0);
+    REQUIRE(again.savedTiles() == 0);
+  }
+
+  fs::remove(file);
+}
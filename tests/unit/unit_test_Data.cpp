@@ -62,4 +62,23 @@ TEST_CASE("Data class functionality", "[Data]")
 
     REQUIRE_THROWS_AS(Data(std::move(testVec), std::move(testNames)), std::exception);
   }
-}
\ No newline at end of file
+
+  SECTION("Multichannel data are channel-interleaved")
+  {
+    Data data({ { 1, 2, 3, 4, 5, 6 }, { 1, 2 } }, { "One", "Two" }, 2);
+    REQUIRE(data.ndim == 2);
+    REQUIRE(data.length(0) == 3);
+    REQUIRE(data.length(1) == 1);
+
+    REQUIRE_THROWS_AS(Data({ { 1, 2, 3 } }, { "One" }, 2), std::exception);
+  }
+
+  SECTION("Hash identifies the data vectors")
+  {
+    const Data data({ { 1, 2, 3 }, { 4 } }, { "One", "Two" });
+    REQUIRE(data.hash() == Data({ { 1, 2, 3 }, { 4 } }, { "Three", "Four" }).hash()); // Names do not matter.
+    REQUIRE(data.hash() != Data({ { 1, 2 }, { 3, 4 } }, { "One", "Two" }).hash());
+    REQUIRE(data.hash() != Data({ { 1, 2, 3 }, { 5 } }, { "One", "Two" }).hash());
+    REQUIRE(data.hash() != Data({ { 1, 2, 3, 4 } }, { "One" }, 2).hash());
+  }
+}
@@ -13,6 +13,7 @@
 #include <catch2/matchers/catch_matchers_string.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
 
+#include <fstream>
 #include <sstream>
 #include <thread>
 
@@ -84,4 +85,46 @@ TEST_CASE("DataLoader class functionality", "[DataLoader]")
     REQUIRE(loader.path() == testPath);
     REQUIRE(loader.verbosity() == 1);
   }
+}
+
+TEST_CASE("DataLoader multichannel data", "[DataLoader]")
+{
+  const auto folder = fs::temp_directory_path() / "dtwc_multichannel_test";
+  fs::create_directories(folder);
+
+  SECTION("Folder with one series per file")
+  {
+    { // Index column, two channels and a column which is not read.
+      std::ofstream file(folder / "a.csv");
+      file << "t,V,I,T\n0,3.0,1.5,25\n1,3.1,1.4,25\n2,3.2,1.3,26\n";
+    }
+
+    const auto data = DataLoader(folder).startRow(1).startColumn(1).ndim(2).verbosity(0).load();
+    REQUIRE(data.ndim == 2);
+    REQUIRE(data.size() == 1);
+    REQUIRE(data.length(0) == 3);
+    REQUIRE(data.p_vec[0] == std::vector<data_t>{ 3.0, 1.5, 3.1, 1.4, 3.2, 1.3 });
+
+    REQUIRE_THROWS(DataLoader(folder).startRow(1).startColumn(1).ndim(4).verbosity(0).load()); // Not enough columns.
+    fs::remove(folder / "a.csv");
+  }
+
+  SECTION("Batch file with one channel-interleaved series per row")
+  {
+    const auto path = folder / "batch.csv";
+    {
+      std::ofstream file(path);
+      file << "1,2,3,4\n5,6\n";
+    }
+
+    const auto data = DataLoader(path).ndim(2).verbosity(0).load();
+    REQUIRE(data.ndim == 2);
+    REQUIRE(data.length(0) == 2);
+    REQUIRE(data.length(1) == 1);
+
+    REQUIRE_THROWS(DataLoader(path).ndim(3).verbosity(0).load()); // 4 values are not a multiple of 3 channels.
+    fs::remove(path);
+  }
+
+  fs::remove_all(folder);
 }
\ No newline at end of file
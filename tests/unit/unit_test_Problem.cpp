@@ -8,11 +8,14 @@
  */
 
 #include <dtwc.hpp>
+#include "../test_util.hpp"
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_string.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
 
+#include <thread>
+
 using Catch::Matchers::WithinAbs;
 
 using namespace dtwc;
@@ -86,4 +89,764 @@ TEST_CASE("dtwBanded_test", "[dtwBanded]")
   // Empty vector should give infinite cost.
   REQUIRE(dtwBanded<data_t>(x, empty) > 1e10);
   REQUIRE(dtwBanded<data_t>(empty, x) > 1e10);
-}
\ No newline at end of file
+}
+
+TEST_CASE("fillDistanceMatrix_test", "[Problem]")
+{
+  std::uniform_real_distribution<data_t> dis(-1, 1);
+  auto random_series = [&](int N, int L) {
+    std::vector<std::vector<data_t>> p_vec(N, std::vector<data_t>(L));
+    for (auto &p : p_vec)
+      for (auto &v : p) v = dis(randGenerator);
+    return p_vec;
+  };
+
+  for (int band : { -1, 3 }) {
+    SECTION("Equal lengths use the batch kernel, band = " + std::to_string(band))
+    {
+      auto p_vec = random_series(23, 40);
+      auto p_vec_copy = p_vec;
+      std::vector<std::string> names(p_vec.size(), "a");
+
+      dtwc::Problem prob{ "equal_lengths" };
+      prob.band = band;
+      prob.set_data(Data(std::move(p_vec), std::move(names)));
+      prob.fillDistanceMatrix();
+
+      REQUIRE(prob.isDistanceMatrixFilled());
+      for (int i = 0; i < prob.size(); i++)
+        for (int j = 0; j < prob.size(); j++)
+          REQUIRE_THAT(prob.distByInd(i, j), WithinAbs(dtwBanded(p_vec_copy[i], p_vec_copy[j], band), 1e-12));
+
+      REQUIRE(prob.workspaceBytes() > 0); // Scratch memory of the batch kernel is kept by its worker.
+      prob.releaseWorkspaces();
+      REQUIRE(prob.workspaceBytes() == 0);
+    }
+
+    for (auto kernel : { DtwKernel::Banded, DtwKernel::Wavefront, DtwKernel::Pruned })
+      SECTION("Selected kernel " + std::to_string(static_cast<int>(kernel)) + ", band = " + std::to_string(band))
+      {
+        auto p_vec = test_util::get_random_data<data_t>(25, 60);
+        auto p_vec_copy = p_vec;
+        std::vector<std::string> names(p_vec.size(), "a");
+
+        dtwc::Problem prob{ "kernels" };
+        prob.band = band;
+        prob.kernel = kernel;
+        prob.set_data(Data(std::move(p_vec), std::move(names)));
+        prob.fillDistanceMatrix();
+
+        for (int i = 0; i < prob.size(); i++)
+          for (int j = 0; j < prob.size(); j++)
+            if (i != j) // dtwBanded does not check whether both series are the same.
+              REQUIRE_THAT(prob.distByInd(i, j), WithinAbs(dtwBanded(p_vec_copy[i], p_vec_copy[j], band), 1e-9));
+      }
+  }
+
+  SECTION("Squared L2 cost")
+  {
+    for (const int L_data : { 0, 40 }) // Random lengths (single pairs), then equal lengths (batches).
+      for (auto kernel : { DtwKernel::Auto, DtwKernel::Pruned, DtwKernel::Quantised }) {
+        auto p_vec = (L_data > 0) ? random_series(12, L_data) : test_util::get_random_data<data_t>(12, 60);
+        auto p_vec_copy = p_vec;
+        std::vector<std::string> names(p_vec.size(), "a");
+
+        dtwc::Problem prob{ "squared_l2" };
+        prob.band = 3;
+        prob.kernel = kernel;
+        prob.point_cost = DtwCost::SquaredL2;
+        prob.set_data(Data(std::move(p_vec), std::move(names)));
+        prob.fillDistanceMatrix();
+        REQUIRE(!prob.isApproximateDTW()); // Quantised kernel is for the L1 cost only.
+
+        for (int i = 0; i < prob.size(); i++)
+          for (int j = 0; j < prob.size(); j++)
+            if (i != j)
+              REQUIRE_THAT(prob.distByInd(i, j), WithinAbs((dtwBanded<data_t, cost::SquaredL2>(p_vec_copy[i], p_vec_copy[j], 3)), 1e-9));
+      }
+  }
+
+  SECTION("Approximate kernel")
+  {
+    auto p_vec = test_util::get_random_data<data_t>(15, 200);
+    auto p_vec_copy = p_vec;
+    std::vector<std::string> names(p_vec.size(), "a");
+
+    dtwc::Problem prob{ "fast" };
+    prob.band = -1;
+    prob.kernel = DtwKernel::Fast;
+    prob.fast_radius = 2;
+    prob.set_data(Data(std::move(p_vec), std::move(names)));
+    prob.fillDistanceMatrix();
+
+    for (int i = 0; i < prob.size(); i++)
+      for (int j = 0; j < prob.size(); j++)
+        if (i != j && !p_vec_copy[i].empty() && !p_vec_copy[j].empty())
+          REQUIRE(prob.distByInd(i, j) >= dtwFull_L(p_vec_copy[i], p_vec_copy[j]) * (1 - 1e-5));
+
+    const auto error = prob.approximationError(50);
+    REQUIRE(error.N_pairs > 0);
+    REQUIRE(error.mean >= -1e-5);
+    REQUIRE(error.max >= error.mean);
+
+    const auto again = prob.approximationError(50); // Same sample, without using randGenerator.
+    REQUIRE(again.N_pairs == error.N_pairs);
+    REQUIRE(again.mean == error.mean);
+  }
+
+  SECTION("Quantised kernel")
+  {
+    for (const int L_data : { 0, 100 }) { // Random lengths (single pairs), then equal lengths (batches).
+      auto p_vec = test_util::get_random_data<data_t>(15, 100);
+      if (L_data > 0)
+        for (auto &x : p_vec) x.resize(L_data, 0.5);
+      auto p_vec_copy = p_vec;
+      std::vector<std::string> names(p_vec.size(), "a");
+
+      dtwc::Problem prob{ "quantised" };
+      prob.band = 10;
+      prob.kernel = DtwKernel::Quantised;
+      prob.set_data(Data(std::move(p_vec), std::move(names)));
+      prob.fillDistanceMatrix();
+      REQUIRE(prob.isApproximateDTW());
+
+      for (int i = 0; i < prob.size(); i++)
+        for (int j = 0; j < prob.size(); j++)
+          if (!p_vec_copy[i].empty() && !p_vec_copy[j].empty()) {
+            const auto tolerance = prob.data.quantiser.tolerance(p_vec_copy[i].size(), p_vec_copy[j].size());
+            REQUIRE_THAT(prob.distByInd(i, j), WithinAbs(dtwBanded(p_vec_copy[i], p_vec_copy[j], prob.band), tolerance));
+          }
+    }
+  }
+
+  SECTION("Multichannel data")
+  {
+    constexpr int ndim = 3;
+    auto p_vec = test_util::get_random_data<data_t>(10, 3 * 40);
+    for (auto &x : p_vec) x.resize(x.size() - x.size() % ndim);
+    auto p_vec_copy = p_vec;
+    std::vector<std::string> names(p_vec.size(), "a");
+
+    dtwc::Problem prob{ "multichannel" };
+    prob.band = 4;
+    prob.set_data(Data(std::move(p_vec), std::move(names), ndim));
+    REQUIRE(!prob.isSakoeChibaDTW()); // Univariate kernels are not used.
+
+    for (const auto mode : { MultivariateMode::Dependent, MultivariateMode::Independent }) {
+      prob.multivariate_mode = mode;
+      prob.refreshDistanceMatrix();
+      prob.fillDistanceMatrix();
+
+      for (int i = 0; i < prob.size(); i++)
+        for (int j = 0; j < prob.size(); j++) {
+          const auto &x = p_vec_copy[i], &y = p_vec_copy[j];
+          if (i == j || x.empty() || y.empty()) continue;
+
+          const auto expected = (mode == MultivariateMode::Dependent) ? dtwDependent(x, y, ndim, prob.band) : dtwIndependent(x, y, ndim, prob.band);
+          REQUIRE(prob.distByInd(i, j) == expected);
+
+          if (mode == MultivariateMode::Dependent)
+            REQUIRE_THAT(prob.warpingPath(i, j).distance, WithinAbs(expected, 1e-4));
+        }
+    }
+
+    prob.set_numberOfClusters(2);
+    prob.cluster_by_kMedoidsPAM();
+    REQUIRE(prob.centroids_ind.size() == 2);
+  }
+
+  SECTION("Warping paths have the same distance")
+  {
+    auto p_vec = test_util::get_random_data<data_t>(10, 60);
+    std::vector<std::string> names(p_vec.size(), "a");
+
+    dtwc::Problem prob{ "paths" };
+    prob.band = 5;
+    prob.set_data(Data(std::move(p_vec), std::move(names)));
+
+    for (int i = 0; i < prob.size(); i++)
+      for (int j = 0; j < prob.size(); j++)
+        if (i != j && !prob.p_vec(i).empty() && !prob.p_vec(j).empty())
+          REQUIRE_THAT(prob.warpingPath(i, j).distance, WithinAbs(prob.distByInd(i, j), 1e-4)); // Summed in a different order.
+  }
+
+  SECTION("Itakura window with symmetric P = 1 step pattern")
+  {
+    auto p_vec = test_util::get_random_data<data_t>(25, 60);
+    auto p_vec_copy = p_vec;
+    std::vector<std::string> names(p_vec.size(), "a");
+
+    dtwc::Problem prob{ "itakura" };
+    prob.window_type = WindowType::Itakura;
+    prob.step_pattern = StepPattern::SymmetricP1;
+    prob.set_data(Data(std::move(p_vec), std::move(names)));
+    prob.fillDistanceMatrix();
+
+    for (int i = 0; i < prob.size(); i++)
+      for (int j = 0; j < prob.size(); j++) {
+        const auto &x = p_vec_copy[i], &y = p_vec_copy[j];
+        const auto window = WarpingWindow::itakura(x.size(), y.size(), prob.itakura_slope);
+        if (i != j)
+          REQUIRE_THAT(prob.distByInd(i, j), WithinAbs(dtwWindowed(x, y, window, StepPattern::SymmetricP1), 1e-9));
+      }
+  }
+
+  SECTION("Growing series")
+  {
+    auto p_vec = test_util::get_random_data<data_t>(12, 40);
+    auto p_vec_copy = p_vec;
+    std::vector<std::string> names(p_vec.size(), "a");
+    const auto samples = test_util::get_random_data<data_t>(3, 15);
+
+    for (const int band : { -1, 4 }) {
+      dtwc::Problem prob{ "growing" };
+      prob.band = band;
+      prob.incremental = true;
+      prob.set_data(Data(std::vector(p_vec), std::vector(names)));
+      REQUIRE(prob.isIncrementalDTW() == (band < 0)); // The Sakoe-Chiba band moves when series grow.
+      prob.fillDistanceMatrix();
+
+      auto grown = p_vec_copy;
+      for (int k = 0; k < 3; k++) {
+        const int i = 3 * k + 1;
+        prob.appendSamples(i, samples[k]);
+        grown[i].insert(grown[i].end(), samples[k].begin(), samples[k].end());
+        REQUIRE(prob.isDistanceMatrixFilled() == (band < 0));
+        REQUIRE(prob.p_vec(i) == grown[i]);
+      }
+      prob.appendSamples(1, samples[0]); // Twice.
+      grown[1].insert(grown[1].end(), samples[0].begin(), samples[0].end());
+
+      prob.fillDistanceMatrix();
+      for (int i = 0; i < prob.size(); i++)
+        for (int j = 0; j < prob.size(); j++) {
+          const auto &x = grown[i], &y = grown[j];
+          if (i == j || x.empty() || y.empty()) continue;
+          REQUIRE_THAT(prob.distByInd(i, j), WithinAbs(dtwBanded(x, y, band), 1e-3));
+        }
+    }
+  }
+}
+
+TEST_CASE("assignClusters_test", "[Problem]")
+{
+  auto p_vec = test_util::get_random_data<data_t>(30, 60);
+  auto p_vec_copy = p_vec;
+  std::vector<std::string> names(p_vec.size(), "a");
+
+  dtwc::Problem prob{ "assign_clusters" };
+  prob.band = 4;
+  prob.set_data(Data(std::move(p_vec), std::move(names)));
+  prob.set_numberOfClusters(4);
+  std::vector<int> centroids{ 1, 7, 12, 25 };
+  prob.set_clusters(centroids);
+
+  prob.assignClusters(); // Uses early abandoning.
+
+  for (int i = 0; i < prob.size(); i++) {
+    std::vector<data_t> distances;
+    for (int c : centroids)
+      distances.push_back(dtwBanded(p_vec_copy[i], p_vec_copy[c], prob.band));
+
+    const auto nearest = std::min_element(distances.begin(), distances.end()) - distances.begin();
+    REQUIRE(prob.clusters_ind[i] == nearest);
+  }
+}
+
+TEST_CASE("distByInd_threads_test", "[Problem]")
+{
+  // Threads outside the parallel passes of the Problem, e.g., of a thread pool, each use their own workspace:
+  std::uniform_real_distribution<data_t> dis(-1, 1);
+  std::uniform_int_distribution<int> length(100, 200);
+  std::vector<std::vector<data_t>> p_vec(40);
+  for (auto &p : p_vec) {
+    p.resize(length(randGenerator));
+    for (auto &v : p) v = dis(randGenerator);
+  }
+  const auto p_vec_copy = p_vec;
+  std::vector<std::string> names(p_vec.size(), "a");
+
+  dtwc::Problem prob{ "threads" };
+  prob.band = 50;
+  prob.set_data(Data(std::move(p_vec), std::move(names)));
+
+  const int N = prob.size();
+  std::vector<data_t> forward(N * N), backward(N * N);
+  std::thread first([&] {
+    for (int k = 0; k < N * N; k++) forward[k] = prob.distByInd(k / N, k % N);
+  });
+  std::thread second([&] {
+    for (int k = N * N - 1; k >= 0; k--) backward[k] = prob.distByInd(k % N, k / N);
+  });
+  first.join();
+  second.join();
+
+  for (int i = 0; i < N; i++)
+    for (int j = 0; j < N; j++) {
+      const auto expected = (i == j) ? 0 : dtwBanded(p_vec_copy[i], p_vec_copy[j], prob.band);
+      REQUIRE_THAT(forward[i * N + j], WithinAbs(expected, 1e-9));
+      REQUIRE_THAT(backward[i * N + j], WithinAbs(expected, 1e-9));
+    }
+}
+
+TEST_CASE("mapDistanceMatrix_test", "[Problem]")
+{
+  const fs::path file = "test_mapped_distance_matrix.bin";
+  auto p_vec = test_util::get_random_data<data_t>(150, 30); // Several tiles, the last one partial.
+  for (auto &p : p_vec)
+    if (p.empty()) p.push_back(1); // Finite distances for silhouettes.
+
+  std::vector<std::string> names(p_vec.size(), "a");
+  const Data data(std::move(p_vec), std::move(names));
+  fs::remove(file);
+
+  {
+    dtwc::Problem in_memory{ "in_memory" }, mapped{ "mapped" };
+    for (auto *prob : { &in_memory, &mapped }) {
+      prob->band = 4;
+      prob->set_data(data);
+      prob->set_numberOfClusters(5);
+    }
+
+    mapped.mapDistanceMatrix(file);
+    REQUIRE(!mapped.isDistanceMatrixFilled());
+    in_memory.fillDistanceMatrix();
+    mapped.fillDistanceMatrix();
+
+    for (int i = 0; i < mapped.size(); i++)
+      for (int j = 0; j < mapped.size(); j++)
+        REQUIRE(mapped.distanceMatrix()(i, j) == in_memory.distanceMatrix()(i, j));
+
+    SECTION("Clustering streams over the filled matrix")
+    {
+      std::vector<int> centroids{ 3, 40, 77, 101, 149 };
+      for (auto *prob : { &in_memory, &mapped }) {
+        prob->set_clusters(centroids);
+        prob->assignClusters();
+      }
+      REQUIRE(mapped.clusters_ind == in_memory.clusters_ind);
+
+      for (int i = 0; i < mapped.size(); i++) { // Nearest medoid.
+        std::vector<data_t> distances;
+        for (int c : centroids) distances.push_back(in_memory.distByInd(i, c));
+        REQUIRE(mapped.clusters_ind[i] == std::min_element(distances.begin(), distances.end()) - distances.begin());
+      }
+
+      mapped.calculateMedoids();
+      for (int c = 0; c < mapped.cluster_size(); c++) { // Medoids have the least sum of distances in their cluster.
+        auto cost = [&](int m) {
+          double sum = 0;
+          for (int i = 0; i < mapped.size(); i++)
+            if (mapped.clusters_ind[i] == c) sum += in_memory.distByInd(m, i);
+          return sum;
+        };
+        for (int i = 0; i < mapped.size(); i++)
+          if (mapped.clusters_ind[i] == c) REQUIRE(cost(mapped.centroids_ind[c]) <= cost(i) * (1 + 1e-6));
+      }
+
+      in_memory.set_clusters(mapped.centroids_ind);
+      in_memory.clusters_ind = mapped.clusters_ind;
+      const auto silhouettes = scores::silhouette(mapped), expected = scores::silhouette(in_memory);
+      for (size_t i = 0; i < silhouettes.size(); i++)
+        REQUIRE_THAT(silhouettes[i], WithinAbs(expected[i], 1e-6));
+      REQUIRE(scores::silhouette(mapped) == silhouettes); // The sums do not depend on the scheduling.
+    }
+
+    SECTION("Binary distance matrix files")
+    {
+      in_memory.output_folder = ".";
+      in_memory.writeDistanceMatrix("test_distance_matrix.bin");
+      const fs::path written = "test_distance_matrix.bin";
+      REQUIRE(readMatrixHeader(written).data_hash == data.hash());
+
+      {
+        dtwc::Problem reader{ "reader" };
+        reader.band = 4;
+        reader.set_data(data);
+        reader.readDistanceMatrix(written);
+        REQUIRE(reader.distanceMatrix()(12, 97) == in_memory.distanceMatrix()(12, 97));
+
+        reader.mapDistanceMatrix(written); // Used without copying.
+        REQUIRE(reader.isDistanceMatrixFilled());
+        REQUIRE(reader.distanceMatrix()(96, 13) == in_memory.distanceMatrix()(96, 13));
+
+        dtwc::Problem other{ "other" };
+        other.band = 5; // Other band.
+        other.set_data(data);
+        REQUIRE_THROWS(other.readDistanceMatrix(written));
+        REQUIRE_THROWS(other.mapDistanceMatrix(written));
+
+        other.band = 4;
+        other.point_cost = DtwCost::SquaredL2; // Other settings of the distances.
+        REQUIRE(other.distanceConfig() != reader.distanceConfig());
+        REQUIRE_THROWS(other.readDistanceMatrix(written));
+        REQUIRE_THROWS(other.mapDistanceMatrix(written));
+        REQUIRE_FALSE(other.isDistanceMatrixFilled());
+        other.point_cost = DtwCost::L1;
+        other.kernel = DtwKernel::Pruned; // Exact kernels give the same distances.
+        REQUIRE(other.distanceConfig() == reader.distanceConfig());
+
+        auto changed = data;
+        changed.p_vec[3].push_back(1); // Other data.
+        other.band = 4;
+        other.set_data(changed);
+        REQUIRE_THROWS(other.readDistanceMatrix(written));
+        REQUIRE(other.distanceMatrix()(12, 97) == -1);
+
+        reader.set_data(changed); // Stays mapped; the file is emptied for the new data.
+        REQUIRE(readMatrixHeader(written).data_hash == changed.hash());
+        REQUIRE(reader.distanceMatrix()(12, 97) == -1);
+      }
+      fs::remove(written);
+    }
+
+    SECTION("Appended samples are recorded in the file")
+    {
+      mapped.appendSamples(3, { 1, 2, 3 });
+      REQUIRE(readMatrixHeader(file).data_hash == mapped.data.hash());
+      REQUIRE(mapped.distByInd(3, 97) == dtwBanded(mapped.p_vec(3), mapped.p_vec(97), 4));
+      REQUIRE(mapped.distanceMatrix()(12, 97) == in_memory.distanceMatrix()(12, 97)); // Kept.
+
+      dtwc::Problem original{ "original" }; // Its distances to point 3 are not in the file.
+      original.band = 4;
+      original.set_data(data);
+      REQUIRE_THROWS(original.mapDistanceMatrix(file));
+    }
+
+    SECTION("The file is reused")
+    {
+      dtwc::Problem reopened{ "reopened" };
+      reopened.band = 4;
+      reopened.set_data(data);
+      reopened.mapDistanceMatrix(file);
+      REQUIRE(reopened.isDistanceMatrixFilled());
+      REQUIRE(reopened.distanceMatrix()(12, 97) == in_memory.distanceMatrix()(12, 97));
+    }
+
+    mapped.refreshDistanceMatrix(); // Stays mapped; the file is emptied.
+    REQUIRE(!mapped.isDistanceMatrixFilled());
+    REQUIRE(mapped.distanceMatrix()(12, 97) == -1);
+  }
+  fs::remove(file);
+}
+
+TEST_CASE("checkpoint_test", "[Problem]")
+{
+  const fs::path file = "test_fill_checkpoint.bin";
+  auto p_vec = test_util::get_random_data<data_t>(100, 30);
+  std::vector<std::string> names(p_vec.size(), "a");
+  const Data data(std::move(p_vec), std::move(names));
+  fs::remove(file);
+
+  dtwc::Problem first{ "first" }, resumed{ "resumed" };
+  for (auto *prob : { &first, &resumed }) {
+    prob->band = 4;
+    prob->set_data(data);
+    prob->checkpoint_file = file;
+  }
+
+  first.checkpoint_seconds = 0; // Saves while tiles are being computed.
+  first.fillDistanceMatrix();
+  const auto header = readMatrixHeader(file);
+  REQUIRE(header.isValid());
+  REQUIRE(header.flags == DistanceFileHeader::has_tile_bitmap);
+
+  resumed.resume = true;
+  resumed.fillDistanceMatrix(); // All tiles are loaded.
+  for (int i = 0; i < first.size(); i++)
+    for (int j = 0; j < first.size(); j++)
+      REQUIRE(resumed.distanceMatrix()(i, j) == first.distanceMatrix()(i, j));
+
+  DistanceCache<data_t> loaded(data.size());
+  TileCheckpoint<data_t> checkpoint(file, 60);
+  REQUIRE(checkpoint.start(loaded, 4, data.hash(), resumed.distanceConfig(), true) == loaded.matrix().tiles());
+  REQUIRE(checkpoint.start(loaded, 4, data.hash() + 1, resumed.distanceConfig(), true) == 0); // Other data.
+
+  fs::remove(file);
+}
+
+TEST_CASE("shard_test", "[Problem]")
+{
+  auto p_vec = test_util::get_random_data<data_t>(150, 30); // 3 tile rows, 6 tiles.
+  std::vector<std::string> names(p_vec.size(), "a");
+  const Data data(std::move(p_vec), std::move(names));
+
+  dtwc::Problem whole{ "whole" };
+  whole.band = 4;
+  whole.set_data(data);
+  whole.fillDistanceMatrix();
+
+  constexpr int K = 4;
+  std::vector<fs::path> shards;
+  std::vector<double> lengths(data.size(), 1); // The tiles of a shard only depend on N.
+  constexpr size_t tile = DistanceMatrix<data_t>::tile;
+  for (int k = 0; k < K; k++) { // As separate processes would.
+    shards.push_back("test_shard_" + std::to_string(k) + ".bin");
+    dtwc::Problem prob{ "shard" };
+    prob.band = 4;
+    prob.set_data(data);
+    prob.shard = k;
+    prob.shard_count = K;
+    prob.checkpoint_file = shards.back();
+    prob.fillDistanceMatrix();
+    REQUIRE_FALSE(prob.isDistanceMatrixFilled());
+    REQUIRE(prob.distanceMatrix().size() == 0); // Not held by a shard.
+    REQUIRE_FALSE(prob.holdsDistanceMatrix());
+    REQUIRE(prob.distByInd(0, 5) == whole.distByInd(0, 5)); // Computed without the matrix.
+    REQUIRE(prob.distByInd(7, 3, 1e10) == whole.distByInd(7, 3));
+    prob.set_numberOfClusters(3);
+    REQUIRE_THROWS(prob.cluster());
+
+    // Only the records of the tiles of the shard are written:
+    size_t bytes = sizeof(DistanceFileHeader);
+    for (const auto &t : shardTiles(lengths, tile, k, K))
+      bytes += 2 * sizeof(uint32_t) + DistanceMatrix<data_t>::tileEntries(data.size(), t.i_begin / tile, t.j_begin / tile) * sizeof(data_t);
+    REQUIRE(fs::file_size(shards.back()) == bytes);
+  }
+
+  auto same = [&](const DistanceMatrix<data_t> &merged) {
+    REQUIRE(merged.size() == static_cast<size_t>(data.size()));
+    for (size_t k = 0; k < merged.entries(); k++)
+      REQUIRE(merged[k] == whole.distanceMatrix()[k]);
+  };
+
+  SECTION("Binary distance matrix")
+  {
+    const fs::path out = "test_shard_merged.bin";
+    const auto header = mergeShards<data_t>(shards, out);
+    REQUIRE(header.isValid());
+    REQUIRE(header.band == 4);
+    REQUIRE(header.data_hash == data.hash());
+
+    DistanceMatrix<data_t> merged;
+    readBinaryMatrix(merged, out);
+    same(merged);
+
+    dtwc::Problem prob{ "read" }; // Accepted for the same data and band.
+    prob.band = 4;
+    prob.set_data(data);
+    prob.readDistanceMatrix(out);
+    same(prob.distanceMatrix());
+    fs::remove(out);
+  }
+
+  SECTION("Mapped distance matrix")
+  {
+    const fs::path out = "test_shard_merged_mapped.bin";
+    fs::remove(out);
+    mergeShards<data_t>(shards, out, true);
+
+    dtwc::Problem prob{ "mapped" };
+    prob.band = 4;
+    prob.set_data(data);
+    prob.mapDistanceMatrix(out);
+    REQUIRE(prob.isDistanceMatrixFilled());
+    same(prob.distanceMatrix());
+    prob = dtwc::Problem{}; // Unmaps the file.
+    fs::remove(out);
+  }
+
+  SECTION("Resumed shard")
+  {
+    const auto complete = fs::file_size(shards[0]);
+    fs::resize_file(shards[0], complete - 100); // Killed while writing its last tile.
+
+    dtwc::Problem prob{ "resumed" };
+    prob.band = 4;
+    prob.shard_count = K;
+    prob.set_data(data);
+    prob.checkpoint_file = shards[0];
+    prob.resume = true;
+    prob.fillDistanceMatrix();
+    REQUIRE(fs::file_size(shards[0]) == complete);
+
+    const fs::path out = "test_shard_resumed.bin";
+    mergeShards<data_t>(shards, out);
+    DistanceMatrix<data_t> merged;
+    readBinaryMatrix(merged, out);
+    same(merged);
+    fs::remove(out);
+  }
+
+  SECTION("Missing or mismatching shards")
+  {
+    const fs::path out = "test_shard_missing.bin";
+    REQUIRE_THROWS(mergeShards<data_t>({ shards.begin(), shards.end() - 1 }, out));
+    REQUIRE_THROWS(mergeShards<data_t>({ shards.begin(), shards.end() - 1 }, out, true));
+    REQUIRE_FALSE(fs::exists(out)); // Not left partly written.
+    REQUIRE_THROWS(mergeShards<data_t>({}, out));
+    DistanceMatrix<data_t> shard_matrix;
+    REQUIRE_THROWS(readBinaryMatrix(shard_matrix, shards[0])); // Not a whole matrix.
+
+    dtwc::Problem other{ "other" };
+    other.band = 5;
+    other.set_data(data);
+    other.shard_count = K;
+    other.checkpoint_file = "test_shard_other.bin";
+    other.fillDistanceMatrix();
+    auto mixed = shards;
+    mixed.back() = other.checkpoint_file;
+    REQUIRE_THROWS(mergeShards<data_t>(mixed, out));
+    fs::remove(other.checkpoint_file);
+    fs::remove(out);
+
+    other.shard = K;
+    REQUIRE_THROWS(other.fillDistanceMatrix());
+
+    dtwc::Problem unsaved{ "unsaved" }; // The shard would be lost.
+    unsaved.set_data(data);
+    unsaved.shard_count = K;
+    REQUIRE_THROWS(unsaved.fillDistanceMatrix());
+  }
+
+  SECTION("Shard of a mapped matrix")
+  {
+    const fs::path mapped_file = "test_shard_mapped.bin", shard_file = "test_shard_of_mapped.bin";
+    dtwc::Problem prob{ "mapped" };
+    prob.band = 4;
+    prob.set_data(data);
+    prob.mapDistanceMatrix(mapped_file);
+    prob.shard = 1;
+    prob.shard_count = K;
+    prob.checkpoint_file = shard_file;
+    prob.fillDistanceMatrix(); // Written to its own file; the mapped matrix is not used.
+    REQUIRE(fs::file_size(shard_file) == fs::file_size(shards[1]));
+    REQUIRE(prob.distanceMatrix()(0, 64) == -1);
+    prob = dtwc::Problem{}; // Unmaps the file.
+    fs::remove(mapped_file);
+    fs::remove(shard_file);
+  }
+
+  SECTION("Whole matrix after shards")
+  {
+    dtwc::Problem prob{ "again" };
+    prob.band = 4;
+    prob.shard_count = K;
+    prob.set_data(data);
+    prob.shard_count = 1;
+    prob.fillDistanceMatrix();
+    same(prob.distanceMatrix());
+  }
+
+  for (const auto &shard : shards)
+    fs::remove(shard);
+}
+
+TEST_CASE("append_data_test", "[Problem]")
+{
+  auto p_vec = test_util::get_random_data<data_t>(60, 30);
+  for (auto &x : p_vec)
+    if (x.empty()) x = { 1 };
+  std::vector<std::string> names(p_vec.size());
+  for (size_t i = 0; i < names.size(); i++) names[i] = std::to_string(i);
+
+  dtwc::Problem whole{ "whole" }, grown{ "grown" };
+  whole.band = grown.band = 4;
+  whole.set_data(Data(std::vector<std::vector<data_t>>(p_vec), std::vector<std::string>(names)));
+  whole.fillDistanceMatrix();
+
+  grown.set_data(Data({ p_vec.begin(), p_vec.begin() + 50 }, { names.begin(), names.begin() + 50 }));
+  grown.fillDistanceMatrix();
+
+  SECTION("Appended points")
+  {
+    grown.append_data(Data({ p_vec.begin() + 50, p_vec.end() }, { names.begin() + 50, names.end() }));
+    REQUIRE(grown.size() == 60);
+    REQUIRE(grown.get_name(55) == "55");
+    REQUIRE_FALSE(grown.isDistanceMatrixFilled());
+    for (int i = 0; i < 60; i++)
+      for (int j = 0; j < 60; j++)
+        REQUIRE(grown.distanceMatrix()(i, j) == ((i < 50 && j < 50) ? whole.distanceMatrix()(i, j) : -1)); // Only new rows are empty.
+
+    grown.fillDistanceMatrix();
+    REQUIRE(grown.isDistanceMatrixFilled());
+    for (size_t k = 0; k < whole.distanceMatrix().entries(); k++)
+      REQUIRE(grown.distanceMatrix()[k] == whole.distanceMatrix()[k]);
+
+    REQUIRE_THROWS(grown.append_data(Data({ { 1, 2 } }, { "2 channels" }, 2)));
+  }
+
+  SECTION("Removed points")
+  {
+    whole.remove_data({ 59, 3, 0, 3 });
+    REQUIRE(whole.size() == 57);
+    REQUIRE(whole.get_name(0) == "1");
+    REQUIRE(whole.get_name(2) == "4");
+    REQUIRE(whole.isDistanceMatrixFilled()); // Nothing to compute.
+    for (int i = 0; i < 50 - 2; i++)
+      for (int j = 0; j < 50 - 2; j++) {
+        const int old_i = i + (i >= 2 ? 2 : 1), old_j = j + (j >= 2 ? 2 : 1);
+        REQUIRE(whole.distanceMatrix()(i, j) == grown.distanceMatrix()(old_i, old_j));
+      }
+
+    REQUIRE_THROWS(whole.remove_data({ 57 }));
+  }
+
+  SECTION("Removed medoids")
+  {
+    whole.set_numberOfClusters(3);
+    whole.cluster();
+    const auto medoids = whole.centroids_ind;
+    const auto clusters = whole.clusters_ind;
+
+    int other = 0; // Not a medoid.
+    while (std::find(medoids.begin(), medoids.end(), other) != medoids.end()) other++;
+    whole.remove_data({ other });
+    for (int c = 0; c < 3; c++)
+      REQUIRE(whole.centroids_ind[c] == medoids[c] - (medoids[c] > other ? 1 : 0)); // Renumbered.
+    for (int i = 0; i < whole.size(); i++) {
+      const int old_i = i + (i >= other ? 1 : 0);
+      REQUIRE(whole.clusters_ind[i] == clusters[old_i]);
+      REQUIRE(whole.get_name(whole.centroid_of(i)) == std::to_string(medoids[clusters[old_i]])); // Names are the old indices.
+    }
+    REQUIRE_NOTHROW(whole.printClusters());
+
+    whole.remove_data({ whole.centroids_ind[1] });
+    REQUIRE(whole.centroids_ind.empty()); // Not clustered anymore.
+    REQUIRE(whole.clusters_ind.empty());
+    REQUIRE_THROWS(whole.printClusters());
+    REQUIRE_THROWS(whole.writeClusters());
+
+    whole.cluster();
+    REQUIRE(whole.centroids_ind.size() == 3);
+    REQUIRE(whole.clusters_ind.size() == static_cast<size_t>(whole.size()));
+    for (const int c : whole.centroids_ind)
+      REQUIRE(c < whole.size());
+  }
+
+  SECTION("Incremental DTW follows the points")
+  {
+    dtwc::Problem prob{ "incremental" };
+    prob.band = -1;
+    prob.incremental = true;
+    prob.set_data(Data({ p_vec.begin(), p_vec.begin() + 20 }, { names.begin(), names.begin() + 20 }));
+    prob.fillDistanceMatrix();
+
+    prob.remove_data({ 0, 7 });
+    prob.append_data(Data({ p_vec[30] }, { names[30] }));
+    prob.appendSamples(3, { 1, 2, 3 });
+    prob.appendSamples(18, { 4, 5 });
+
+    auto expected = prob.data.p_vec;
+    REQUIRE(expected[3] == [&] { auto x = p_vec[4]; x.insert(x.end(), { 1, 2, 3 }); return x; }());
+    for (int i = 0; i < prob.size(); i++)
+      for (int j = i + 1; j < prob.size(); j++)
+        REQUIRE_THAT(prob.distByInd(i, j), WithinAbs(dtwBanded(expected[i], expected[j], -1), 1e-3));
+  }
+
+  SECTION("Mapped distance matrix")
+  {
+    const fs::path file = "test_append_mapped.bin";
+    fs::remove(file);
+    grown.mapDistanceMatrix(file);
+    grown.fillDistanceMatrix();
+    grown.append_data(Data({ p_vec.begin() + 50, p_vec.end() }, { names.begin() + 50, names.end() }));
+    REQUIRE(readMatrixHeader(file).N == 60);
+    grown.fillDistanceMatrix();
+    for (size_t k = 0; k < whole.distanceMatrix().entries(); k++)
+      REQUIRE(grown.distanceMatrix()[k] == whole.distanceMatrix()[k]);
+
+    grown = dtwc::Problem{}; // Unmaps the file.
+    fs::remove(file);
+  }
+}
@@ -108,6 +108,79 @@ TEST_CASE("Write and Read Empty Matrix", "[fileOperations]")
 }
 
 
+TEST_CASE("Write and Read Binary Distance Matrices", "[fileOperations]")
+{
+  const size_t N = GENERATE(0, 1, 7, 64, 150);
+  DistanceMatrix<data_t> matrix(N);
+  for (size_t i = 0; i < N; i++)
+    for (size_t j = i; j < N; j++)
+      matrix(i, j) = (i == j) ? 0 : data_t(1) / (1 + i + 3 * j); // Not exact in decimal.
+
+  fs::path tempFilePath = "test_matrix.bin";
+
+  SECTION("Packed layout keeps every bit")
+  {
+    writeBinaryMatrix(matrix, tempFilePath, 5, 1234);
+    REQUIRE(fs::file_size(tempFilePath) == sizeof(DistanceFileHeader) + N * (N + 1) / 2 * sizeof(data_t));
+
+    const auto header = readMatrixHeader(tempFilePath);
+    REQUIRE(header.isValid());
+    REQUIRE(header.N == N);
+    REQUIRE(header.band == 5);
+    REQUIRE(header.data_hash == 1234);
+    REQUIRE(header.element_bytes == sizeof(data_t));
+
+    DistanceMatrix<data_t> readMat;
+    readBinaryMatrix(readMat, tempFilePath);
+    REQUIRE(readMat.size() == N);
+    for (size_t i = 0; i < N; i++)
+      for (size_t j = 0; j < N; j++)
+        REQUIRE(readMat(i, j) == matrix(i, j));
+  }
+
+  SECTION("Dense layout and the other precision")
+  {
+    arma::Mat<float> dense(N, N);
+    for (size_t i = 0; i < N; i++)
+      for (size_t j = 0; j < N; j++)
+        dense(i, j) = matrix(i, j);
+
+    writeBinaryMatrix(dense, tempFilePath);
+    REQUIRE(readMatrixHeader(tempFilePath).element_bytes == sizeof(float));
+
+    DistanceMatrix<data_t> readMat;
+    readBinaryMatrix(readMat, tempFilePath);
+    REQUIRE(readMat.size() == N);
+    for (size_t i = 0; i < N; i++)
+      for (size_t j = 0; j < N; j++)
+        REQUIRE(readMat(i, j) == data_t(float(matrix(i, j))));
+
+    REQUIRE_THROWS(writeBinaryMatrix(arma::Mat<float>(2, 3), tempFilePath));
+  }
+
+  SECTION("Invalid files are refused")
+  {
+    DistanceMatrix<data_t> readMat;
+    writeMatrix(matrix, tempFilePath); // CSV.
+    REQUIRE(!readMatrixHeader(tempFilePath).isValid());
+    REQUIRE_THROWS(readBinaryMatrix(readMat, tempFilePath));
+
+    if (N > 1) {
+      writeBinaryMatrix(matrix, tempFilePath);
+      fs::resize_file(tempFilePath, fs::file_size(tempFilePath) - 1);
+      REQUIRE_THROWS(readBinaryMatrix(readMat, tempFilePath)); // Truncated.
+
+      std::fstream file(tempFilePath, std::ios::in | std::ios::out | std::ios::binary);
+      file.seekp(16);
+      file.put(char(N + 1)); // Header no longer matches its checksum.
+      file.close();
+      REQUIRE(!readMatrixHeader(tempFilePath).isValid());
+    }
+  }
+
+  fs::remove(tempFilePath);
+}
+
 TEST_CASE("Load batch file", "[fileOperations]")
 {
   std::string tempFileName = "test_matrix";
@@ -0,0 +1,104 @@
+/**
+ * @file unit_test_lower_bounds.cpp
+ * @brief Unit test file for lower bounds of time warping distances
+ *
+ * @author Volkan Kumtepeli
+ * @author Becky Perriment
+ * @date 17 Oct 2026
+ */
+
+#include <dtwc.hpp>
+#include "../test_util.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <algorithm>
+
+using Catch::Matchers::WithinAbs;
+
+using namespace dtwc;
+
+TEST_CASE("envelope_test", "[lower_bounds]")
+{
+  using data_t = double;
+  const auto random_data = test_util::get_random_data<data_t>(20, 50);
+
+  Envelope<data_t> reused;
+  DtwWorkspace<data_t> workspace;
+  for (const auto &x : random_data)
+    for (int band : { -1, 0, 1, 4, 100 }) {
+      const auto env = envelope(x, band);
+      REQUIRE(env.size() == x.size());
+
+      envelope(x, band, reused, workspace); // Into the memory of the previous envelope.
+      REQUIRE(reused.upper == env.upper);
+      REQUIRE(reused.lower == env.lower);
+
+      const int n = x.size(), r = (band < 0) ? n : band;
+      for (int i = 0; i < n; i++) {
+        const auto first = x.begin() + std::max(i - r, 0), last = x.begin() + std::min(i + r + 1, n);
+        REQUIRE(env.upper[i] == *std::max_element(first, last));
+        REQUIRE(env.lower[i] == *std::min_element(first, last));
+      }
+    }
+}
+
+TEMPLATE_TEST_CASE("lower_bounds_test", "[lower_bounds]", cost::L1, cost::SquaredL2)
+{
+  using data_t = double;
+  using Tcost = TestType;
+  std::uniform_real_distribution<data_t> dis(-1, 1);
+
+  for (int m : { 1, 2, 17, 64 }) {
+    std::vector<std::vector<data_t>> series(15, std::vector<data_t>(m));
+    for (auto &s : series)
+      for (auto &v : s) v = dis(randGenerator);
+
+    for (int band : { -1, 0, 2, 10 }) {
+      std::vector<Envelope<data_t>> envs;
+      for (const auto &s : series) envs.push_back(envelope(s, band));
+
+      for (size_t i = 0; i < series.size(); i++)
+        for (size_t j = 0; j < series.size(); j++) {
+          const auto &x = series[i], &y = series[j];
+          const auto exact = dtwBanded<data_t, Tcost>(x, y, band);
+          constexpr double tol = 1e-12;
+
+          REQUIRE((lbKim<data_t, Tcost>(x, y) <= exact + tol));
+          REQUIRE((lbKeogh<data_t, Tcost>(x, envs[j]) <= exact + tol));
+          REQUIRE((lbKeogh<data_t, Tcost>(y, envs[i]) <= exact + tol));
+          REQUIRE((lbImproved<data_t, Tcost>(x, y, envs[j], band) <= exact + tol));
+          REQUIRE((lbImproved<data_t, Tcost>(x, y, envs[j], band) >= lbKeogh<data_t, Tcost>(x, envs[j])));
+
+          // Cascade is exact below the threshold and a lower bound above it:
+          REQUIRE_THAT((dtwCascade<data_t, Tcost>(x, y, envs[i], envs[j], band, exact).distance), WithinAbs(exact, tol));
+
+          const auto result = dtwCascade<data_t, Tcost>(x, y, envs[i], envs[j], band, exact / 2);
+          if (result.is_exact)
+            REQUIRE_THAT(result.distance, WithinAbs(exact, tol));
+          else
+            REQUIRE((result.distance > exact / 2 && result.distance <= exact + tol));
+        }
+    }
+  }
+}
+
+TEST_CASE("lower_bounds_different_lengths_test", "[lower_bounds]")
+{
+  using data_t = double;
+  const auto random_data = test_util::get_random_data<data_t>(20, 50);
+  const Envelope<data_t> no_envelope;
+
+  for (const auto &x : random_data)
+    for (const auto &y : random_data) {
+      if (x.empty() || y.empty()) continue;
+      const auto exact = dtwBanded(x, y, 3);
+
+      REQUIRE(lbKim(x, y) <= exact);
+      const auto result = dtwCascade(x, y, no_envelope, no_envelope, 3, exact);
+      REQUIRE(result.is_exact);
+      REQUIRE(result.distance == exact);
+    }
+}
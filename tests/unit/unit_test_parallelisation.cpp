@@ -74,4 +74,96 @@ TEST_CASE("Boundary Conditions", "[run_openmp]")
 
   dtwc::run_openmp(task, 0, true);
   REQUIRE(count == 0);
-}
\ No newline at end of file
+}
+TEST_CASE("Tiles of the upper triangle", "[upperTriangleTiles]")
+{
+  for (const int N : { 0, 1, 7, 30 })
+    for (const int tile_size : { 1, 4, 8, 64 }) {
+      std::vector<double> weight(N);
+      for (int i = 0; i < N; i++) weight[i] = 1 + (i * 7) % 5;
+
+      const auto tiles = dtwc::upperTriangleTiles(weight, tile_size);
+      std::vector<int> visits(N * N, 0);
+      for (size_t t = 0; t < tiles.size(); t++) {
+        const auto &tile = tiles[t];
+        REQUIRE(tile.i_end - tile.i_begin <= tile_size);
+        REQUIRE(tile.j_end - tile.j_begin <= tile_size);
+        if (t > 0) REQUIRE(tiles[t - 1].cost >= tile.cost); // Biggest first.
+
+        double cost{ 0 };
+        for (int i = tile.i_begin; i < tile.i_end; i++)
+          for (int j = std::max(tile.j_begin, i); j < tile.j_end; j++) {
+            visits[i * N + j]++;
+            cost += weight[i] * weight[j];
+          }
+        REQUIRE_THAT(tile.cost, Catch::Matchers::WithinAbs(cost, 1e-9));
+      }
+
+      for (int i = 0; i < N; i++)
+        for (int j = 0; j < N; j++)
+          REQUIRE(visits[i * N + j] == (i <= j ? 1 : 0));
+    }
+
+  REQUIRE(dtwc::tileSize(1000, 8000.0, 1 << 20) <= (1 << 20) / 16000); // At most 65 series of 8 kB per side.
+  REQUIRE(dtwc::tileSize(1000, 1e9) == 1);
+  REQUIRE(dtwc::tileSize(2, 8.0) >= 1);
+}
+
+TEST_CASE("Shards of the tiles of the upper triangle", "[shardTiles]")
+{
+  const int N = 30, tile_size = 4, K = 3;
+  std::vector<double> weight(N);
+  for (int i = 0; i < N; i++) weight[i] = 1 + (i * 7) % 5;
+
+  const auto all = dtwc::upperTriangleTiles(weight, tile_size);
+  std::vector<int> visits(N * N, 0);
+  size_t count = 0;
+  for (int k = 0; k < K; k++) {
+    const auto tiles = dtwc::shardTiles(weight, tile_size, k, K);
+    count += tiles.size();
+    REQUIRE(tiles.size() >= all.size() / K); // Round-robin.
+    for (size_t t = 0; t < tiles.size(); t++) {
+      if (t > 0) REQUIRE(tiles[t - 1].cost >= tiles[t].cost);
+      for (int i = tiles[t].i_begin; i < tiles[t].i_end; i++)
+        for (int j = std::max(tiles[t].j_begin, i); j < tiles[t].j_end; j++)
+          visits[i * N + j]++;
+    }
+  }
+
+  REQUIRE(count == all.size());
+  for (int i = 0; i < N; i++)
+    for (int j = 0; j < N; j++)
+      REQUIRE(visits[i * N + j] == (i <= j ? 1 : 0));
+
+  REQUIRE(dtwc::shardTiles(weight, tile_size, 0, 1).size() == all.size());
+}
+
+TEST_CASE("Functionality of runTiles", "[runTiles]")
+{
+  const int N = 23;
+  std::vector<std::atomic<int>> visits(N * N);
+  auto task = [&](int i, int j) { visits[i * N + j]++; };
+
+  dtwc::runTiles(task, dtwc::upperTriangleTiles(std::vector<double>(N, 1.0), 5));
+  for (int i = 0; i < N; i++)
+    for (int j = 0; j < N; j++)
+      REQUIRE(visits[i * N + j] == (i <= j ? 1 : 0));
+}
+
+TEST_CASE("Functionality of runGrouped", "[runGrouped]")
+{
+  const size_t N = 37, groups = 4;
+  std::vector<int> group(N, -1), previous(groups, -1);
+  std::vector<int> ordered(groups, 1);
+  auto task = [&](size_t g, size_t i) {
+    group[i] = g;
+    if (static_cast<int>(i) <= previous[g]) ordered[g] = 0; // Each group runs its tasks in order.
+    previous[g] = i;
+  };
+
+  dtwc::runGrouped(task, N, groups);
+  for (size_t i = 0; i < N; i++)
+    REQUIRE(group[i] == static_cast<int>(i % groups));
+  for (size_t g = 0; g < groups; g++)
+    REQUIRE(ordered[g] == 1);
+}
@@ -8,8 +8,10 @@
  */
 
 #include <dtwc.hpp>
+#include "../test_util.hpp"
 
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_template_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_string.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
 
@@ -81,4 +83,786 @@ TEST_CASE("dtwBanded_test", "[dtwBanded]")
   // Empty vector should give infinite cost.
   REQUIRE(dtwBanded<data_t>(x, empty) > 1e10);
   REQUIRE(dtwBanded<data_t>(empty, x) > 1e10);
-}
\ No newline at end of file
+}
+
+TEST_CASE("dtwBanded_long_series_test", "[dtwBanded]")
+{
+  using data_t = double;
+  constexpr int N = 50000;
+  std::uniform_real_distribution<data_t> dis(-1, 1);
+
+  std::vector<data_t> x(N), y(N);
+  for (int i = 0; i < N; i++) {
+    x[i] = dis(randGenerator);
+    y[i] = dis(randGenerator);
+  }
+
+  // Zero band on equal lengths only allows the diagonal, i.e., L1 distance:
+  data_t l1{ 0 };
+  for (int i = 0; i < N; i++)
+    l1 += std::abs(x[i] - y[i]);
+
+  REQUIRE_THAT(dtwBanded<data_t>(x, y, 0), WithinAbs(l1, 1e-8));
+
+  // Widening the band can only decrease the cost:
+  const auto d_10 = dtwBanded<data_t>(x, y, 10);
+  const auto d_100 = dtwBanded<data_t>(x, y, 100);
+  REQUIRE(d_10 <= l1);
+  REQUIRE(d_100 <= d_10);
+}
+
+TEST_CASE("dtwBanded_random_test", "[dtwBanded]")
+{
+  using data_t = double;
+  const auto random_data = test_util::get_random_data<data_t>(20, 50);
+
+  for (const auto &x : random_data)
+    for (const auto &y : random_data) {
+      if (x.empty() || y.empty()) continue;
+
+      const auto full = dtwFull<data_t>(x, y);
+      REQUIRE_THAT(dtwBanded<data_t>(x, y, 100), WithinAbs(full, 1e-9));
+
+      for (int band : { 0, 1, 3, 10 })
+        REQUIRE(dtwBanded<data_t>(x, y, band) >= full - 1e-9);
+    }
+}
+
+TEST_CASE("DtwWorkspace_test", "[DtwWorkspace][dtwFull][dtwFull_L][dtwBanded]")
+{
+  using data_t = double;
+  const auto random_data = test_util::get_random_data<data_t>(20, 50);
+
+  size_t max_length{ 0 };
+  for (const auto &x : random_data) max_length = std::max(max_length, x.size());
+
+  DtwWorkspace<data_t> workspace(max_length);
+  const auto bytes = workspace.bytes();
+  REQUIRE(bytes >= 2 * max_length * sizeof(data_t));
+
+  for (const auto &x : random_data)
+    for (const auto &y : random_data) {
+      REQUIRE(dtwFull_L<data_t>(x, y, workspace) == dtwFull_L<data_t>(x, y));
+      REQUIRE(dtwFull_L<data_t>(x, y, 10, workspace).distance == dtwFull_L<data_t>(x, y, 10).distance);
+      for (int band : { -1, 0, 3, 10 }) {
+        REQUIRE(dtwBanded<data_t>(x, y, band, workspace) == dtwBanded<data_t>(x, y, band));
+        REQUIRE(dtwBanded<data_t>(x, y, band, 10, workspace).distance == dtwBanded<data_t>(x, y, band, 10).distance);
+      }
+    }
+
+  REQUIRE(workspace.bytes() == bytes); // Reserved memory was enough.
+
+  const auto &x = random_data[0], &y = random_data[1];
+  REQUIRE(dtwFull<data_t>(x, y, workspace) == dtwFull<data_t>(x, y));
+
+  workspace.release();
+  REQUIRE(workspace.bytes() == 0);
+  threadWorkspace<data_t>().release();
+  REQUIRE(threadWorkspace<data_t>().bytes() == 0);
+}
+
+TEST_CASE("DtwWorkspace_kernels_test", "[DtwWorkspace][dtwWavefront][dtwPruned][dtwWindowed][dtwPath][dtwBatch][dtwQuantised][lbImproved]")
+{
+  using data_t = double;
+  const auto random_data = test_util::get_random_data<data_t>(8, 40);
+  const auto quantiser = Quantiser<data_t>::fit(random_data);
+
+  DtwWorkspace<data_t> workspace;
+  QuantisedWorkspace quantised_workspace;
+
+  for (const auto &x : random_data)
+    for (const auto &y : random_data) {
+      if (x.empty() || y.empty()) continue;
+      for (int band : { -1, 0, 3 }) {
+        REQUIRE(dtwWavefront<data_t>(x, y, band, workspace) == dtwWavefront<data_t>(x, y, band));
+        REQUIRE(dtwPruned<data_t>(x, y, band, workspace) == dtwPruned<data_t>(x, y, band));
+        REQUIRE(dtwPruned<data_t>(x, y, band, 10, workspace).distance == dtwPruned<data_t>(x, y, band, 10).distance);
+
+        const auto qx = quantiser.quantise(x), qy = quantiser.quantise(y);
+        REQUIRE(dtwQuantised(qx, qy, band, quantised_workspace) == dtwQuantised(qx, qy, band));
+      }
+
+      const auto window = WarpingWindow::itakura(x.size(), y.size(), 2.0);
+      for (auto pattern : { StepPattern::Symmetric1, StepPattern::SymmetricP1 })
+        REQUIRE(dtwWindowed<data_t>(x, y, window, pattern, workspace) == dtwWindowed<data_t>(x, y, window, pattern));
+
+      REQUIRE(dtwPath<data_t>(x, y, window, workspace).path == dtwPath<data_t>(x, y, window).path);
+    }
+
+  const std::vector<data_t> query{ 3, 1, 4, 1, 5, 9, 2, 6 };
+  std::vector<std::vector<data_t>> candidates(5, std::vector<data_t>(12));
+  for (size_t k = 0; k < candidates.size(); k++)
+    for (size_t i = 0; i < candidates[k].size(); i++) candidates[k][i] = (k * 7 + i * 3) % 11;
+
+  std::vector<const std::vector<data_t> *> pointers;
+  for (const auto &c : candidates) pointers.push_back(&c);
+  std::vector<data_t> distances(pointers.size());
+  dtwBatch<data_t>(query, pointers.data(), static_cast<int>(pointers.size()), distances.data(), 2, workspace);
+  REQUIRE(distances == dtwBatch<data_t>(query, pointers, 2));
+
+  const auto &x = candidates[0], &y = candidates[1];
+  const auto env_x = envelope(x, 3), env_y = envelope(y, 3);
+  REQUIRE(lbImproved<data_t>(x, y, env_y, 3, 1e10, workspace) == lbImproved<data_t>(x, y, env_y, 3));
+  const auto lb_bytes = workspace.bytes();
+  for (int repeat = 0; repeat < 3; repeat++)
+    lbImproved<data_t>(y, x, env_x, 3, 1e10, workspace);
+  REQUIRE(workspace.bytes() == lb_bytes); // The envelope of the projection reuses the workspace.
+  REQUIRE(dtwCascade<data_t>(x, y, env_x, env_y, 3, 1e10, workspace).distance == dtwCascade<data_t>(x, y, env_x, env_y, 3, 1e10).distance);
+
+  REQUIRE(workspace.bytes() > 0);
+  REQUIRE(quantised_workspace.bytes() > 0);
+  workspace.release();
+  quantised_workspace.release();
+  REQUIRE(workspace.bytes() == 0);
+  REQUIRE(quantised_workspace.bytes() == 0);
+}
+
+TEST_CASE("dtwWavefront_test", "[dtwWavefront]")
+{
+  using data_t = double;
+  std::vector<data_t> x{ 1, 2, 3 }, y{ 3, 4, 5, 6, 7 }, z{ 1, 2, 3 }, empty{};
+  constexpr double ground_truth = 13;
+
+  REQUIRE_THAT(dtwWavefront<data_t>(x, z), WithinAbs(0, 1e-15));
+  REQUIRE_THAT(dtwWavefront<data_t>(x, y), WithinAbs(ground_truth, 1e-15));
+  REQUIRE_THAT(dtwWavefront<data_t>(y, x, 2), WithinAbs(ground_truth, 1e-15));
+  REQUIRE(dtwWavefront<data_t>(x, empty) > 1e10);
+
+  // Every instruction set path should agree with the row-wise kernels:
+  const auto random_data = test_util::get_random_data<data_t>(10, 300);
+  const auto max_level = simd::level();
+
+  for (int lvl = 0; lvl <= static_cast<int>(max_level); lvl++) {
+    simd::set_max_level(static_cast<simd::Level>(lvl));
+    for (const auto &a : random_data)
+      for (const auto &b : random_data)
+        for (int band : { -1, 0, 3, 20 }) {
+          if (a.empty() || b.empty()) continue;
+          const auto expected = dtwBanded<data_t>(a, b, band);
+          REQUIRE_THAT(dtwWavefront<data_t>(a, b, band), WithinAbs(expected, 1e-9 * expected));
+        }
+  }
+
+  simd::set_max_level(simd::Level::AVX512);
+}
+
+TEST_CASE("dtwBatch_test", "[dtwBatch]")
+{
+  using data_t = double;
+  std::uniform_real_distribution<data_t> dis(-1, 1);
+
+  const int N_cand = 37; // Not a multiple of the lane count to test padding.
+  for (const int m : { 1, 2, 17, 64 }) {
+    std::vector<std::vector<data_t>> candidates(N_cand, std::vector<data_t>(m));
+    std::vector<const std::vector<data_t> *> cand_ptrs;
+    for (auto &c : candidates) {
+      for (auto &v : c) v = dis(randGenerator);
+      cand_ptrs.push_back(&c);
+    }
+
+    for (const int n : { 1, 5, m, m + 13 })
+      for (int band : { -1, 0, 2, 10 }) {
+        std::vector<data_t> query(n);
+        for (auto &v : query) v = dis(randGenerator);
+
+        const auto distances = dtwBatch(query, cand_ptrs, band);
+        REQUIRE(distances.size() == N_cand);
+
+        for (int k = 0; k < N_cand; k++)
+          REQUIRE(distances[k] == dtwBanded(query, candidates[k], band));
+      }
+  }
+
+  std::vector<data_t> x{ 1, 2, 3 }, y{ 3, 4, 5, 6, 7 };
+  REQUIRE_THROWS(dtwBatch(x, { &x, &y }));
+}
+
+TEST_CASE("dtwBatchQuantised_test", "[dtwBatchQuantised]")
+{
+  using data_t = double;
+  std::uniform_real_distribution<data_t> dis(-1, 1);
+
+  const int N_cand = 37, m = 50;
+  std::vector<std::vector<data_t>> candidates(N_cand, std::vector<data_t>(m));
+  for (auto &c : candidates)
+    for (auto &v : c) v = dis(randGenerator);
+
+  const auto quantiser = Quantiser<data_t>::fit(candidates);
+  std::vector<std::vector<int16_t>> quantised;
+  for (const auto &c : candidates) quantised.push_back(quantiser.quantise(c));
+
+  std::vector<const std::vector<int16_t> *> cand_ptrs;
+  for (const auto &q : quantised) cand_ptrs.push_back(&q);
+
+  for (const int n : { 1, m, m + 13 })
+    for (int band : { -1, 0, 10 }) {
+      std::vector<data_t> query(n);
+      for (auto &v : query) v = dis(randGenerator);
+      const auto query_q = quantiser.quantise(query);
+
+      const auto distances = dtwBatchQuantised(query_q, cand_ptrs, band);
+      REQUIRE(distances.size() == N_cand);
+
+      for (int k = 0; k < N_cand; k++) {
+        REQUIRE(distances[k] == dtwQuantised(query_q, quantised[k], band));
+        REQUIRE_THAT(quantiser.distance(distances[k]), WithinAbs(dtwBanded(query, candidates[k], band), quantiser.tolerance(n, m)));
+      }
+    }
+
+  // Integer data with a unit scale are exact:
+  std::vector<int16_t> x{ 1, 2, 3 }, y{ 3, 4, 5, 6, 7 };
+  REQUIRE(dtwQuantised(x, y) == 13);
+  REQUIRE(dtwBatchQuantised(y, { &x, &x }) == std::vector<int32_t>{ 13, 13 });
+  REQUIRE_THROWS(dtwBatchQuantised(x, { &x, &y }));
+
+  // Integer data that fit in int16 are fitted with a unit scale:
+  const std::vector<std::vector<data_t>> adc{ { 0, 4095, 17 }, { 1000, 2, 3, 4 } };
+  const auto adc_quantiser = Quantiser<data_t>::fit(adc);
+  REQUIRE(adc_quantiser.scale == 1);
+  REQUIRE(adc_quantiser.tolerance(3, 4) == 0);
+  REQUIRE(adc_quantiser.distance(dtwQuantised(adc_quantiser.quantise(adc[0]), adc_quantiser.quantise(adc[1]))) == dtwFull<data_t>(adc[0], adc[1]));
+  REQUIRE(Quantiser<data_t>::fit({ { -40000, 40000 } }).scale > 1);
+
+  // Costs saturate instead of overflowing:
+  std::vector<int16_t> lo(40000, -32767), hi(40000, 32767);
+  REQUIRE(dtwQuantised(lo, hi, 0) == Quantiser<data_t>::saturated);
+  REQUIRE(quantiser.distance(dtwQuantised(lo, hi, 0)) == std::numeric_limits<data_t>::max());
+}
+
+TEST_CASE("dtw_early_abandon_test", "[dtwFull_L][dtwBanded]")
+{
+  using data_t = double;
+  std::vector<data_t> x{ 1, 2, 3 }, y{ 3, 4, 5, 6, 7 };
+  constexpr double ground_truth = 13;
+
+  // Threshold not reached, so the result is exact:
+  for (int band : { -1, 2 }) {
+    const auto result = dtwBanded<data_t>(x, y, band, ground_truth);
+    REQUIRE(result.is_exact);
+    REQUIRE_THAT(result.distance, WithinAbs(ground_truth, 1e-15));
+  }
+
+  // Abandoned results are lower bounds larger than the threshold:
+  const auto random_data = test_util::get_random_data<data_t>(20, 50);
+  for (const auto &a : random_data)
+    for (const auto &b : random_data)
+      for (int band : { -1, 0, 5 }) {
+        if (a.empty() || b.empty()) continue;
+        const auto exact = dtwBanded<data_t>(a, b, band);
+        const auto best_so_far = exact / 2;
+
+        const auto result = dtwBanded<data_t>(a, b, band, best_so_far);
+        if (result.is_exact)
+          REQUIRE(result.distance == exact);
+        else
+          REQUIRE((result.distance > best_so_far && result.distance <= exact));
+      }
+}
+
+TEST_CASE("dtwPruned_test", "[dtwPruned]")
+{
+  using data_t = double;
+  std::vector<data_t> x{ 1, 2, 3 }, y{ 3, 4, 5, 6, 7 };
+  REQUIRE_THAT(dtwPruned(x, y, -1), WithinAbs(13, 1e-15));
+  REQUIRE_THAT(dtwPruned(x, y, 2), WithinAbs(13, 1e-15));
+
+  std::normal_distribution<data_t> dis;
+  std::uniform_int_distribution<int> length(1, 60);
+  for (int k = 0; k < 300; k++) {
+    std::vector<data_t> a(length(randGenerator)), b(k % 3 ? length(randGenerator) : a.size());
+    data_t walk{ 0 };
+    for (auto &v : a) v = (walk += dis(randGenerator)); // Random walks, so that some cells are pruned.
+    for (auto &v : b) v = (walk += dis(randGenerator));
+
+    for (int band : { -1, 0, 1, 3, 10 }) {
+      const auto exact = dtwBanded(a, b, band);
+      REQUIRE_THAT(dtwPruned(a, b, band), WithinAbs(exact, 1e-9));
+
+      const auto result = dtwPruned(a, b, band, exact / 2);
+      if (result.is_exact)
+        REQUIRE_THAT(result.distance, WithinAbs(exact, 1e-9));
+      else
+        REQUIRE((result.distance > exact / 2 && result.distance <= exact));
+    }
+  }
+}
+
+namespace {
+struct HalfL1 //!< User-supplied cost for testing.
+{
+  template <typename data_t>
+  data_t operator()(data_t x, data_t y) const { return std::abs(x - y) / 2; }
+};
+
+struct Asymmetric //!< Cost for which the order of the arguments matters.
+{
+  template <typename data_t>
+  data_t operator()(data_t x, data_t y) const { return (x > y) ? 3 * (x - y) : (y - x); }
+};
+} // namespace
+
+TEMPLATE_TEST_CASE("dtw_cost_policy_test", "[dtwFull][dtwBanded]", cost::SquaredL2, HalfL1, Asymmetric)
+{
+  using data_t = double;
+  using Tcost = TestType;
+
+  std::vector<data_t> x{ 1, 2, 3 }, y{ 3, 4, 5, 6, 7 };
+  if constexpr (std::is_same_v<Tcost, cost::SquaredL2>)
+    REQUIRE_THAT((dtwFull<data_t, Tcost>(x, y)), WithinAbs(4 + 1 + 0 + 1 + 4 + 9 + 16, 1e-15)); // x[0..2] to y[0], x[2] to y[1..4]
+  else if constexpr (std::is_same_v<Tcost, Asymmetric>) {
+    REQUIRE_THAT((dtwFull<data_t, Tcost>(x, y)), WithinAbs(13, 1e-15));     // x is below y, so costs are y - x.
+    REQUIRE_THAT((dtwFull_L<data_t, Tcost>(y, x)), WithinAbs(3 * 13, 1e-15)); // Arguments are passed in caller order.
+    REQUIRE_THAT((dtwBanded<data_t, Tcost>(y, x, 1)), WithinAbs(3 * dtwBanded<data_t>(x, y, 1), 1e-15));
+  } else
+    REQUIRE_THAT((dtwFull<data_t, Tcost>(x, y)), WithinAbs(6.5, 1e-15));
+
+  std::uniform_real_distribution<data_t> dis(-1, 1);
+  for (int m : { 1, 7, 40 }) {
+    std::vector<std::vector<data_t>> candidates(9, std::vector<data_t>(m));
+    std::vector<const std::vector<data_t> *> cand_ptrs;
+    for (auto &c : candidates) {
+      for (auto &v : c) v = dis(randGenerator);
+      cand_ptrs.push_back(&c);
+    }
+
+    for (const int n : { 1, 5, m, m + 13 }) {
+      std::vector<data_t> query(n);
+      for (auto &v : query) v = dis(randGenerator);
+
+      for (int band : { -1, 0, 2, 10 }) {
+        const auto distances = dtwBatch<data_t, Tcost>(query, cand_ptrs, band);
+
+        for (int k = 0; k < static_cast<int>(candidates.size()); k++) {
+          const auto &c = candidates[k];
+          const auto exact = dtwBanded<data_t, Tcost>(query, c, band);
+
+          if (band < 0) REQUIRE_THAT((dtwFull<data_t, Tcost>(query, c)), WithinAbs(exact, 1e-12));
+          REQUIRE_THAT((dtwFull_L<data_t, Tcost>(query, c)), WithinAbs(dtwBanded<data_t, Tcost>(query, c, -1), 1e-12));
+          REQUIRE_THAT((dtwWavefront<data_t, Tcost>(query, c, band)), WithinAbs(exact, 1e-12));
+          REQUIRE_THAT((dtwPruned<data_t, Tcost>(query, c, band)), WithinAbs(exact, 1e-12));
+          REQUIRE_THAT(distances[k], WithinAbs(exact, 1e-12));
+
+          const auto result = dtwBanded<data_t, Tcost>(query, c, band, exact / 2);
+          REQUIRE((result.is_exact ? result.distance == exact : result.distance > exact / 2));
+
+          const auto window = WarpingWindow::sakoeChiba(query.size(), c.size(), band);
+          REQUIRE_THAT((dtwWindowed<data_t, Tcost>(query, c, window)), WithinAbs(exact, 1e-12));
+          REQUIRE_THAT((dtwPath<data_t, Tcost>(query, c, band).distance), WithinAbs(exact, 1e-12));
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("dtwWindowed_test", "[dtwWindowed]")
+{
+  using data_t = double;
+  constexpr data_t maxValue = std::numeric_limits<data_t>::max();
+  std::uniform_real_distribution<data_t> dis(-1, 1);
+  std::uniform_int_distribution<int> length(1, 50);
+
+  // Reference: full cost matrix restricted to the window, with the given step pattern.
+  auto reference = [&](const std::vector<data_t> &x, const std::vector<data_t> &y, const WarpingWindow &w, StepPattern pattern) {
+    const int n = x.size(), m = y.size();
+    std::vector<std::vector<data_t>> g(n, std::vector<data_t>(m, maxValue));
+    auto d = [&](int i, int j) { return std::abs(x[i] - y[j]); };
+    auto at = [&](int i, int j) { return (i >= 0 && j >= 0) ? g[i][j] : maxValue; };
+    auto add = [&](data_t a, data_t b) { return (a == maxValue) ? maxValue : a + b; };
+
+    for (int i = 0; i < n; i++)
+      for (int j = w.lo(i); j < w.hi(i); j++) {
+        if (i == 0 && j == 0)
+          g[i][j] = d(0, 0);
+        else if (pattern == StepPattern::Symmetric1)
+          g[i][j] = add(std::min({ at(i - 1, j), at(i, j - 1), at(i - 1, j - 1) }), d(i, j));
+        else if (i > 0 && j > 0)
+          g[i][j] = std::min({ add(at(i - 1, j - 1), 2 * d(i, j)),
+                               (j >= 2 && w.contains(i, j - 1)) ? add(at(i - 1, j - 2), 2 * d(i, j - 1) + d(i, j)) : maxValue,
+                               (i >= 2 && w.contains(i - 1, j)) ? add(at(i - 2, j - 1), 2 * d(i - 1, j) + d(i, j)) : maxValue });
+      }
+
+    return g[n - 1][m - 1];
+  };
+
+  for (int k = 0; k < 200; k++) {
+    std::vector<data_t> x(length(randGenerator)), y(k % 3 ? length(randGenerator) : x.size());
+    for (auto &v : x) v = dis(randGenerator);
+    for (auto &v : y) v = dis(randGenerator);
+
+    for (int band : { -1, 0, 1, 4 }) {
+      const auto window = WarpingWindow::sakoeChiba(x.size(), y.size(), band);
+      REQUIRE(dtwWindowed(x, y, window) == dtwBanded(x, y, band));
+      REQUIRE(dtwWindowed(x, y, window, StepPattern::SymmetricP1) == reference(x, y, window, StepPattern::SymmetricP1));
+    }
+
+    for (double slope : { 1.5, 2.0, 3.0 }) {
+      const auto window = WarpingWindow::itakura(x.size(), y.size(), slope);
+      REQUIRE(window.cells() <= x.size() * y.size());
+      REQUIRE(dtwWindowed(x, y, window) < maxValue); // Always has a warping path.
+      REQUIRE(dtwWindowed(x, y, window) >= dtwFull_L(x, y));
+
+      for (auto pattern : { StepPattern::Symmetric1, StepPattern::SymmetricP1 })
+        REQUIRE_THAT(dtwWindowed(x, y, window, pattern), WithinAbs(reference(x, y, window, pattern), 1e-12));
+    }
+  }
+
+  // Itakura parallelogram is narrow at both ends:
+  const auto itakura = WarpingWindow::itakura(100, 100);
+  REQUIRE(itakura.hi(0) <= 2);
+  REQUIRE(itakura.lo(99) >= 98);
+  REQUIRE(itakura.cells() < WarpingWindow::sakoeChiba(100, 100, 25).cells());
+
+  // User-supplied windows:
+  std::vector<data_t> x{ 1, 2, 3 }, y{ 3, 4, 5, 6, 7 };
+  const WarpingWindow custom({ 0, 0, 2 }, { 1, 3, 5 }, 5);
+  REQUIRE(dtwWindowed(x, y, custom) == 13); // (0,0), (1,1), (2,2), (2,3), (2,4)
+  REQUIRE(dtwWindowed(x, y, WarpingWindow({ 0, 0, 3 }, { 1, 2, 5 }, 5)) == maxValue); // No warping path.
+
+  // SymmetricP1 steps may not skip over a cell outside the window:
+  std::vector<data_t> x2{ 1, 2 }, y3{ 3, 4, 5 };
+  REQUIRE(dtwWindowed(x2, y3, WarpingWindow({ 0, 2 }, { 1, 3 }, 3), StepPattern::SymmetricP1) == maxValue);       // (0,0) -> (1,2) via (1,1)
+  REQUIRE(dtwWindowed(y3, x2, WarpingWindow({ 0, 0, 1 }, { 1, 1, 2 }, 2), StepPattern::SymmetricP1) == maxValue); // (0,0) -> (2,1) via (1,1)
+  REQUIRE(dtwWindowed(x2, y3, WarpingWindow({ 0, 1 }, { 1, 3 }, 3), StepPattern::SymmetricP1) == 2 + 2 * 2 + 3);   // Same step, allowed.
+
+  REQUIRE_THROWS(WarpingWindow({ 0, 0 }, { 1, 3, 5 }, 5));
+  REQUIRE_THROWS(WarpingWindow({ 0, 2, 2 }, { 1, 2, 5 }, 5));
+  REQUIRE_THROWS(WarpingWindow::itakura(5, 5, 1.0));
+  REQUIRE_THROWS(dtwWindowed(y, x, custom));
+}
+
+TEST_CASE("dtwPath_test", "[dtwPath]")
+{
+  using data_t = double;
+  std::uniform_real_distribution<data_t> dis(-1, 1);
+
+  auto check_path = [](const std::vector<data_t> &x, const std::vector<data_t> &y, const WarpingWindow &window, const DtwPath<data_t> &result) {
+    const auto &path = result.path;
+    REQUIRE(path.front() == std::pair(0, 0));
+    REQUIRE(path.back() == std::pair<int, int>(x.size() - 1, y.size() - 1));
+
+    data_t sum{ 0 };
+    for (size_t k = 0; k < path.size(); k++) {
+      const auto [i, j] = path[k];
+      REQUIRE((window.lo(i) <= j && j < window.hi(i)));
+      sum += std::abs(x[i] - y[j]);
+
+      if (k > 0) {
+        const int di = i - path[k - 1].first, dj = j - path[k - 1].second;
+        REQUIRE((di == 0 || di == 1));
+        REQUIRE((dj == 0 || dj == 1));
+        REQUIRE(di + dj > 0);
+      }
+    }
+    REQUIRE_THAT(result.distance, WithinAbs(sum, 1e-9));
+  };
+
+  for (auto [n, m] : { std::pair(1, 1), std::pair(1, 7), std::pair(9, 1), std::pair(30, 40), std::pair(150, 150), std::pair(1200, 900) })
+    for (int band : { -1, 0, 3, 50 }) {
+      std::vector<data_t> x(n), y(m);
+      for (auto &v : x) v = dis(randGenerator);
+      for (auto &v : y) v = dis(randGenerator);
+
+      const auto result = dtwPath(x, y, band);
+      check_path(x, y, WarpingWindow::sakoeChiba(n, m, band), result);
+      REQUIRE_THAT(result.distance, WithinAbs(dtwBanded(x, y, band), 1e-9));
+
+      const auto itakura = WarpingWindow::itakura(n, m);
+      const auto result_itakura = dtwPath(x, y, itakura);
+      check_path(x, y, itakura, result_itakura);
+      REQUIRE_THAT(result_itakura.distance, WithinAbs(dtwWindowed(x, y, itakura), 1e-9));
+    }
+
+  std::vector<data_t> x{ 1, 2, 3 }, y{ 3, 4, 5, 6, 7 }, empty;
+  REQUIRE(dtwPath(x, y, WarpingWindow({ 0, 0, 3 }, { 1, 2, 5 }, 5)).path.empty()); // No warping path.
+  REQUIRE(dtwPath(x, empty).path.empty());
+  REQUIRE_THROWS(dtwPath(y, x, WarpingWindow(3, 5)));
+}
+
+TEST_CASE("dtwFast_test", "[dtwFast]")
+{
+  using data_t = double;
+  std::uniform_real_distribution<data_t> dis(-1, 1);
+
+  REQUIRE(detail::coarsen(std::vector<data_t>{ 1, 3, 4, 6, 7 }) == std::vector<data_t>{ 2, 5, 7 });
+
+  for (auto [n, m] : { std::pair(1, 1), std::pair(5, 3), std::pair(40, 40), std::pair(300, 250), std::pair(1000, 1100) })
+    for (int radius : { 0, 1, 10 }) {
+      std::vector<data_t> x(n), y(m);
+      data_t a{ 0 }, b{ 0 };
+      for (auto &v : x) v = (a += dis(randGenerator));
+      for (auto &v : y) v = (b += dis(randGenerator));
+
+      const auto exact = dtwFull_L(x, y);
+      const auto approximate = dtwFast(x, y, radius);
+      REQUIRE(approximate >= exact - 1e-9); // Cost of a warping path.
+
+      if (std::min(n, m) <= radius + 2) REQUIRE_THAT(approximate, WithinAbs(exact, 1e-9));
+    }
+
+  std::vector<data_t> x{ 1, 2, 3 };
+  REQUIRE(dtwFast(x, x) == 0);
+  REQUIRE(dtwFast(x, std::vector<data_t>{}) == std::numeric_limits<data_t>::max());
+  REQUIRE_THROWS(dtwFast(x, x, -1));
+}
+
+TEMPLATE_TEST_CASE("dtwFixed_test", "[dtwFixed]", cost::L1, cost::SquaredL2)
+{
+  using data_t = double;
+  using Tcost = TestType;
+  std::uniform_real_distribution<data_t> dis(-1, 1);
+  auto random_vector = [&](int n) {
+    std::vector<data_t> x(n);
+    for (auto &v : x) v = dis(randGenerator);
+    return x;
+  };
+
+  for (int n = 1; n <= 140; n++) {
+    const auto x = random_vector(n), y = random_vector(n);
+    const auto kernel = fixedKernel<data_t, Tcost>(n, n);
+    REQUIRE((kernel != nullptr) == (n % 8 == 0 && n <= 128));
+
+    if (kernel) {
+      REQUIRE(kernel(x.data(), y.data()) == dtwFull<data_t, Tcost>(x, y)); // Same operations in the same order.
+      REQUIRE(dtwFull_L<data_t, Tcost>(x, y) == dtwFull<data_t, Tcost>(x, y));
+    }
+  }
+
+  REQUIRE(fixedKernel<data_t, Tcost>(16, 24) == nullptr);
+
+  const auto x = random_vector(7), y = random_vector(5);
+  REQUIRE((dtwFixed<7, 5, data_t, Tcost>(x.data(), y.data()) == dtwFull<data_t, Tcost>(x, y)));
+  REQUIRE((dtwFixed<5, 7, data_t, Tcost>(y.data(), x.data()) == dtwFull<data_t, Tcost>(x, y)));
+  REQUIRE((dtwFixed<7, 1, data_t, Tcost>(x.data(), y.data()) == dtwFull<data_t, Tcost>(x, std::vector<data_t>{ y[0] })));
+  REQUIRE((dtwFixed<1, 3, data_t, Tcost>(x.data(), y.data()) == dtwFull<data_t, Tcost>(std::vector<data_t>{ x[0] }, std::vector<data_t>(y.begin(), y.begin() + 3))));
+}
+
+TEST_CASE("dtwMultivariate_test", "[dtwDependent][dtwIndependent]")
+{
+  using data_t = double;
+  const int ndim = 3;
+  const auto random_data = test_util::get_random_data<data_t>(8, 3 * 30);
+
+  // Channel-interleaved series of random lengths and the channels on their own:
+  std::vector<std::vector<data_t>> series;
+  std::vector<std::vector<std::vector<data_t>>> channels;
+  for (auto x : random_data) {
+    x.resize(x.size() - x.size() % ndim);
+    std::vector<std::vector<data_t>> xc(ndim);
+    for (size_t t = 0; t < x.size(); t++)
+      xc[t % ndim].push_back(x[t]);
+
+    series.push_back(std::move(x));
+    channels.push_back(std::move(xc));
+  }
+
+  // Full cost matrix of DTW_D as a reference:
+  auto dependentRef = [&](const std::vector<data_t> &x, const std::vector<data_t> &y, const WarpingWindow &w) {
+    const int n = x.size() / ndim, m = y.size() / ndim;
+    constexpr data_t inf = std::numeric_limits<data_t>::max();
+    std::vector<std::vector<data_t>> C(n, std::vector<data_t>(m, inf));
+    for (int i = 0; i < n; i++)
+      for (int j = w.lo(i); j < w.hi(i); j++) {
+        data_t d{ 0 };
+        for (int c = 0; c < ndim; c++) d += std::abs(x[i * ndim + c] - y[j * ndim + c]);
+
+        data_t best = (i == 0 && j == 0) ? 0 : inf;
+        if (i > 0) best = std::min(best, C[i - 1][j]);
+        if (j > 0) best = std::min(best, C[i][j - 1]);
+        if (i > 0 && j > 0) best = std::min(best, C[i - 1][j - 1]);
+        C[i][j] = (best == inf) ? inf : best + d;
+      }
+    return C[n - 1][m - 1];
+  };
+
+  for (size_t a = 0; a < series.size(); a++)
+    for (size_t b = 0; b < series.size(); b++) {
+      const auto &x = series[a], &y = series[b];
+      if (x.empty() || y.empty()) continue;
+
+      const int n = x.size() / ndim, m = y.size() / ndim;
+      for (int band : { -1, 0, 4 }) {
+        const auto window = WarpingWindow::sakoeChiba(n, m, band);
+        const auto dependent = dtwDependent(x, y, ndim, band);
+        REQUIRE_THAT(dependent, WithinAbs(dependentRef(x, y, window), 1e-9));
+        REQUIRE_THAT(dtwPathDependent(x, y, ndim, window).distance, WithinAbs(dependent, 1e-9));
+
+        data_t independent{ 0 };
+        for (int c = 0; c < ndim; c++) independent += dtwBanded(channels[a][c], channels[b][c], band);
+        REQUIRE_THAT(dtwIndependent(x, y, ndim, band), WithinAbs(independent, 1e-9));
+        REQUIRE(dtwIndependent(x, y, ndim, band) <= dependent + 1e-9); // Each channel may warp on its own.
+      }
+
+      // A single channel is univariate DTW:
+      REQUIRE_THAT(dtwDependent(channels[a][0], channels[b][0], 1, 2), WithinAbs(dtwBanded(channels[a][0], channels[b][0], 2), 1e-9));
+      const auto itakura = WarpingWindow::itakura(n, m);
+      REQUIRE_THAT(dtwIndependent(channels[a][1], channels[b][1], 1, itakura, StepPattern::SymmetricP1),
+                   WithinAbs(dtwWindowed(channels[a][1], channels[b][1], itakura, StepPattern::SymmetricP1), 1e-9));
+    }
+
+  std::vector<data_t> x{ 1, 2, 3, 4 }, y{ 1, 2, 3 };
+  REQUIRE_THROWS(dtwDependent(x, y, 2));  // 3 elements are not a multiple of 2 channels.
+  REQUIRE_THROWS(dtwIndependent(x, x, 0)); // No channels.
+}
+
+TEST_CASE("dtwSubsequence_test", "[dtwSubsequence]")
+{
+  using data_t = double;
+  const auto random_data = test_util::get_random_data<data_t>(6, 60);
+
+  auto segment = [](const std::vector<data_t> &x, size_t begin, size_t end) {
+    return std::vector<data_t>(x.begin() + begin, x.begin() + end);
+  };
+
+  for (size_t a = 0; a + 1 < random_data.size(); a++) {
+    auto query = random_data[a], recording = random_data[a + 1];
+    if (query.empty() || recording.empty()) continue;
+    query.resize(std::min<size_t>(query.size(), 7));
+
+    // Brute force over all subsequences of the recording, and those of at most twice the query length:
+    data_t best = std::numeric_limits<data_t>::max(), best_short = best;
+    for (size_t b = 0; b < recording.size(); b++)
+      for (size_t e = b + 1; e <= recording.size(); e++) {
+        const auto d = dtwFull_L<data_t>(query, segment(recording, b, e));
+        best = std::min(best, d);
+        if (e - b <= 2 * query.size()) best_short = std::min(best_short, d);
+      }
+
+    const auto top1 = dtwSubsequence(query, recording, 1, recording.size());
+    REQUIRE(top1.size() == 1);
+    REQUIRE_THAT(top1[0].distance, WithinAbs(best, 1e-9));
+
+    const auto top1_short = dtwSubsequence(query, recording);
+    REQUIRE(top1_short.size() == 1);
+    REQUIRE(top1_short[0].end - top1_short[0].begin <= 2 * query.size());
+    REQUIRE_THAT(top1_short[0].distance, WithinAbs(best_short, 1e-9));
+
+    const auto top = dtwSubsequence(query, recording, 4);
+    REQUIRE(!top.empty());
+    REQUIRE(top.size() <= 4);
+    REQUIRE_THAT(top[0].distance, WithinAbs(best_short, 1e-9));
+    for (size_t i = 0; i < top.size(); i++) {
+      REQUIRE(top[i].begin < top[i].end);
+      REQUIRE(top[i].end <= recording.size());
+      REQUIRE(top[i].end - top[i].begin <= 2 * query.size());
+      REQUIRE_THAT(top[i].distance, WithinAbs(dtwFull_L<data_t>(query, segment(recording, top[i].begin, top[i].end)), 1e-9));
+      if (i > 0) REQUIRE(top[i - 1].distance <= top[i].distance);
+      for (size_t j = 0; j < i; j++) // Non-overlapping.
+        REQUIRE((top[i].end <= top[j].begin || top[j].end <= top[i].begin));
+    }
+
+    // Streaming in pieces gives the same matches:
+    SubsequenceSearch<data_t> search(query, 4);
+    for (size_t t = 0; t < recording.size(); t += 5)
+      search.push(recording.begin() + t, recording.begin() + std::min(t + 5, recording.size()));
+    search.finish();
+    const auto streamed = search.matches();
+    REQUIRE(search.samples() == recording.size());
+    REQUIRE(streamed.size() == top.size());
+    for (size_t i = 0; i < top.size(); i++) {
+      REQUIRE(streamed[i].begin == top[i].begin);
+      REQUIRE(streamed[i].end == top[i].end);
+    }
+  }
+
+  // Query planted twice in a recording:
+  std::vector<data_t> query{ 10, 12, 15, 11 }, recording(40, 0);
+  for (size_t t = 0; t < recording.size(); t++) recording[t] = (t % 3);
+  std::copy(query.begin(), query.end(), recording.begin() + 5);
+  std::copy(query.begin(), query.end(), recording.begin() + 27);
+  const auto planted = dtwSubsequence(query, recording, 2);
+  REQUIRE(planted.size() == 2);
+  REQUIRE_THAT(planted[0].distance, WithinAbs(0, 1e-15));
+  REQUIRE_THAT(planted[1].distance, WithinAbs(0, 1e-15));
+  REQUIRE(std::min(planted[0].begin, planted[1].begin) == 5);
+  REQUIRE(std::max(planted[0].begin, planted[1].begin) == 27);
+  REQUIRE(planted[0].end - planted[0].begin == query.size());
+
+  REQUIRE_THROWS(dtwSubsequence(std::vector<data_t>{}, recording));
+  REQUIRE_THROWS(dtwSubsequence(query, recording, 0));
+
+  // A long recording which keeps a path alive at no cost keeps at most 2 * max_length samples:
+  SubsequenceSearch<data_t> bounded({ 0, 100, 0 }, 1, 10);
+  bounded.push(0);
+  for (int t = 0; t < 100000; t++) {
+    bounded.push(100);
+    REQUIRE(bounded.keptSamples() <= 2 * 10 + 1);
+  }
+  const std::vector<data_t> tail{ 0, 100, 0 };
+  bounded.push(tail.begin(), tail.end());
+  bounded.finish();
+  const auto late = bounded.matches();
+  REQUIRE(late.size() == 1);
+  REQUIRE(late[0].begin == bounded.samples() - 3);
+  REQUIRE(late[0].end == bounded.samples());
+  REQUIRE(late[0].distance == 0);
+}
+
+TEST_CASE("dtwSubsequence_random_test", "[dtwSubsequence]")
+{
+  using data_t = double;
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<data_t> value(0, 10);
+  std::uniform_int_distribution<size_t> query_length(2, 8), recording_length(10, 60);
+
+  for (int trial = 0; trial < 300; trial++) {
+    std::vector<data_t> query(query_length(generator)), recording(recording_length(generator));
+    for (auto &x : query) x = value(generator);
+    for (auto &x : recording) x = value(generator);
+
+    // Brute force with the full cost matrix, over subsequences of at most twice the query length:
+    data_t best = std::numeric_limits<data_t>::max();
+    for (size_t b = 0; b < recording.size(); b++)
+      for (size_t e = b + 1; e <= std::min(recording.size(), b + 2 * query.size()); e++)
+        best = std::min(best, dtwFull<data_t>(query, std::vector<data_t>(recording.begin() + b, recording.begin() + e)));
+
+    const auto top = dtwSubsequence(query, recording, 3);
+    REQUIRE(!top.empty());
+    REQUIRE_THAT(top[0].distance, WithinAbs(best, 1e-9));
+    for (size_t i = 0; i < top.size(); i++) {
+      const std::vector<data_t> matched(recording.begin() + top[i].begin, recording.begin() + top[i].end);
+      REQUIRE_THAT(top[i].distance, WithinAbs(dtwFull<data_t>(query, matched), 1e-9)); // Also for later matches.
+      if (i > 0) REQUIRE(top[i - 1].distance <= top[i].distance);
+      for (size_t j = 0; j < i; j++)
+        REQUIRE((top[i].end <= top[j].begin || top[j].end <= top[i].begin));
+    }
+  }
+}
+
+TEST_CASE("IncrementalDtw_test", "[IncrementalDtw]")
+{
+  using data_t = double;
+  const auto random_data = test_util::get_random_data<data_t>(6, 40);
+
+  for (size_t a = 0; a + 1 < random_data.size(); a++) {
+    const auto &x_all = random_data[a], &y_all = random_data[a + 1];
+    IncrementalDtw<data_t> state;
+    REQUIRE(state.distance() == std::numeric_limits<data_t>::max());
+
+    // Grow x and y in uneven steps, alternating and together:
+    std::vector<data_t> x, y;
+    size_t step = 0;
+    while (x.size() < x_all.size() || y.size() < y_all.size()) {
+      step++;
+      if (step % 3 != 2) x.insert(x.end(), x_all.begin() + x.size(), x_all.begin() + std::min(x_all.size(), x.size() + step % 4));
+      if (step % 3 != 0) y.insert(y.end(), y_all.begin() + y.size(), y_all.begin() + std::min(y_all.size(), y.size() + step % 5));
+
+      const auto distance = state.update(x, y);
+      REQUIRE(state.rows() == x.size());
+      REQUIRE(state.cols() == y.size());
+      if (x.empty() || y.empty())
+        REQUIRE(distance == std::numeric_limits<data_t>::max());
+      else
+        REQUIRE_THAT(distance, WithinAbs(dtwFull_L<data_t>(x, y), 1e-9));
+    }
+
+    REQUIRE_THAT(state.update(x, y), WithinAbs(dtwFull_L<data_t>(x, y), 1e-9)); // Nothing appended.
+    REQUIRE_THROWS(state.update(std::vector<data_t>(x.begin(), x.end() - 1), y));
+
+    IncrementalDtw<data_t, cost::SquaredL2> squared;
+    REQUIRE_THAT(squared.update(x, y), WithinAbs((dtwFull_L<data_t, cost::SquaredL2>(x, y)), 1e-9));
+
+    state.reset();
+    REQUIRE(state.rows() == 0);
+    REQUIRE_THAT(state.update(x, y), WithinAbs(dtwFull_L<data_t>(x, y), 1e-9));
+  }
+}